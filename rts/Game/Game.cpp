@@ -106,6 +106,7 @@
 #include "System/Config/ConfigHandler.h"
 #include "System/EventHandler.h"
 #include "System/Exceptions.h"
+#include "System/FrameArena.h"
 #include "System/Sync/FPUCheck.h"
 #include "System/myMath.h"
 #include "Net/GameServer.h"
@@ -1514,6 +1515,12 @@ void CGame::SimFrame() {
 
 		teamHandler->GameFrame(gs->frameNum);
 		playerHandler->GameFrame(gs->frameNum);
+
+		// rebuild (if requested or overloaded) once nothing holds quad indices
+		quadField.Update();
+
+		// frame-scoped temporaries are all dead by now
+		CFrameArena::ResetThreadArenas();
 	}
 
 	lastSimFrameTime = spring_gettime();
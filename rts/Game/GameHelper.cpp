@@ -39,11 +39,22 @@
 #include "System/myMath.h"
 #include "System/Sound/ISoundChannels.h"
 #include "System/Sync/SyncTracer.h"
+#include "System/Threading/ThreadPool.h"
 
 
 static CGameHelper gGameHelper;
 CGameHelper* helper = &gGameHelper;
 
+// GenerateWeaponTargets can run concurrently for the weapons of different
+// units (see CWeapon::UpdatePreTarget), so it can not mark visited targets
+// via CUnit::tempNum
+struct WeaponTargetScratch {
+	std::vector<int> unitStamps;
+	int tempNum = 0;
+};
+
+static std::array<WeaponTargetScratch, ThreadPool::MAX_THREADS> weaponTargetScratch;
+
 
 void CGameHelper::Init()
 {
@@ -630,7 +641,7 @@ namespace {
 } // end of namespace
 
 
-void CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets)
+void CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, FrameVector<std::pair<float, CUnit*>>& targets)
 {
 	const CUnit* owner    = weapon->owner;
 	const float radius    = weapon->range;
@@ -645,10 +656,20 @@ void CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoi
 	const float secDamage = weapon->damages->GetDefault() * weapon->salvoSize / weapon->reloadTime * GAME_SPEED;
 	const bool paralyzer  = (weapon->damages->paralyzeDamageTime != 0);
 
+	WeaponTargetScratch& wts = weaponTargetScratch[ThreadPool::GetThreadNum()];
+
+	// per-weapon stream rather than gsRNG, the result must not depend on
+	// the order in which weapons are evaluated
+	CGlobalSyncedRNG targetRNG = weapon->GetFrameRNG(0);
+
 	// copy on purpose since the below calls lua
 	QuadFieldQuery qfQuery;
-	quadField.GetQuads(qfQuery, pos, radius + (aHeight - std::max(0.0f, readMap->GetInitMinHeight())) * heightMod);
-	const int tempNum = gs->GetTempNum();
+	quadField.GetQuads(qfQuery, pos, weapon->GetAutoTargetRadius());
+
+	const int tempNum = ++wts.tempNum;
+
+	if (wts.unitStamps.size() < unitHandler.MaxUnits())
+		wts.unitStamps.resize(unitHandler.MaxUnits(), 0);
 
 	for (int t = 0; t < teamHandler->ActiveAllyTeams(); ++t) {
 		if (teamHandler->Ally(owner->allyteam, t))
@@ -658,10 +679,10 @@ void CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoi
 			const std::vector<CUnit*>& allyTeamUnits = quadField.GetQuad(qi).teamUnits[t];
 
 			for (CUnit* targetUnit: allyTeamUnits) {
-				if (targetUnit->tempNum == tempNum)
+				if (wts.unitStamps[targetUnit->id] == tempNum)
 					continue;
 
-				targetUnit->tempNum = tempNum;
+				wts.unitStamps[targetUnit->id] = tempNum;
 
 				float targetPriority = 1.0f;
 
@@ -708,7 +729,7 @@ void CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoi
 				}
 
 				if (targetLOSState & LOS_PREVLOS) {
-					targetPriority /= (damageMul * targetUnit->power * (0.7f + gsRNG.NextFloat() * 0.6f));
+					targetPriority /= (damageMul * targetUnit->power * (0.7f + targetRNG.NextFloat() * 0.6f));
 
 					if (targetUnit->category & weapon->badTargetCategory)
 						targetPriority *= 100.0f;
@@ -721,8 +742,8 @@ void CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoi
 				}
 
 				const bool allow = eventHandler.AllowWeaponTarget(owner->id, targetUnit->id, weapon->weaponNum, weaponDef->id, &targetPriority);
-				//Lua call may have changed tempNum, so needs to be set again.
-				targetUnit->tempNum = tempNum;
+				// Lua call may have run another target search, so needs to be set again
+				wts.unitStamps[targetUnit->id] = tempNum;
 
 				if (!allow)
 					continue;
@@ -6,6 +6,7 @@
 #include "Sim/Misc/DamageArray.h"
 #include "Sim/Projectiles/ExplosionListener.h"
 #include "Sim/Units/CommandAI/Command.h"
+#include "System/FrameArena.h"
 #include "System/float3.h"
 #include "System/type2.h"
 
@@ -121,7 +122,7 @@ public:
 	 */
 	static float3 ClosestBuildSite(int team, const UnitDef* unitDef, float3 pos, float searchRadius, int minDist, int facing = 0);
 
-	static void GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets);
+	static void GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, FrameVector<std::pair<float, CUnit*>>& targets);
 
 	void Init();
 	void Update();
@@ -305,7 +305,7 @@ void TraceRayShields(
 	const float3& start,
 	const float3& dir,
 	float length,
-	std::vector<SShieldDist>& hitShields
+	FrameVector<SShieldDist>& hitShields
 ) {
 	CollisionQuery cq;
 
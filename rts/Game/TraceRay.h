@@ -5,6 +5,8 @@
 
 #include <vector>
 
+#include "System/FrameArena.h"
+
 class float3;
 class CUnit;
 class CFeature;
@@ -59,7 +61,7 @@ namespace TraceRay {
 		const float3& start,
 		const float3& dir,
 		float length,
-		std::vector<SShieldDist>& hitShields
+		FrameVector<SShieldDist>& hitShields
 	);
 
 	float GuiTraceRay(
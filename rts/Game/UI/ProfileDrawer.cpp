@@ -362,8 +362,8 @@ static void DrawInfoText(GL::RenderDataBufferC* buffer)
 
 	// background
 	buffer->SafeAppend({{             0.01f - 10.0f * globalRendering->pixelX, 0.02f - 10.0f * globalRendering->pixelY, 0.0f}, {bgColor}});
-	buffer->SafeAppend({{             0.01f - 10.0f * globalRendering->pixelX, 0.17f + 20.0f * globalRendering->pixelY, 0.0f}, {bgColor}});
-	buffer->SafeAppend({{MIN_X_COOR - 0.05f + 10.0f * globalRendering->pixelX, 0.17f + 20.0f * globalRendering->pixelY, 0.0f}, {bgColor}});
+	buffer->SafeAppend({{             0.01f - 10.0f * globalRendering->pixelX, 0.19f + 20.0f * globalRendering->pixelY, 0.0f}, {bgColor}});
+	buffer->SafeAppend({{MIN_X_COOR - 0.05f + 10.0f * globalRendering->pixelX, 0.19f + 20.0f * globalRendering->pixelY, 0.0f}, {bgColor}});
 	buffer->SafeAppend({{MIN_X_COOR - 0.05f + 10.0f * globalRendering->pixelX, 0.02f - 10.0f * globalRendering->pixelY, 0.0f}, {bgColor}});
 
 	// print performance-related information (timings, particle-counts, etc)
@@ -374,10 +374,11 @@ static void DrawInfoText(GL::RenderDataBufferC* buffer)
 	const char* avgFmtStr = "[3] {Sim,Update,Draw}FrameTime={%s%2.1f, %s%2.1f, %s%2.1f (GL=%2.1f)}ms";
 	const char* spdFmtStr = "[4] {Current,Wanted}SimSpeedMul={%2.2f, %2.2f}x";
 	const char* sfxFmtStr = "[5] {Synced,Unsynced}Projectiles={%u,%u} Particles=%u Saturation=%.1f";
-	const char* pfsFmtStr = "[6] (%s)PFS-updates queued: {%i, %i}";
+	const char* pfsFmtStr = "[6] (%s)PFS-updates queued: {%i, %i} {Synced,Unsynced}PathCache{Hits,Misses,Evictions}={%u/%u/%u, %u/%u/%u}";
 	const char* luaFmtStr = "[7] Lua-allocated memory: %.1fMB (%.1fK allocs : %.5u usecs : %.1u states)";
 	const char* gpuFmtStr = "[8] GPU-allocated memory: %.1fMB / %.1fMB";
 	const char* sopFmtStr = "[9] SOP-allocated memory: {U,F,P,W}={%.1f/%.1f, %.1f/%.1f, %.1f/%.1f, %.1f/%.1f}KB";
+	const char* socFmtStr = "[10] SOP-objects {live/peak, free%%}: {U,F,P,W}={%u/%u %.0f%%, %u/%u %.0f%%, %u/%u %.0f%%, %u/%u %.0f%%}";
 
 	const CProjectileHandler* ph = &projectileHandler;
 	const IPathManager* pm = pathManager;
@@ -398,17 +399,23 @@ static void DrawInfoText(GL::RenderDataBufferC* buffer)
 
 	{
 		const int2 pfsUpdates = pm->GetNumQueuedUpdates();
+		const IPathManager::PathCacheStats spcStats = pm->GetPathCacheStats( true);
+		const IPathManager::PathCacheStats upcStats = pm->GetPathCacheStats(false);
+
+		#define PCS_ARGS spcStats.numHits, spcStats.numMisses, spcStats.numEvictions, upcStats.numHits, upcStats.numMisses, upcStats.numEvictions
 
 		switch (pm->GetPathFinderType()) {
 			case PFS_TYPE_DEFAULT: {
-				font->glFormat(0.01f, 0.12f, 0.5f, DBG_FONT_FLAGS | FONT_BUFFERED, pfsFmtStr, "DEF", pfsUpdates.x, pfsUpdates.y);
+				font->glFormat(0.01f, 0.12f, 0.5f, DBG_FONT_FLAGS | FONT_BUFFERED, pfsFmtStr, "DEF", pfsUpdates.x, pfsUpdates.y, PCS_ARGS);
 			} break;
 			case PFS_TYPE_QTPFS: {
-				font->glFormat(0.01f, 0.12f, 0.5f, DBG_FONT_FLAGS | FONT_BUFFERED, pfsFmtStr, "QT", pfsUpdates.x, pfsUpdates.y);
+				font->glFormat(0.01f, 0.12f, 0.5f, DBG_FONT_FLAGS | FONT_BUFFERED, pfsFmtStr, "QT", pfsUpdates.x, pfsUpdates.y, PCS_ARGS);
 			} break;
 			default: {
 			} break;
 		}
+
+		#undef PCS_ARGS
 	}
 
 	{
@@ -441,6 +448,12 @@ static void DrawInfoText(GL::RenderDataBufferC* buffer)
 		weaponMemPool.alloc_size() / 1024.0f,
 		weaponMemPool.freed_size() / 1024.0f
 	);
+	font->glFormat(0.01f, 0.20f, 0.5f, DBG_FONT_FLAGS | FONT_BUFFERED, socFmtStr,
+		unsigned(unitMemPool.live_count()), unsigned(unitMemPool.peak_count()), unitMemPool.frag_ratio() * 100.0f,
+		unsigned(featureMemPool.live_count()), unsigned(featureMemPool.peak_count()), featureMemPool.frag_ratio() * 100.0f,
+		unsigned(projMemPool.live_count()), unsigned(projMemPool.peak_count()), projMemPool.frag_ratio() * 100.0f,
+		unsigned(weaponMemPool.live_count()), unsigned(weaponMemPool.peak_count()), weaponMemPool.frag_ratio() * 100.0f
+	);
 }
 
 
@@ -142,6 +142,7 @@ bool LuaSyncedCtrl::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(AssignPlayerToTeam);
 	REGISTER_LUA_CFUNC(GameOver);
 	REGISTER_LUA_CFUNC(SetGlobalLos);
+	REGISTER_LUA_CFUNC(SetQuadFieldQuadSize);
 
 	REGISTER_LUA_CFUNC(AddTeamResource);
 	REGISTER_LUA_CFUNC(UseTeamResource);
@@ -742,6 +743,13 @@ int LuaSyncedCtrl::SetGlobalLos(lua_State* L)
 	return 0;
 }
 
+int LuaSyncedCtrl::SetQuadFieldQuadSize(lua_State* L)
+{
+	// takes effect at the end of the current sim-frame
+	lua_pushboolean(L, quadField.RequestResize(luaL_checkint(L, 1)));
+	return 1;
+}
+
 
 
 
@@ -126,6 +126,8 @@ bool LuaSyncedRead::PushEntries(lua_State* L)
 
 	REGISTER_LUA_CFUNC(GetWind);
 
+	REGISTER_LUA_CFUNC(GetQuadFieldStats);
+
 	REGISTER_LUA_CFUNC(GetHeadingFromVector);
 	REGISTER_LUA_CFUNC(GetVectorFromHeading);
 
@@ -903,6 +905,40 @@ int LuaSyncedRead::GetWind(lua_State* L)
 }
 
 
+int LuaSyncedRead::GetQuadFieldStats(lua_State* L)
+{
+	CQuadField::OccupancyStats stats;
+	quadField.GetOccupancyStats(stats);
+
+	const char* typeNames[CQuadField::QUAD_OBJECT_TYPES] = {"units", "features", "projectiles"};
+
+	lua_pushnumber(L, quadField.GetQuadSizeX());
+	lua_pushnumber(L, quadField.GetNumQuadsX());
+	lua_pushnumber(L, quadField.GetNumQuadsZ());
+	lua_pushnumber(L, stats.numOccupiedQuads);
+
+	// {units = {max = n, sum = n, [1] = #empty, [2] = #quads with 1 object, [3] = #quads with 2-3, ...}, ...}
+	lua_createtable(L, 0, CQuadField::QUAD_OBJECT_TYPES);
+
+	for (unsigned int i = 0; i < CQuadField::QUAD_OBJECT_TYPES; i++) {
+		lua_pushstring(L, typeNames[i]);
+		lua_createtable(L, CQuadField::NUM_OCCUPANCY_BINS, 2);
+
+		LuaPushNamedNumber(L, "max", stats.maxCounts[i]);
+		LuaPushNamedNumber(L, "sum", stats.sumCounts[i]);
+
+		for (unsigned int j = 0; j < CQuadField::NUM_OCCUPANCY_BINS; j++) {
+			lua_pushnumber(L, stats.histograms[i][j]);
+			lua_rawseti(L, -2, j + 1);
+		}
+
+		lua_rawset(L, -3);
+	}
+
+	return 5;
+}
+
+
 /******************************************************************************/
 
 int LuaSyncedRead::GetGameRulesParams(lua_State* L)
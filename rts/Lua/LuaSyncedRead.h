@@ -40,6 +40,8 @@ class LuaSyncedRead {
 
 		static int GetWind(lua_State* L);
 
+		static int GetQuadFieldStats(lua_State* L);
+
 		static int GetHeadingFromVector(lua_State* L);
 		static int GetVectorFromHeading(lua_State* L);
 
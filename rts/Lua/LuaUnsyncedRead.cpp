@@ -47,6 +47,7 @@
 #include "Sim/Misc/ModInfo.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Misc/QuadField.h"
+#include "Sim/Path/IPathManager.h"
 #include "Sim/Projectiles/Projectile.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitHandler.h"
@@ -90,6 +91,7 @@ bool LuaUnsyncedRead::PushEntries(lua_State* L)
 
 	REGISTER_LUA_CFUNC(GetLuaMemUsage);
 	REGISTER_LUA_CFUNC(GetVidMemUsage);
+	REGISTER_LUA_CFUNC(GetPathCacheStats);
 
 	REGISTER_LUA_CFUNC(GetDrawFrame);
 	REGISTER_LUA_CFUNC(GetFrameTimeOffset);
@@ -404,6 +406,22 @@ int LuaUnsyncedRead::GetVidMemUsage(lua_State* L)
 	return 2;
 }
 
+int LuaUnsyncedRead::GetPathCacheStats(lua_State* L)
+{
+	if (pathManager == nullptr)
+		return 0;
+
+	// counters of the last sim-frame, synced caches by default
+	const IPathManager::PathCacheStats stats = pathManager->GetPathCacheStats(luaL_optboolean(L, 1, true));
+
+	lua_pushnumber(L, stats.numHits);
+	lua_pushnumber(L, stats.numMisses);
+	lua_pushnumber(L, stats.numEvictions);
+	lua_pushnumber(L, stats.numExpirations);
+	lua_pushnumber(L, stats.numCachedPaths);
+	return 5;
+}
+
 /******************************************************************************/
 
 int LuaUnsyncedRead::GetViewGeometry(lua_State* L)
@@ -901,7 +919,7 @@ int LuaUnsyncedRead::GetVisibleUnits(lua_State* L)
 	static CVisUnitQuadDrawer unitQuadIter;
 
 	unitQuadIter.ResetState();
-	readMap->GridVisibility(nullptr, &unitQuadIter, 1e9, CQuadField::BASE_QUAD_SIZE / SQUARE_SIZE);
+	readMap->GridVisibility(nullptr, &unitQuadIter, 1e9, quadField.GetQuadSizeX() / SQUARE_SIZE);
 
 	// Even though we're in unsynced it's ok to use gs->tempNum since its exact value
 	// doesn't matter
@@ -981,7 +999,7 @@ int LuaUnsyncedRead::GetVisibleFeatures(lua_State* L)
 	static CVisFeatureQuadDrawer featureQuadIter;
 
 	featureQuadIter.ResetState();
-	readMap->GridVisibility(nullptr, &featureQuadIter, 1e9, CQuadField::BASE_QUAD_SIZE / SQUARE_SIZE);
+	readMap->GridVisibility(nullptr, &featureQuadIter, 1e9, quadField.GetQuadSizeX() / SQUARE_SIZE);
 
 	// Even though we're in unsynced it's ok to use gs->tempNum since its exact value
 	// doesn't matter
@@ -1045,7 +1063,7 @@ int LuaUnsyncedRead::GetVisibleProjectiles(lua_State* L)
 
 
 	projQuadIter.ResetState();
-	readMap->GridVisibility(nullptr, &projQuadIter, 1e9, CQuadField::BASE_QUAD_SIZE / SQUARE_SIZE);
+	readMap->GridVisibility(nullptr, &projQuadIter, 1e9, quadField.GetQuadSizeX() / SQUARE_SIZE);
 
 	// Even though we're in unsynced it's ok to use gs->tempNum since its exact value
 	// doesn't matter
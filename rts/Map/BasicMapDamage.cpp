@@ -217,10 +217,68 @@ void CBasicMapDamage::RecalcArea(int x1, int x2, int y1, int y2)
 }
 
 
+void CBasicMapDamage::RecalcAreas(CRectangleOptimizer& rects)
+{
+	// merge overlapping craters so that no square is recalculated twice,
+	// then hand every consumer the whole list in one go
+	rects.Optimize();
+
+	for (const SRectangle& r: rects) {
+		readMap->UpdateHeightMapSynced(r);
+	}
+	for (const SRectangle& r: rects) {
+		featureHandler.TerrainChanged(r.x1, r.z1, r.x2, r.z2);
+	}
+	{
+		SCOPED_TIMER("Sim::BasicMapDamage::Los");
+
+		for (const SRectangle& r: rects) {
+			losHandler->UpdateHeightMapSynced(r);
+		}
+	}
+	{
+		SCOPED_TIMER("Sim::BasicMapDamage::Path");
+
+		for (const SRectangle& r: rects) {
+			pathManager->TerrainChange(r.x1, r.z1, r.x2, r.z2, TERRAINCHANGE_DAMAGE_RECALCULATION);
+		}
+	}
+
+	rects.clear();
+}
+
+void CBasicMapDamage::ApplyHeightDeltas()
+{
+	// the optimized rectangles do not overlap, so each square is touched once
+	deltaRects.Optimize();
+
+	for (const SRectangle& r: deltaRects) {
+		for (int z = r.z1; z < r.z2; z++) {
+			for (int x = r.x1; x < r.x2; x++) {
+				float& heightDelta = heightDeltas[z * mapDims.mapxp1 + x];
+
+				if (heightDelta == 0.0f)
+					continue;
+
+				readMap->AddHeight(z * mapDims.mapxp1 + x, heightDelta);
+				heightDelta = 0.0f;
+			}
+		}
+	}
+
+	deltaRects.clear();
+}
+
+
 void CBasicMapDamage::Update()
 {
 	SCOPED_TIMER("Sim::BasicMapDamage");
 
+	if (explosions.empty())
+		return;
+
+	heightDeltas.resize(mapDims.mapxp1 * mapDims.mapyp1, 0.0f);
+
 	for (Explo& e: explosions) {
 		if (e.ttl <= 0)
 			continue;
@@ -231,10 +289,12 @@ void CBasicMapDamage::Update()
 
 		for (int y = e.y1; y <= e.y2; ++y) {
 			for (int x = e.x1; x <= e.x2; ++x) {
-				readMap->AddHeight(y * mapDims.mapxp1 + x, *(si++));
+				heightDeltas[y * mapDims.mapxp1 + x] += *(si++);
 			}
 		}
 
+		deltaRects.push_back(SRectangle(e.x1, e.y1, e.x2 + 1, e.y2 + 1));
+
 		for (const ExploBuilding& b: e.buildings) {
 			CUnit* unit = unitHandler.GetUnit(b.id);
 
@@ -244,18 +304,24 @@ void CBasicMapDamage::Update()
 			// only change ground level if building is still here
 			for (int z = b.tz1; z < b.tz2; z++) {
 				for (int x = b.tx1; x < b.tx2; x++) {
-					readMap->AddHeight(z * mapDims.mapxp1 + x, b.dif);
+					heightDeltas[z * mapDims.mapxp1 + x] += b.dif;
 				}
 			}
 
+			deltaRects.push_back(SRectangle(b.tx1, b.tz1, b.tx2, b.tz2));
 			unit->Move(UpVector * b.dif, true);
 		}
 
 		if (e.ttl == 0) {
-			RecalcArea(e.x1 - 1, e.x2 + 1, e.y1 - 1, e.y2 + 1);
+			recalcRects.push_back(SRectangle(e.x1 - 1, e.y1 - 1, e.x2 + 1, e.y2 + 1));
 		}
 	}
 
+	ApplyHeightDeltas();
+
+	if (!recalcRects.empty())
+		RecalcAreas(recalcRects);
+
 	while (!explosions.empty()) {
 		const Explo& explosion = explosions.front();
 
@@ -4,6 +4,7 @@
 #define _BASIC_MAP_DAMAGE_H
 
 #include "MapDamage.h"
+#include "System/Misc/RectangleOptimizer.h"
 
 #include <deque>
 #include <vector>
@@ -21,6 +22,10 @@ public:
 	void TerrainTypeSpeedModChanged(int ttIndex) override;
 	void Update() override;
 
+private:
+	void ApplyHeightDeltas();
+	void RecalcAreas(CRectangleOptimizer& rects);
+
 private:
 	struct ExploBuilding {
 		/**
@@ -48,6 +53,13 @@ private:
 
 	std::deque<Explo> explosions;
 
+	// summed per-frame height changes of all active explosions (indexed
+	// like the corner heightmap) and the areas they cover, half-open
+	std::vector<float> heightDeltas;
+	CRectangleOptimizer deltaRects;
+	// areas of explosions that finished this frame, inclusive
+	CRectangleOptimizer recalcRects;
+
 	static const unsigned int CRATER_TABLE_SIZE = 200;
 	static const unsigned int EXPLOSION_LIFETIME = 10;
 
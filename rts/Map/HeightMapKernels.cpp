@@ -0,0 +1,315 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+
+#include "HeightMapKernels.h"
+#include "Sim/Misc/GlobalConstants.h"
+#include "System/myMath.h"
+
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
+
+// the SSE kernels access float3 arrays as packed floats
+static_assert(sizeof(float3) == sizeof(float) * 3, "");
+
+
+void HeightMapKernels::CenterHeightsScalar(const float* hmTop, const float* hmBot, float* centerRow, int x1, int x2)
+{
+	for (int x = x1; x <= x2; x++) {
+		const float height =
+			hmTop[x    ] +
+			hmTop[x + 1] +
+			hmBot[x    ] +
+			hmBot[x + 1];
+		centerRow[x] = height * 0.25f;
+	}
+}
+
+void HeightMapKernels::MipHeightsScalar(const float* topRow0, const float* topRow1, float* subRow, int sx, int ex)
+{
+	for (int x = sx; x < ex; x += 2) {
+		const float height =
+			topRow0[x    ] +
+			topRow1[x    ] +
+			topRow0[x + 1] +
+			topRow1[x + 1];
+		subRow[x / 2] = height * 0.25f;
+	}
+}
+
+void HeightMapKernels::FaceNormalsScalar(const float* hmTop, const float* hmBot, float3* faceNormalRow, float3* centerNormalRow, float3* centerNormal2DRow, int x1, int x2)
+{
+	float3 fnTL;
+	float3 fnBR;
+
+	for (int x = x1; x <= x2; x++) {
+		const float& hTL = hmTop[x    ];
+		const float& hTR = hmTop[x + 1];
+		const float& hBL = hmBot[x    ];
+		const float& hBR = hmBot[x + 1];
+
+		// normal of top-left triangle (face) in square
+		//
+		//  *---> e1
+		//  |
+		//  |
+		//  v
+		//  e2
+		//const float3 e1( SQUARE_SIZE, hTR - hTL,           0);
+		//const float3 e2(           0, hBL - hTL, SQUARE_SIZE);
+		//const float3 fnTL = (e2.cross(e1)).Normalize();
+		fnTL.y = SQUARE_SIZE;
+		fnTL.x = - (hTR - hTL);
+		fnTL.z = - (hBL - hTL);
+		fnTL.Normalize();
+
+		// normal of bottom-right triangle (face) in square
+		//
+		//         e3
+		//         ^
+		//         |
+		//         |
+		//  e4 <---*
+		//const float3 e3(-SQUARE_SIZE, hBL - hBR,           0);
+		//const float3 e4(           0, hTR - hBR,-SQUARE_SIZE);
+		//const float3 fnBR = (e4.cross(e3)).Normalize();
+		fnBR.y = SQUARE_SIZE;
+		fnBR.x = (hBL - hBR);
+		fnBR.z = (hTR - hBR);
+		fnBR.Normalize();
+
+		faceNormalRow[x * 2    ] = fnTL;
+		faceNormalRow[x * 2 + 1] = fnBR;
+		// square-normal
+		centerNormalRow[x] = (fnTL + fnBR).Normalize();
+		centerNormal2DRow[x] = (fnTL + fnBR).Normalize2D();
+	}
+}
+
+void HeightMapKernels::SlopesScalar(const float3* faceNormalRow0, const float3* faceNormalRow1, float* slopeRow, int sx, int ex)
+{
+	for (int x = sx; x <= ex; x++) {
+		const float3* fn0 = &faceNormalRow0[x * 4];
+		const float3* fn1 = &faceNormalRow1[x * 4];
+
+		float avgslope = 0.0f;
+		avgslope += fn0[0].y;
+		avgslope += fn0[1].y;
+		avgslope += fn0[2].y;
+		avgslope += fn0[3].y;
+		avgslope += fn1[0].y;
+		avgslope += fn1[1].y;
+		avgslope += fn1[2].y;
+		avgslope += fn1[3].y;
+		avgslope *= 0.125f;
+
+		float maxslope =              fn0[0].y;
+		maxslope = std::min(maxslope, fn0[1].y);
+		maxslope = std::min(maxslope, fn0[2].y);
+		maxslope = std::min(maxslope, fn0[3].y);
+		maxslope = std::min(maxslope, fn1[0].y);
+		maxslope = std::min(maxslope, fn1[1].y);
+		maxslope = std::min(maxslope, fn1[2].y);
+		maxslope = std::min(maxslope, fn1[3].y);
+
+		// smooth it a bit, so small holes don't block huge tanks
+		const float lerp = maxslope / avgslope;
+		const float slope = mix(maxslope, avgslope, lerp);
+
+		slopeRow[x] = 1.0f - slope;
+	}
+}
+
+
+
+#ifdef __SSE2__
+// float3::SafeNormalize for four vectors; the reciprocal square-root is
+// math::isqrt (fastmath::isqrt2_nosse) step by step, *not* _mm_rsqrt_ps
+static inline void NormalizeSSE(__m128& x, __m128& y, __m128& z)
+{
+	const __m128 sql = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+	const __m128 xh = _mm_mul_ps(_mm_set1_ps(0.5f), sql);
+	const __m128 c15 = _mm_set1_ps(1.5f);
+
+	__m128 r = _mm_castsi128_ps(_mm_sub_epi32(_mm_set1_epi32(0x5f375a86), _mm_srai_epi32(_mm_castps_si128(sql), 1)));
+
+	r = _mm_mul_ps(r, _mm_sub_ps(c15, _mm_mul_ps(xh, _mm_mul_ps(r, r))));
+	r = _mm_mul_ps(r, _mm_sub_ps(c15, _mm_mul_ps(xh, _mm_mul_ps(r, r))));
+
+	// vectors at or below nrm_eps are left as they are
+	const __m128 mask = _mm_cmpgt_ps(sql, _mm_set1_ps(float3::nrm_eps()));
+	const __m128 scale = _mm_or_ps(_mm_and_ps(mask, r), _mm_andnot_ps(mask, _mm_set1_ps(1.0f)));
+
+	x = _mm_mul_ps(x, scale);
+	y = _mm_mul_ps(y, scale);
+	z = _mm_mul_ps(z, scale);
+}
+
+// writes four SoA vectors as four consecutive float3's
+static inline void StoreFloat3s(float3* dst, __m128 x, __m128 y, __m128 z)
+{
+	const __m128 xyLo = _mm_unpacklo_ps(x, y); // x0 y0 x1 y1
+	const __m128 xyHi = _mm_unpackhi_ps(x, y); // x2 y2 x3 y3
+
+	const __m128 t0 = _mm_shuffle_ps(z, xyLo, _MM_SHUFFLE(2, 2, 0, 0)); // z0 z0 x1 x1
+	const __m128 t1 = _mm_shuffle_ps(xyLo, z, _MM_SHUFFLE(1, 1, 3, 3)); // y1 y1 z1 z1
+	const __m128 t2 = _mm_shuffle_ps(z, xyHi, _MM_SHUFFLE(3, 2, 3, 2)); // z2 z3 x3 y3
+
+	float* f = &dst->x;
+
+	_mm_storeu_ps(f + 0, _mm_shuffle_ps(xyLo, t0, _MM_SHUFFLE(2, 0, 1, 0))); // x0 y0 z0 x1
+	_mm_storeu_ps(f + 4, _mm_shuffle_ps(t1, xyHi, _MM_SHUFFLE(1, 0, 2, 0))); // y1 z1 x2 y2
+	_mm_storeu_ps(f + 8, _mm_shuffle_ps(t2, t2, _MM_SHUFFLE(1, 3, 2, 0))); // z2 x3 y3 z3
+}
+
+
+void HeightMapKernels::CenterHeightsSSE(const float* hmTop, const float* hmBot, float* centerRow, int x1, int x2)
+{
+	const __m128 quarter = _mm_set1_ps(0.25f);
+
+	int x = x1;
+
+	for (; (x + 3) <= x2; x += 4) {
+		__m128 height = _mm_loadu_ps(hmTop + x);
+		height = _mm_add_ps(height, _mm_loadu_ps(hmTop + x + 1));
+		height = _mm_add_ps(height, _mm_loadu_ps(hmBot + x    ));
+		height = _mm_add_ps(height, _mm_loadu_ps(hmBot + x + 1));
+
+		_mm_storeu_ps(centerRow + x, _mm_mul_ps(height, quarter));
+	}
+
+	CenterHeightsScalar(hmTop, hmBot, centerRow, x, x2);
+}
+
+void HeightMapKernels::MipHeightsSSE(const float* topRow0, const float* topRow1, float* subRow, int sx, int ex)
+{
+	const __m128 quarter = _mm_set1_ps(0.25f);
+
+	int x = sx;
+
+	// four sub-map squares (eight top-map columns) per iteration
+	for (; (x + 6) < ex; x += 8) {
+		const __m128 r0a = _mm_loadu_ps(topRow0 + x    );
+		const __m128 r0b = _mm_loadu_ps(topRow0 + x + 4);
+		const __m128 r1a = _mm_loadu_ps(topRow1 + x    );
+		const __m128 r1b = _mm_loadu_ps(topRow1 + x + 4);
+
+		__m128 height = _mm_shuffle_ps(r0a, r0b, _MM_SHUFFLE(2, 0, 2, 0));
+		height = _mm_add_ps(height, _mm_shuffle_ps(r1a, r1b, _MM_SHUFFLE(2, 0, 2, 0)));
+		height = _mm_add_ps(height, _mm_shuffle_ps(r0a, r0b, _MM_SHUFFLE(3, 1, 3, 1)));
+		height = _mm_add_ps(height, _mm_shuffle_ps(r1a, r1b, _MM_SHUFFLE(3, 1, 3, 1)));
+
+		_mm_storeu_ps(subRow + x / 2, _mm_mul_ps(height, quarter));
+	}
+
+	MipHeightsScalar(topRow0, topRow1, subRow, x, ex);
+}
+
+void HeightMapKernels::FaceNormalsSSE(const float* hmTop, const float* hmBot, float3* faceNormalRow, float3* centerNormalRow, float3* centerNormal2DRow, int x1, int x2)
+{
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128 squareSize = _mm_set1_ps(SQUARE_SIZE);
+	const __m128 zero = _mm_setzero_ps();
+
+	int x = x1;
+
+	for (; (x + 3) <= x2; x += 4) {
+		const __m128 hTL = _mm_loadu_ps(hmTop + x    );
+		const __m128 hTR = _mm_loadu_ps(hmTop + x + 1);
+		const __m128 hBL = _mm_loadu_ps(hmBot + x    );
+		const __m128 hBR = _mm_loadu_ps(hmBot + x + 1);
+
+		__m128 tlx = _mm_xor_ps(_mm_sub_ps(hTR, hTL), signMask);
+		__m128 tly = squareSize;
+		__m128 tlz = _mm_xor_ps(_mm_sub_ps(hBL, hTL), signMask);
+
+		__m128 brx = _mm_sub_ps(hBL, hBR);
+		__m128 bry = squareSize;
+		__m128 brz = _mm_sub_ps(hTR, hBR);
+
+		NormalizeSSE(tlx, tly, tlz);
+		NormalizeSSE(brx, bry, brz);
+
+		// interleave TL and BR s.t. each square's pair is adjacent
+		StoreFloat3s(&faceNormalRow[x * 2    ], _mm_unpacklo_ps(tlx, brx), _mm_unpacklo_ps(tly, bry), _mm_unpacklo_ps(tlz, brz));
+		StoreFloat3s(&faceNormalRow[x * 2 + 4], _mm_unpackhi_ps(tlx, brx), _mm_unpackhi_ps(tly, bry), _mm_unpackhi_ps(tlz, brz));
+
+		__m128 cnx = _mm_add_ps(tlx, brx);
+		__m128 cny = _mm_add_ps(tly, bry);
+		__m128 cnz = _mm_add_ps(tlz, brz);
+		__m128 c2x = cnx;
+		__m128 c2y = zero;
+		__m128 c2z = cnz;
+
+		NormalizeSSE(cnx, cny, cnz);
+		NormalizeSSE(c2x, c2y, c2z);
+
+		StoreFloat3s(&centerNormalRow[x], cnx, cny, cnz);
+		StoreFloat3s(&centerNormal2DRow[x], c2x, c2y, c2z);
+	}
+
+	FaceNormalsScalar(hmTop, hmBot, faceNormalRow, centerNormalRow, centerNormal2DRow, x, x2);
+}
+
+void HeightMapKernels::SlopesSSE(const float3* faceNormalRow0, const float3* faceNormalRow1, float* slopeRow, int sx, int ex)
+{
+	const auto LoadSlopes = [](const float3* fn, int k) {
+		return _mm_setr_ps(fn[k].y, fn[k + 4].y, fn[k + 8].y, fn[k + 12].y);
+	};
+
+	int x = sx;
+
+	for (; (x + 3) <= ex; x += 4) {
+		const float3* fn0 = &faceNormalRow0[x * 4];
+		const float3* fn1 = &faceNormalRow1[x * 4];
+
+		const __m128 slopes[8] = {
+			LoadSlopes(fn0, 0), LoadSlopes(fn0, 1), LoadSlopes(fn0, 2), LoadSlopes(fn0, 3),
+			LoadSlopes(fn1, 0), LoadSlopes(fn1, 1), LoadSlopes(fn1, 2), LoadSlopes(fn1, 3),
+		};
+
+		__m128 avgslope = _mm_setzero_ps();
+		__m128 maxslope = slopes[0];
+
+		for (int k = 0; k < 8; k++) {
+			avgslope = _mm_add_ps(avgslope, slopes[k]);
+		}
+		for (int k = 1; k < 8; k++) {
+			// std::min(a, b) returns a unless b < a, as does _mm_min_ps(b, a)
+			maxslope = _mm_min_ps(slopes[k], maxslope);
+		}
+
+		avgslope = _mm_mul_ps(avgslope, _mm_set1_ps(0.125f));
+
+		const __m128 lerp = _mm_div_ps(maxslope, avgslope);
+		const __m128 slope = _mm_add_ps(maxslope, _mm_mul_ps(_mm_sub_ps(avgslope, maxslope), lerp));
+
+		_mm_storeu_ps(slopeRow + x, _mm_sub_ps(_mm_set1_ps(1.0f), slope));
+	}
+
+	SlopesScalar(faceNormalRow0, faceNormalRow1, slopeRow, x, ex);
+}
+
+#else
+
+void HeightMapKernels::CenterHeightsSSE(const float* hmTop, const float* hmBot, float* centerRow, int x1, int x2)
+{
+	CenterHeightsScalar(hmTop, hmBot, centerRow, x1, x2);
+}
+
+void HeightMapKernels::MipHeightsSSE(const float* topRow0, const float* topRow1, float* subRow, int sx, int ex)
+{
+	MipHeightsScalar(topRow0, topRow1, subRow, sx, ex);
+}
+
+void HeightMapKernels::FaceNormalsSSE(const float* hmTop, const float* hmBot, float3* faceNormalRow, float3* centerNormalRow, float3* centerNormal2DRow, int x1, int x2)
+{
+	FaceNormalsScalar(hmTop, hmBot, faceNormalRow, centerNormalRow, centerNormal2DRow, x1, x2);
+}
+
+void HeightMapKernels::SlopesSSE(const float3* faceNormalRow0, const float3* faceNormalRow1, float* slopeRow, int sx, int ex)
+{
+	SlopesScalar(faceNormalRow0, faceNormalRow1, slopeRow, sx, ex);
+}
+#endif
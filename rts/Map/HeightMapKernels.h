@@ -0,0 +1,70 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef HEIGHTMAP_KERNELS_H
+#define HEIGHTMAP_KERNELS_H
+
+#include "System/float3.h"
+
+/**
+ * Row-span kernels behind CReadMap::Update{CenterHeightmap,MipHeightmaps,
+ * FaceNormals,Slopemap}. Each call processes one row of the respective map
+ * over an inclusive (mip: half-open, step 2) column range; the pointers are
+ * to the start of the row(s), not to the first updated element.
+ *
+ * The SSE variants handle four squares per register with the exact same
+ * operation order as the scalar ones (including float3::Normalize and its
+ * math::isqrt approximation), so they are bit-identical and safe to use in
+ * synced code.
+ */
+namespace HeightMapKernels {
+	/// centerRow[x] = average of the four corner heights of square x
+	void CenterHeightsScalar(const float* hmTop, const float* hmBot, float* centerRow, int x1, int x2);
+	void CenterHeightsSSE(const float* hmTop, const float* hmBot, float* centerRow, int x1, int x2);
+
+	/// subRow[x / 2] = average of the 2x2 block at x in the two rows of the finer mip
+	void MipHeightsScalar(const float* topRow0, const float* topRow1, float* subRow, int sx, int ex);
+	void MipHeightsSSE(const float* topRow0, const float* topRow1, float* subRow, int sx, int ex);
+
+	/// two face-normals per square (faceNormalRow[x * 2 + {0,1}]) plus the square's 3D and 2D normal
+	void FaceNormalsScalar(const float* hmTop, const float* hmBot, float3* faceNormalRow, float3* centerNormalRow, float3* centerNormal2DRow, int x1, int x2);
+	void FaceNormalsSSE(const float* hmTop, const float* hmBot, float3* faceNormalRow, float3* centerNormalRow, float3* centerNormal2DRow, int x1, int x2);
+
+	/// slopeRow[x] from the eight face-normals of the 2x2 squares at x * 2 in both face-normal rows
+	void SlopesScalar(const float3* faceNormalRow0, const float3* faceNormalRow1, float* slopeRow, int sx, int ex);
+	void SlopesSSE(const float3* faceNormalRow0, const float3* faceNormalRow1, float* slopeRow, int sx, int ex);
+
+
+	inline void CenterHeights(const float* hmTop, const float* hmBot, float* centerRow, int x1, int x2) {
+	#ifdef __SSE2__
+		CenterHeightsSSE(hmTop, hmBot, centerRow, x1, x2);
+	#else
+		CenterHeightsScalar(hmTop, hmBot, centerRow, x1, x2);
+	#endif
+	}
+
+	inline void MipHeights(const float* topRow0, const float* topRow1, float* subRow, int sx, int ex) {
+	#ifdef __SSE2__
+		MipHeightsSSE(topRow0, topRow1, subRow, sx, ex);
+	#else
+		MipHeightsScalar(topRow0, topRow1, subRow, sx, ex);
+	#endif
+	}
+
+	inline void FaceNormals(const float* hmTop, const float* hmBot, float3* faceNormalRow, float3* centerNormalRow, float3* centerNormal2DRow, int x1, int x2) {
+	#ifdef __SSE2__
+		FaceNormalsSSE(hmTop, hmBot, faceNormalRow, centerNormalRow, centerNormal2DRow, x1, x2);
+	#else
+		FaceNormalsScalar(hmTop, hmBot, faceNormalRow, centerNormalRow, centerNormal2DRow, x1, x2);
+	#endif
+	}
+
+	inline void Slopes(const float3* faceNormalRow0, const float3* faceNormalRow1, float* slopeRow, int sx, int ex) {
+	#ifdef __SSE2__
+		SlopesSSE(faceNormalRow0, faceNormalRow1, slopeRow, sx, ex);
+	#else
+		SlopesScalar(faceNormalRow0, faceNormalRow1, slopeRow, sx, ex);
+	#endif
+	}
+}
+
+#endif // HEIGHTMAP_KERNELS_H
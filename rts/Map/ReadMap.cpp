@@ -1,10 +1,12 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring> // memcpy
 
 #include "ReadMap.h"
+#include "HeightMapKernels.h"
 #include "MapDamage.h"
 #include "MapInfo.h"
 #include "MetalMap.h"
@@ -525,19 +527,10 @@ void CReadMap::UpdateCenterHeightmap(const SRectangle& rect, bool initialize)
 	const float* heightmapSynced = GetCornerHeightMapSynced();
 
 	for (int y = rect.z1; y <= rect.z2; y++) {
-		for (int x = rect.x1; x <= rect.x2; x++) {
-			const int idxTL = (y    ) * mapDims.mapxp1 + x;
-			const int idxTR = (y    ) * mapDims.mapxp1 + x + 1;
-			const int idxBL = (y + 1) * mapDims.mapxp1 + x;
-			const int idxBR = (y + 1) * mapDims.mapxp1 + x + 1;
-
-			const float height =
-				heightmapSynced[idxTL] +
-				heightmapSynced[idxTR] +
-				heightmapSynced[idxBL] +
-				heightmapSynced[idxBR];
-			centerHeightMap[y * mapDims.mapx + x] = height * 0.25f;
-		}
+		const float* hmTop = &heightmapSynced[(y    ) * mapDims.mapxp1];
+		const float* hmBot = &heightmapSynced[(y + 1) * mapDims.mapxp1];
+
+		HeightMapKernels::CenterHeights(hmTop, hmBot, &centerHeightMap[y * mapDims.mapx], rect.x1, rect.x2);
 	}
 }
 
@@ -551,18 +544,11 @@ void CReadMap::UpdateMipHeightmaps(const SRectangle& rect, bool initialize)
 		const int ex = (rect.x2 >> i);
 		const int sy = (rect.z1 >> i) & (~1);
 		const int ey = (rect.z2 >> i);
-		float* topMipMap = mipPointerHeightMaps[i];
-		float* subMipMap = mipPointerHeightMaps[i + 1];
+		const float* topMipMap = mipPointerHeightMaps[i];
+		      float* subMipMap = mipPointerHeightMaps[i + 1];
 
 		for (int y = sy; y < ey; y += 2) {
-			for (int x = sx; x < ex; x += 2) {
-				const float height =
-					topMipMap[(x    ) + (y    ) * hmapx] +
-					topMipMap[(x    ) + (y + 1) * hmapx] +
-					topMipMap[(x + 1) + (y    ) * hmapx] +
-					topMipMap[(x + 1) + (y + 1) * hmapx];
-				subMipMap[(x / 2) + (y / 2) * hmapx / 2] = height * 0.25f;
-			}
+			HeightMapKernels::MipHeights(&topMipMap[y * hmapx], &topMipMap[(y + 1) * hmapx], &subMipMap[(y / 2) * hmapx / 2], sx, ex);
 		}
 	}
 }
@@ -578,62 +564,20 @@ void CReadMap::UpdateFaceNormals(const SRectangle& rect, bool initialize)
 	const int x2 = std::min(mapDims.mapxm1, rect.x2 + 1);
 
 	for_mt(z1, z2+1, [&](const int y) {
-		float3 fnTL;
-		float3 fnBR;
-
-		for (int x = x1; x <= x2; x++) {
-			const int idxTL = (y    ) * mapDims.mapxp1 + x; // TL
-			const int idxBL = (y + 1) * mapDims.mapxp1 + x; // BL
-
-			const float& hTL = heightmapSynced[idxTL    ];
-			const float& hTR = heightmapSynced[idxTL + 1];
-			const float& hBL = heightmapSynced[idxBL    ];
-			const float& hBR = heightmapSynced[idxBL + 1];
-
-			// normal of top-left triangle (face) in square
-			//
-			//  *---> e1
-			//  |
-			//  |
-			//  v
-			//  e2
-			//const float3 e1( SQUARE_SIZE, hTR - hTL,           0);
-			//const float3 e2(           0, hBL - hTL, SQUARE_SIZE);
-			//const float3 fnTL = (e2.cross(e1)).Normalize();
-			fnTL.y = SQUARE_SIZE;
-			fnTL.x = - (hTR - hTL);
-			fnTL.z = - (hBL - hTL);
-			fnTL.Normalize();
-
-			// normal of bottom-right triangle (face) in square
-			//
-			//         e3
-			//         ^
-			//         |
-			//         |
-			//  e4 <---*
-			//const float3 e3(-SQUARE_SIZE, hBL - hBR,           0);
-			//const float3 e4(           0, hTR - hBR,-SQUARE_SIZE);
-			//const float3 fnBR = (e4.cross(e3)).Normalize();
-			fnBR.y = SQUARE_SIZE;
-			fnBR.x = (hBL - hBR);
-			fnBR.z = (hTR - hBR);
-			fnBR.Normalize();
-
-			faceNormalsSynced[(y * mapDims.mapx + x) * 2    ] = fnTL;
-			faceNormalsSynced[(y * mapDims.mapx + x) * 2 + 1] = fnBR;
-			// square-normal
-			centerNormalsSynced[y * mapDims.mapx + x] = (fnTL + fnBR).Normalize();
-			centerNormals2D[y * mapDims.mapx + x] = (fnTL + fnBR).Normalize2D();
+		const float* hmTop = &heightmapSynced[(y    ) * mapDims.mapxp1];
+		const float* hmBot = &heightmapSynced[(y + 1) * mapDims.mapxp1];
 
-			#ifdef USE_UNSYNCED_HEIGHTMAP
-			if (initialize) {
-				faceNormalsUnsynced[(y * mapDims.mapx + x) * 2    ] = faceNormalsSynced[(y * mapDims.mapx + x) * 2    ];
-				faceNormalsUnsynced[(y * mapDims.mapx + x) * 2 + 1] = faceNormalsSynced[(y * mapDims.mapx + x) * 2 + 1];
-				centerNormalsUnsynced[y * mapDims.mapx + x] = centerNormalsSynced[y * mapDims.mapx + x];
-			}
-			#endif
+		float3* faceNormalRow = &faceNormalsSynced[y * mapDims.mapx * 2];
+		float3* centerNormalRow = &centerNormalsSynced[y * mapDims.mapx];
+
+		HeightMapKernels::FaceNormals(hmTop, hmBot, faceNormalRow, centerNormalRow, &centerNormals2D[y * mapDims.mapx], x1, x2);
+
+		#ifdef USE_UNSYNCED_HEIGHTMAP
+		if (initialize) {
+			std::copy(faceNormalRow + x1 * 2, faceNormalRow + (x2 + 1) * 2, &faceNormalsUnsynced[(y * mapDims.mapx + x1) * 2]);
+			std::copy(centerNormalRow + x1, centerNormalRow + (x2 + 1), &centerNormalsUnsynced[y * mapDims.mapx + x1]);
 		}
+		#endif
 	});
 }
 
@@ -646,36 +590,10 @@ void CReadMap::UpdateSlopemap(const SRectangle& rect, bool initialize)
 	const int ey = std::min(mapDims.hmapy - 1, (rect.z2 / 2) + 1);
 
 	for (int y = sy; y <= ey; y++) {
-		for (int x = sx; x <= ex; x++) {
-			const int idx0 = (y*2    ) * (mapDims.mapx) + x*2;
-			const int idx1 = (y*2 + 1) * (mapDims.mapx) + x*2;
-
-			float avgslope = 0.0f;
-			avgslope += faceNormalsSynced[(idx0    ) * 2    ].y;
-			avgslope += faceNormalsSynced[(idx0    ) * 2 + 1].y;
-			avgslope += faceNormalsSynced[(idx0 + 1) * 2    ].y;
-			avgslope += faceNormalsSynced[(idx0 + 1) * 2 + 1].y;
-			avgslope += faceNormalsSynced[(idx1    ) * 2    ].y;
-			avgslope += faceNormalsSynced[(idx1    ) * 2 + 1].y;
-			avgslope += faceNormalsSynced[(idx1 + 1) * 2    ].y;
-			avgslope += faceNormalsSynced[(idx1 + 1) * 2 + 1].y;
-			avgslope *= 0.125f;
-
-			float maxslope =              faceNormalsSynced[(idx0    ) * 2    ].y;
-			maxslope = std::min(maxslope, faceNormalsSynced[(idx0    ) * 2 + 1].y);
-			maxslope = std::min(maxslope, faceNormalsSynced[(idx0 + 1) * 2    ].y);
-			maxslope = std::min(maxslope, faceNormalsSynced[(idx0 + 1) * 2 + 1].y);
-			maxslope = std::min(maxslope, faceNormalsSynced[(idx1    ) * 2    ].y);
-			maxslope = std::min(maxslope, faceNormalsSynced[(idx1    ) * 2 + 1].y);
-			maxslope = std::min(maxslope, faceNormalsSynced[(idx1 + 1) * 2    ].y);
-			maxslope = std::min(maxslope, faceNormalsSynced[(idx1 + 1) * 2 + 1].y);
-
-			// smooth it a bit, so small holes don't block huge tanks
-			const float lerp = maxslope / avgslope;
-			const float slope = mix(maxslope, avgslope, lerp);
-
-			slopeMap[y * mapDims.hmapx + x] = 1.0f - slope;
-		}
+		const float3* faceNormalRow0 = &faceNormalsSynced[(y*2    ) * mapDims.mapx * 2];
+		const float3* faceNormalRow1 = &faceNormalsSynced[(y*2 + 1) * mapDims.mapx * 2];
+
+		HeightMapKernels::Slopes(faceNormalRow0, faceNormalRow1, &slopeMap[y * mapDims.hmapx], sx, ex);
 	}
 }
 
@@ -429,7 +429,7 @@ namespace DebugColVolDrawer
 
 		cvDrawer.ResetState();
 		cvDrawer.Enable();
-		readMap->GridVisibility(nullptr, &cvDrawer, 1e9, CQuadField::BASE_QUAD_SIZE / SQUARE_SIZE);
+		readMap->GridVisibility(nullptr, &cvDrawer, 1e9, quadField.GetQuadSizeX() / SQUARE_SIZE);
 		cvDrawer.Disable();
 	}
 }
@@ -51,11 +51,11 @@ namespace GL {
 		}
 
 		void ClearDeathDependencies() {
-			// modified by DeleteDeathDependence
-			const auto& listeningObjs = GetListening(DEPENDENCE_LIGHT);
+			TSyncSafeSet listeningObjs;
+			GetListening(listeningObjs, DEPENDENCE_LIGHT);
 
-			while (!listeningObjs.empty()) {
-				DeleteDeathDependence(listeningObjs.back(), DEPENDENCE_LIGHT);
+			for (CObject* obj: listeningObjs) {
+				DeleteDeathDependence(obj, DEPENDENCE_LIGHT);
 			}
 		}
 
@@ -7,6 +7,7 @@
 #include "System/float3.h"
 
 #include <algorithm>
+#include <atomic>
 
 class CSolidObject;
 struct LocalModelPiece;
@@ -152,8 +153,9 @@ class CCollisionHandler {
 		static bool IntersectBox(const CollisionVolume* v, const float3& pi0, const float3& pi1, CollisionQuery* cq);
 
 	private:
-		static unsigned int numDiscTests; // number of discrete hit-tests executed
-		static unsigned int numContTests; // number of continuous hit-tests executed (inc. unsynced)
+		// atomic since hit-tests also run inside for_mt (weapon target searches)
+		static std::atomic<unsigned int> numDiscTests; // number of discrete hit-tests executed
+		static std::atomic<unsigned int> numContTests; // number of continuous hit-tests executed (inc. unsynced)
 };
 
 #endif // COLLISION_HANDLER_H
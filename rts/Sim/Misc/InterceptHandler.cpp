@@ -21,7 +21,16 @@
 CR_BIND_DERIVED(CInterceptHandler, CObject, )
 CR_REG_METADATA(CInterceptHandler, (
 	CR_MEMBER(interceptors),
-	CR_MEMBER(interceptables)
+	CR_MEMBER(interceptables),
+
+	// rebuilt on demand
+	CR_IGNORED(gridCells),
+	CR_IGNORED(candidates),
+	CR_IGNORED(interceptPairs),
+	CR_IGNORED(gridOrigin),
+	CR_IGNORED(gridSize),
+	CR_IGNORED(gridCellSize),
+	CR_IGNORED(gridFrame)
 ))
 
 CInterceptHandler interceptHandler;
@@ -32,86 +41,258 @@ void CInterceptHandler::Update(bool forced) {
 	if (((gs->frameNum % UNIT_SLOWUPDATE_RATE) != 0) && !forced)
 		return;
 
-	for (CWeapon* w: interceptors) {
-		const WeaponDef* wDef = w->weaponDef;
-		const CUnit* wOwner = w->owner;
-
-		assert(wDef->interceptor || wDef->isShield);
-
-		for (CWeaponProjectile* p: interceptables) {
-			if (!p->CanBeInterceptedBy(wDef))
-				continue;
-			if (w->HasIncomingProjectile(p->id))
-				continue;
-
-			const int pAllyTeam = p->GetAllyteamID();
-
-			if (teamHandler->IsValidAllyTeam(pAllyTeam) && teamHandler->Ally(wOwner->allyteam, pAllyTeam))
-				continue;
-
-			// note: will be called every Update so long as gadget does not return true
-			if (!eventHandler.AllowWeaponInterceptTarget(wOwner, w, p))
-				continue;
-
-			// there are four cases when an interceptor <w> should fire at a projectile <p>:
-			//     1. p's target position inside w's interception circle (w's owner can move!)
-			//     2. p's current position inside w's interception circle
-			//     3. p's projected impact position inside w's interception circle
-			//     4. p's trajectory intersects w's interception circle
-			//
-			// these checks all need to be evaluated periodically, not just
-			// when a projectile is created and handed to AddInterceptTarget
-			const float weaponDist = w->aimFromPos.distance(p->pos);
-			const float impactDist = CGround::LineGroundCol(p->pos, p->pos + p->dir * weaponDist);
-
-			const float3& pImpactPos = p->pos + p->dir * impactDist;
-			const float3& pTargetPos = p->GetTargetPos();
-			const float3  pWeaponVec = p->pos - w->aimFromPos;
-
-			if (w->aimFromPos.SqDistance2D(pTargetPos) < Square(wDef->coverageRange)) {
-				w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
-				w->AddIncomingProjectile(p->id);
-				continue; // 1
-			}
+	UpdateInterceptorGrid(true);
 
-			if (false /*wDef->noFlyThroughIntercept*/) {
-				// <w> is just a static interceptor and fires only at projectiles
-				// TARGETED within its current interception area; any projectiles
-				// CROSSING its interception area aren't targeted
-				//XXX implement in lua?
-				continue;
-			}
+	interceptPairs.clear();
+
+	for (size_t i = 0; i < interceptables.size(); i++) {
+		GetInterceptorCandidates(interceptables[i]);
+
+		for (const int j: candidates) {
+			interceptPairs.emplace_back(j, i);
+		}
+	}
+
+	// visit the pairs in the same (interceptor-major) order as a full N*M
+	// loop would, pairs the grid rules out could not pass any of the tests
+	std::sort(interceptPairs.begin(), interceptPairs.end());
+
+	for (const auto& pair: interceptPairs) {
+		TryInterceptTarget(interceptors[pair.first], interceptables[pair.second]);
+	}
+}
+
+
+void CInterceptHandler::TryInterceptTarget(CWeapon* w, CWeaponProjectile* p)
+{
+	const WeaponDef* wDef = w->weaponDef;
+	const CUnit* wOwner = w->owner;
+
+	assert(wDef->interceptor || wDef->isShield);
+
+	if (!p->CanBeInterceptedBy(wDef))
+		return;
+	if (w->HasIncomingProjectile(p->id))
+		return;
+
+	const int pAllyTeam = p->GetAllyteamID();
+
+	if (teamHandler->IsValidAllyTeam(pAllyTeam) && teamHandler->Ally(wOwner->allyteam, pAllyTeam))
+		return;
+
+	// note: will be called every Update so long as gadget does not return true
+	if (!eventHandler.AllowWeaponInterceptTarget(wOwner, w, p))
+		return;
+
+	// there are four cases when an interceptor <w> should fire at a projectile <p>:
+	//     1. p's target position inside w's interception circle (w's owner can move!)
+	//     2. p's current position inside w's interception circle
+	//     3. p's projected impact position inside w's interception circle
+	//     4. p's trajectory intersects w's interception circle
+	//
+	// these checks all need to be evaluated periodically, not just
+	// when a projectile is created and handed to AddInterceptTarget
+	const float weaponDist = w->aimFromPos.distance(p->pos);
+	const float impactDist = CGround::LineGroundCol(p->pos, p->pos + p->dir * weaponDist);
+
+	const float3& pImpactPos = p->pos + p->dir * impactDist;
+	const float3& pTargetPos = p->GetTargetPos();
+	const float3  pWeaponVec = p->pos - w->aimFromPos;
+
+	if (w->aimFromPos.SqDistance2D(pTargetPos) < Square(wDef->coverageRange)) {
+		w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
+		w->AddIncomingProjectile(p->id);
+		return; // 1
+	}
+
+	if (false /*wDef->noFlyThroughIntercept*/) {
+		// <w> is just a static interceptor and fires only at projectiles
+		// TARGETED within its current interception area; any projectiles
+		// CROSSING its interception area aren't targeted
+		//XXX implement in lua?
+		return;
+	}
+
+	if (pWeaponVec.SqLength2D() < Square(wDef->coverageRange)) {
+		w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
+		w->AddIncomingProjectile(p->id);
+		return; // 2
+	}
+
+	if (w->aimFromPos.SqDistance2D(pImpactPos) < Square(wDef->coverageRange)) {
+		const float3 pTargetDir = (pTargetPos - p->pos).SafeNormalize();
+		const float3 pImpactDir = (pImpactPos - p->pos).SafeNormalize();
+
+		// the projected impact position can briefly shift into the covered
+		// area during transition from vertical to horizontal flight, so we
+		// perform an extra test (NOTE: assumes non-parabolic trajectory)
+		if (pTargetDir.dot(pImpactDir) >= 0.999f) {
+			w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
+			w->AddIncomingProjectile(p->id);
+			return; // 3
+		}
+	}
+
+	const float3 pMinSepPos = p->pos + p->dir * Clamp(-(pWeaponVec.dot(p->dir)), 0.0f, impactDist);
+	const float3 pMinSepVec = w->aimFromPos - pMinSepPos;
+
+	if (pMinSepVec.SqLength() < Square(wDef->coverageRange)) {
+		w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
+		w->AddIncomingProjectile(p->id);
+		return; // 4
+	}
+}
+
+
+
+void CInterceptHandler::UpdateInterceptorGrid(bool forced)
+{
+	if (gridFrame == gs->frameNum && !forced)
+		return;
+
+	gridFrame = gs->frameNum;
+	gridSize = {0, 0};
+
+	if (interceptors.empty())
+		return;
 
-			if (pWeaponVec.SqLength2D() < Square(wDef->coverageRange)) {
-				w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
-				w->AddIncomingProjectile(p->id);
-				continue; // 2
+	// pad the coverage areas by a square so rounding in the cell lookups
+	// can never push a covered position into a cell the weapon is not in
+	float2 mins = { std::numeric_limits<float>::max(),  std::numeric_limits<float>::max()};
+	float2 maxs = {-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max()};
+
+	for (const CWeapon* w: interceptors) {
+		const float r = w->weaponDef->coverageRange + SQUARE_SIZE;
+
+		mins.x = std::min(mins.x, w->aimFromPos.x - r);
+		mins.y = std::min(mins.y, w->aimFromPos.z - r);
+		maxs.x = std::max(maxs.x, w->aimFromPos.x + r);
+		maxs.y = std::max(maxs.y, w->aimFromPos.z + r);
+	}
+
+	gridOrigin = mins;
+	gridCellSize = std::max(std::max(maxs.x - mins.x, maxs.y - mins.y) / GRID_MAX_CELLS, GRID_CELL_SIZE * 1.0f);
+	gridSize.x = Clamp(int((maxs.x - mins.x) / gridCellSize) + 1, 1, GRID_MAX_CELLS);
+	gridSize.y = Clamp(int((maxs.y - mins.y) / gridCellSize) + 1, 1, GRID_MAX_CELLS);
+
+	// keep the per-cell capacity between rebuilds
+	if (gridCells.size() < size_t(gridSize.x * gridSize.y))
+		gridCells.resize(gridSize.x * gridSize.y);
+
+	for (std::vector<int>& cell: gridCells) {
+		cell.clear();
+	}
+
+	for (size_t i = 0; i < interceptors.size(); i++) {
+		const CWeapon* w = interceptors[i];
+		const float r = w->weaponDef->coverageRange + SQUARE_SIZE;
+
+		const int cx1 = GetCellX(w->aimFromPos.x - r);
+		const int cx2 = GetCellX(w->aimFromPos.x + r);
+		const int cz1 = GetCellZ(w->aimFromPos.z - r);
+		const int cz2 = GetCellZ(w->aimFromPos.z + r);
+
+		for (int cz = cz1; cz <= cz2; cz++) {
+			for (int cx = cx1; cx <= cx2; cx++) {
+				gridCells[cz * gridSize.x + cx].push_back(i);
 			}
+		}
+	}
+}
+
 
-			if (w->aimFromPos.SqDistance2D(pImpactPos) < Square(wDef->coverageRange)) {
-				const float3 pTargetDir = (pTargetPos - p->pos).SafeNormalize();
-				const float3 pImpactDir = (pImpactPos - p->pos).SafeNormalize();
-
-				// the projected impact position can briefly shift into the covered
-				// area during transition from vertical to horizontal flight, so we
-				// perform an extra test (NOTE: assumes non-parabolic trajectory)
-				if (pTargetDir.dot(pImpactDir) >= 0.999f) {
-					w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
-					w->AddIncomingProjectile(p->id);
-					continue; // 3
-				}
+int CInterceptHandler::GetCellX(float x) const { return Clamp(int((x - gridOrigin.x) / gridCellSize), 0, gridSize.x - 1); }
+int CInterceptHandler::GetCellZ(float z) const { return Clamp(int((z - gridOrigin.y) / gridCellSize), 0, gridSize.y - 1); }
+
+void CInterceptHandler::AddCellCandidates(int cx, int cz)
+{
+	const std::vector<int>& cell = gridCells[cz * gridSize.x + cx];
+	candidates.insert(candidates.end(), cell.begin(), cell.end());
+}
+
+
+void CInterceptHandler::GetInterceptorCandidates(const CWeaponProjectile* p)
+{
+	candidates.clear();
+
+	if (gridSize.x == 0)
+		return;
+
+	const float2 gridMins = gridOrigin;
+	const float2 gridMaxs = {gridOrigin.x + gridSize.x * gridCellSize, gridOrigin.y + gridSize.y * gridCellSize};
+
+	const auto InGrid = [&](const float3& pos) {
+		return (pos.x >= gridMins.x && pos.x <= gridMaxs.x && pos.z >= gridMins.y && pos.z <= gridMaxs.y);
+	};
+
+	// case 1 in TryInterceptTarget tests the target position
+	const float3& pTargetPos = p->GetTargetPos();
+
+	if (InGrid(pTargetPos))
+		AddCellCandidates(GetCellX(pTargetPos.x), GetCellZ(pTargetPos.z));
+
+	// cases 2-4 test positions along p's trajectory, pos + dir * t for some
+	// t >= -1 which is bounded only by the distance to the interceptor; clip
+	// the (2D) ray to the grid and collect every cell it passes through
+	float tmin = -1.0f;
+	float tmax = std::numeric_limits<float>::max();
+
+	const float rayPos[2] = {p->pos.x, p->pos.z};
+	const float rayDir[2] = {p->dir.x, p->dir.z};
+	const float slabMins[2] = {gridMins.x, gridMins.y};
+	const float slabMaxs[2] = {gridMaxs.x, gridMaxs.y};
+
+	for (int i = 0; i < 2; i++) {
+		if (rayDir[i] == 0.0f) {
+			if (rayPos[i] < slabMins[i] || rayPos[i] > slabMaxs[i])
+				tmax = -std::numeric_limits<float>::max();
+
+			continue;
+		}
+
+		const float t1 = (slabMins[i] - rayPos[i]) / rayDir[i];
+		const float t2 = (slabMaxs[i] - rayPos[i]) / rayDir[i];
+
+		tmin = std::max(tmin, std::min(t1, t2));
+		tmax = std::min(tmax, std::max(t1, t2));
+	}
+
+	if (tmin <= tmax) {
+		// a vertical trajectory reduces to a single position
+		if (tmax == std::numeric_limits<float>::max())
+			tmax = tmin;
+
+		const float2 a = {rayPos[0] + rayDir[0] * tmin, rayPos[1] + rayDir[1] * tmin};
+		const float2 b = {rayPos[0] + rayDir[0] * tmax, rayPos[1] + rayDir[1] * tmax};
+
+		const int cx1 = GetCellX(std::min(a.x, b.x));
+		const int cx2 = GetCellX(std::max(a.x, b.x));
+
+		for (int cx = cx1; cx <= cx2; cx++) {
+			// z-extent of the segment within this column of cells
+			const float x1 = std::max(std::min(a.x, b.x), gridOrigin.x + (cx    ) * gridCellSize);
+			const float x2 = std::min(std::max(a.x, b.x), gridOrigin.x + (cx + 1) * gridCellSize);
+
+			float z1 = a.y;
+			float z2 = b.y;
+
+			if (a.x != b.x) {
+				z1 = a.y + (x1 - a.x) * (b.y - a.y) / (b.x - a.x);
+				z2 = a.y + (x2 - a.x) * (b.y - a.y) / (b.x - a.x);
 			}
 
-			const float3 pMinSepPos = p->pos + p->dir * Clamp(-(pWeaponVec.dot(p->dir)), 0.0f, impactDist);
-			const float3 pMinSepVec = w->aimFromPos - pMinSepPos;
+			const int cz1 = GetCellZ(std::min(z1, z2));
+			const int cz2 = GetCellZ(std::max(z1, z2));
 
-			if (pMinSepVec.SqLength() < Square(wDef->coverageRange)) {
-				w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
-				w->AddIncomingProjectile(p->id);
-				continue; // 4
+			for (int cz = cz1; cz <= cz2; cz++) {
+				AddCellCandidates(cx, cz);
 			}
 		}
 	}
+
+	// ascending interceptor order, each weapon only once
+	std::sort(candidates.begin(), candidates.end());
+	candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
 }
 
 
@@ -119,6 +300,8 @@ void CInterceptHandler::Update(bool forced) {
 void CInterceptHandler::AddInterceptorWeapon(CWeapon* weapon)
 {
 	interceptors.push_back(weapon);
+	// grid holds indices into <interceptors>
+	gridFrame = -1;
 }
 
 
@@ -127,6 +310,7 @@ void CInterceptHandler::RemoveInterceptorWeapon(CWeapon* weapon)
 	auto it = std::find(interceptors.begin(), interceptors.end(), weapon);
 	if (it != interceptors.end()) {
 		interceptors.erase(it);
+		gridFrame = -1;
 	}
 }
 
@@ -141,7 +325,14 @@ void CInterceptHandler::AddInterceptTarget(CWeaponProjectile* target, const floa
 	// die before the interceptable itself does)
 	AddDeathDependence(target, DEPENDENCE_INTERCEPTABLE);
 
-	Update(true);
+	// only the new target is checked here, all others are re-evaluated
+	// against every interceptor covering them by the periodic Update
+	UpdateInterceptorGrid(false);
+	GetInterceptorCandidates(target);
+
+	for (const int i: candidates) {
+		TryInterceptTarget(interceptors[i], target);
+	}
 }
 
 
@@ -4,8 +4,11 @@
 #define INTERCEPT_HANDLER_H
 
 #include <deque>
+#include <vector>
+
 #include "System/Misc/NonCopyable.h"
 #include "System/Object.h"
+#include "System/type2.h"
 
 class CWeapon;
 class CWeaponProjectile;
@@ -27,8 +30,36 @@ public:
 	void DependentDied(CObject* o);
 
 private:
+	void UpdateInterceptorGrid(bool forced);
+	void GetInterceptorCandidates(const CWeaponProjectile* p);
+	void TryInterceptTarget(CWeapon* w, CWeaponProjectile* p);
+
+	void AddCellCandidates(int cx, int cz);
+
+	int GetCellX(float x) const;
+	int GetCellZ(float z) const;
+
+private:
+	// lower bound on the size of a grid cell in elmos; the grid never
+	// has more than GRID_MAX_CELLS cells per axis
+	static constexpr float GRID_CELL_SIZE = 1024.0f;
+	static constexpr int GRID_MAX_CELLS = 64;
+
 	std::deque<CWeapon*> interceptors;
 	std::deque<CWeaponProjectile*> interceptables;
+
+	// indices into <interceptors> of every weapon whose coverage area
+	// overlaps a cell; spans the bounding box of all coverage areas and
+	// is rebuilt (at most once per frame) since interceptors can move
+	std::vector< std::vector<int> > gridCells;
+	std::vector<int> candidates;
+	std::vector< std::pair<int, int> > interceptPairs;
+
+	float2 gridOrigin;
+	int2 gridSize;
+
+	float gridCellSize = GRID_CELL_SIZE;
+	int gridFrame = -1;
 };
 
 extern CInterceptHandler interceptHandler;
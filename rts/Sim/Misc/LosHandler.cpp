@@ -5,6 +5,7 @@
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitDef.h"
 #include "Sim/Units/UnitHandler.h"
+#include "Sim/Units/UnitHotState.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Misc/ModInfo.h"
 #include "Map/ReadMap.h"
@@ -94,8 +95,16 @@ void ILosType::Init(const int mipLevel_, LosType type_)
 	const float* ctrHeightMap = readMap->GetCenterHeightMapSynced();
 	const float* mipHeightMap = readMap->GetMIPHeightMapSynced(mipLevel_);
 
-	for (CLosMap& losMap: losMaps) {
+	numAllyTeamWords = (losMaps.size() + 31) / 32;
+
+	allyTeamBits.clear();
+	allyTeamBits.resize(size.x * size.y * numAllyTeamWords, 0);
+
+	for (size_t allyTeam = 0; allyTeam < losMaps.size(); allyTeam++) {
+		CLosMap& losMap = losMaps[allyTeam];
+
 		losMap.Init(size, int2(mapDims.mapx, mapDims.mapy), ctrHeightMap, mipHeightMap, type == LOS_TYPE_LOS);
+		losMap.SetAllyTeamBits(&allyTeamBits[allyTeam >> 5], numAllyTeamWords, 1u << (allyTeam & 31));
 	}
 }
 
@@ -930,6 +939,89 @@ bool CLosHandler::InJammer(const float3 pos, int allyTeam) const
 }
 
 
+void CLosHandler::GetGlobalLosMask(SAllyTeamMask& mask) const
+{
+	mask.bits.fill(0);
+
+	for (int allyTeam = 0; allyTeam < teamHandler->ActiveAllyTeams(); allyTeam++) {
+		mask.bits[allyTeam >> 5] |= (uint32_t(globalLOS[allyTeam]) << (allyTeam & 31));
+	}
+}
+
+void CLosHandler::GetUnitVisibility(const CUnit* unit, const SAllyTeamMask& globalLosMask, SUnitVisibility& vis) const
+{
+	// mirrors InLos(unit, *) and InRadar(unit, *), one 32-allyteam word at a
+	// time; position, velocity, allyteam and water state come from the hot-
+	// state store which is current after the move-type updates
+	const float3 unitPos = unitHotState.GetPosRadius(unit->id);
+	const float3 nextPos = unitPos + unitHotState.GetSpeed(unit->id);
+
+	const unsigned int physicalState = unitHotState.GetPhysicalState(unit->id);
+	const int allyTeam = unitHotState.GetAllyTeam(unit->id);
+
+	const bool inWater = ((physicalState & CSolidObject::PSTATE_BIT_INWATER) != 0);
+	const bool underWater = ((physicalState & CSolidObject::PSTATE_BIT_UNDERWATER) != 0);
+	const bool sonarVisible = inWater && (!unit->sonarStealth || unit->beingBuilt);
+	const bool radarVisible = !underWater && (!unit->stealth || unit->beingBuilt);
+	const bool sonarGated = modInfo.requireSonarUnderWater && underWater;
+
+	// InJammer(unit, *) is the same for every allyteam except the unit's own
+	const int jammerAlly = modInfo.separateJammers ? allyTeam : 0;
+	const bool jammed = (underWater? sonarJammer: jammer).InSight(unitPos, jammerAlly);
+
+	const bool overrideCloak = (modInfo.alwaysVisibleOverridesCloaked && unit->alwaysVisible);
+	const bool cloaked = (unit->isCloaked && !overrideCloak);
+
+	const uint32_t* sonarBits = sonar.InSightBits(unitPos);
+	const uint32_t* radarBits = radar.InSightBits(unitPos);
+	const uint32_t* losBits[2] = {nullptr, nullptr};
+
+	if (unit->useAirLos) {
+		losBits[0] = airLos.InSightBits(unitPos);
+		losBits[1] = airLos.InSightBits(nextPos);
+	} else {
+		losBits[0] = los.InSightBits(unitPos);
+		losBits[1] = los.InSightBits(nextPos);
+	}
+
+	for (int w = 0; w < los.numAllyTeamWords; w++) {
+		const uint32_t ownBits = ((allyTeam >> 5) == w)? (1u << (allyTeam & 31)): 0u;
+		const uint32_t jamBits = jammed? ~ownBits: 0u;
+
+		uint32_t inRadar = 0;
+		uint32_t inLos = losBits[0][w] | losBits[1][w];
+
+		if (sonarVisible)
+			inRadar |= (sonarBits[w] & ~jamBits);
+		if (radarVisible)
+			inRadar |= (radarBits[w] & ~jamBits);
+
+		if (!unit->useAirLos && sonarGated)
+			inLos &= inRadar;
+
+		inLos |= globalLosMask.bits[w];
+
+		if (unit->alwaysVisible)
+			inLos = ~0u;
+		if (cloaked)
+			inLos &= ownBits;
+
+		vis.inLos.bits[w] = inLos;
+		vis.inRadar.bits[w] = inRadar;
+	}
+}
+
+void CLosHandler::GetUnitVisibility(const std::vector<CUnit*>& units, const SAllyTeamMask& globalLosMask, std::vector<SUnitVisibility>& vis) const
+{
+	vis.resize(units.size());
+
+	// only reads the LOS-maps and unit state, each unit writes its own slot
+	for_mt(0, units.size(), [&](const int i) {
+		GetUnitVisibility(units[i], globalLosMask, vis[i]);
+	});
+}
+
+
 bool CLosHandler::InJammer(const CUnit* unit, int allyTeam) const
 {
 	if (allyTeam == unit->allyteam)
@@ -3,6 +3,7 @@
 #ifndef LOS_HANDLER_H
 #define LOS_HANDLER_H
 
+#include <array>
 #include <vector>
 #include <deque>
 
@@ -111,6 +112,14 @@ public:
 		return (losMaps[allyTeam].At(PosToSquare(pos)) != 0);
 	}
 
+	/// bit N of the returned words is set iff allyteam N has this square in sight
+	inline const uint32_t* InSightBits(const float3 pos) const {
+		const int2 p = PosToSquare(pos);
+		const int x = Clamp(p.x, 0, size.x - 1);
+		const int y = Clamp(p.y, 0, size.y - 1);
+		return &allyTeamBits[(y * size.x + x) * numAllyTeamWords];
+	}
+
 public:
 	enum LosAlgoType { LOS_ALGO_RAYCAST, LOS_ALGO_CIRCLE };
 	enum LosType {
@@ -173,6 +182,10 @@ public:
 	spring::unordered_map<int, std::vector<SLosInstance*> > instanceHashes;
 
 	std::vector<CLosMap> losMaps;
+	// per-square packed allyteam bits, kept in sync with losMaps
+	std::vector<uint32_t> allyTeamBits;
+	int numAllyTeamWords = 0;
+
 	std::deque<SLosInstance> instances;
 	std::deque<int> freeIDs;
 
@@ -209,6 +222,16 @@ class CLosHandler : public CEventClient
 public:
 	CLosHandler(): CEventClient("[CLosHandler]", 271993, true) {}
 
+	struct SAllyTeamMask {
+		bool Test(int allyTeam) const { return (((bits[allyTeam >> 5] >> (allyTeam & 31)) & 1) != 0); }
+
+		std::array<uint32_t, (MAX_TEAMS + 31) / 32> bits;
+	};
+	struct SUnitVisibility {
+		SAllyTeamMask inLos;
+		SAllyTeamMask inRadar;
+	};
+
 	static void InitStatic();
 	static void KillStatic(bool reload);
 
@@ -263,6 +286,14 @@ public:
 		return seismic.InSight(unit->pos, allyTeam);
 	}
 
+
+	// batched versions of InLos(unit, *) and InRadar(unit, *) for all allyteams at once;
+	// only the bits of active allyteams are meaningful
+	void GetGlobalLosMask(SAllyTeamMask& mask) const;
+	void GetUnitVisibility(const CUnit* unit, const SAllyTeamMask& globalLosMask, SUnitVisibility& vis) const;
+	// same for a whole range of units (in parallel), vis[i] belongs to units[i]
+	void GetUnitVisibility(const std::vector<CUnit*>& units, const SAllyTeamMask& globalLosMask, std::vector<SUnitVisibility>& vis) const;
+
 public:
 	// default operations for targeting-facilities
 	void IncreaseAllyTeamRadarErrorSize(int allyTeam) { radarErrorSizes[allyTeam] *= baseRadarErrorMult; }
@@ -5,6 +5,7 @@
 
 #include "LosMap.h"
 #include "LosHandler.h"
+#include "LosRaycast.h"
 #include "Map/ReadMap.h"
 #include "System/myMath.h"
 #include "System/float3.h"
@@ -15,8 +16,6 @@
 	#include "Game/GlobalUnsynced.h" // for myAllyTeam
 #endif
 
-constexpr float LOS_BONUS_HEIGHT = 5.0f;
-
 
 
 static std::array<std::vector<float>, ThreadPool::MAX_THREADS> RADIUS_ISQRT_TABLES;
@@ -121,8 +120,8 @@ public:
 	// only generates table if not in cache
 	void GenerateForLosSize(size_t losSize);
 
-	const int2 GetLosTableRaySquare(size_t losSize, size_t rayIndex, size_t squareIdx) {
-		return losTables[losSize][rayIndex][squareIdx];
+	const LosLine& GetLosTableRay(size_t losSize, size_t rayIndex) {
+		return losTables[losSize][rayIndex];
 	}
 
 	size_t GetLosTableRaySize(size_t losSize, size_t rayIndex) {
@@ -418,7 +417,7 @@ void CLosMap::AddCircle(SLosInstance* instance, int amount)
 			const unsigned ex = Clamp(instance->basePos.x + width + 1, 0, size.x);
 
 			for (unsigned x_ = sx; x_ < ex; ++x_) {
-				losmap[(y_ * size.x) + x_] += amount;
+				AddToSquare((y_ * size.x) + x_, amount);
 			}
 		}
 	});
@@ -440,7 +439,7 @@ void CLosMap::AddRaycast(SLosInstance* instance, int amount)
 	if ((amount > 0) && updateUnsyncedHeightMap) {
 		for (const SLosInstance::RLE rle: losSquares) {
 			for (int idx = rle.start, len = rle.length; len > 0; --len, ++idx) {
-				losmap[idx] += amount;
+				AddToSquare(idx, amount);
 
 				// skip if this los-square did not *enter* LOS
 				if (losmap[idx] != amount)
@@ -461,7 +460,7 @@ void CLosMap::AddRaycast(SLosInstance* instance, int amount)
 
 	for (const SLosInstance::RLE rle: losSquares) {
 		for (int idx = rle.start, len = rle.length; len > 0; --len, ++idx) {
-			losmap[idx] += amount;
+			AddToSquare(idx, amount);
 		}
 	}
 }
@@ -519,37 +518,6 @@ inline static constexpr size_t ToAngleMapIdx(const int2 p, const int radius)
 }
 
 
-inline void CastLos(
-	float* prvAngle,
-	float* maxAngle,
-	const int2& off,
-	std::vector<char>& losRaySquares,
-	std::vector<float>& raycastAngles,
-	int losRadius,
-	int threadNum
-) {
-	const size_t oidx = ToAngleMapIdx(off, losRadius);
-
-	// angle to square is smaller than current max-angle, so not visible
-	if (raycastAngles[oidx] < *maxAngle) {
-		losRaySquares[oidx] = false;
-		return;
-	}
-
-	if (raycastAngles[oidx] < *prvAngle) {
-		const float invR = isqrtTableLookup(off.x * off.x + off.y * off.y, threadNum);
-		const float angle = *prvAngle - LOS_BONUS_HEIGHT * invR;
-
-		if (raycastAngles[oidx] < (*maxAngle = angle)) {
-			losRaySquares[oidx] = false;
-			return;
-		}
-	}
-
-	*prvAngle = raycastAngles[oidx];
-}
-
-
 void CLosMap::AddSquaresToInstance(SLosInstance* li, const std::vector<char>& losRaySquares) const
 {
 	const int2 pos   = li->basePos;
@@ -656,19 +624,9 @@ void CLosMap::UnsafeLosAdd(SLosInstance* li) const
 	const size_t numRays = helper.GetLosTableSize(radius);
 
 	for (size_t i = 0; i < numRays; ++i) {
-		float maxAngles[4] = {-1e7, -1e7, -1e7, -1e7};
-		float prvAngles[4] = {-1e7, -1e7, -1e7, -1e7};
-
-		const size_t numSquares = helper.GetLosTableRaySize(radius, i);
-
-		for (size_t n = 0; n < numSquares; n++) {
-			const int2 square = helper.GetLosTableRaySquare(radius, i, n);
+		const CLosTableHelper::LosLine& ray = helper.GetLosTableRay(radius, i);
 
-			CastLos(&prvAngles[0], &maxAngles[0],       square              , losRaySquares, raycastAngles, radius, threadNum);
-			CastLos(&prvAngles[1], &maxAngles[1],      -square              , losRaySquares, raycastAngles, radius, threadNum);
-			CastLos(&prvAngles[2], &maxAngles[2], int2( square.y, -square.x), losRaySquares, raycastAngles, radius, threadNum);
-			CastLos(&prvAngles[3], &maxAngles[3], int2(-square.y,  square.x), losRaySquares, raycastAngles, radius, threadNum);
-		}
+		LosRaycast::CastRotatedRay(ray.data(), ray.size(), RADIUS_ISQRT_TABLES[threadNum].data(), raycastAngles.data(), losRaySquares.data(), radius, pos, SRectangle(), LosRaycast::CLIP_NONE);
 	}
 
 	// translate visible square indices to map square idx + RLE
@@ -741,72 +699,17 @@ void CLosMap::SafeLosAdd(SLosInstance* li) const
 	// Cast the Rays
 	const size_t numRays = helper.GetLosTableSize(radius);
 
-	if (safeRect.Inside(pos)) {
-		losRaySquares[ToAngleMapIdx(int2(0, 0), radius)] = true;
-
-		for (size_t i = 0; i < numRays; ++i) {
-			float maxAngles[4] = {-1e7, -1e7, -1e7, -1e7};
-			float prvAngles[4] = {-1e7, -1e7, -1e7, -1e7};
-
-			const size_t numSquares = helper.GetLosTableRaySize(radius, i);
-
-			for (size_t n = 0; n < numSquares; n++) {
-				const int2 square = helper.GetLosTableRaySquare(radius, i, n);
+	// if the emitter is inside the map every rotated ray ends at the map edge,
+	// otherwise only the squares that lie on the map are checked
+	const int clipMode = safeRect.Inside(pos)? LosRaycast::CLIP_BREAK: LosRaycast::CLIP_SKIP;
 
-				if (!safeRect.Inside(pos + square))
-					break;
-
-				CastLos(&prvAngles[0], &maxAngles[0],  square,                   losRaySquares, raycastAngles, radius, threadNum);
-			}
-			for (size_t n = 0; n < numSquares; n++) {
-				const int2 square = helper.GetLosTableRaySquare(radius, i, n);
-
-				if (!safeRect.Inside(pos - square))
-					break;
-
-				CastLos(&prvAngles[1], &maxAngles[1], -square,                   losRaySquares, raycastAngles, radius, threadNum);
-			}
-			for (size_t n = 0; n < numSquares; n++) {
-				const int2 square = helper.GetLosTableRaySquare(radius, i, n);
-
-				if (!safeRect.Inside(pos + int2(square.y, -square.x)))
-					break;
-
-				CastLos(&prvAngles[2], &maxAngles[2], int2(square.y, -square.x), losRaySquares, raycastAngles, radius, threadNum);
-			}
-			for (size_t n = 0; n < numSquares; n++) {
-				const int2 square = helper.GetLosTableRaySquare(radius, i, n);
-
-				if (!safeRect.Inside(pos + int2(-square.y, square.x)))
-					break;
-
-				CastLos(&prvAngles[3], &maxAngles[3], int2(-square.y, square.x), losRaySquares, raycastAngles, radius, threadNum);
-			}
-		}
-	} else {
-		// emit position outside the map
-		for (size_t i = 0; i < numRays; ++i) {
-			float maxAngles[4] = {-1e7, -1e7, -1e7, -1e7};
-			float prvAngles[4] = {-1e7, -1e7, -1e7, -1e7};
-
-			const size_t numSquares = helper.GetLosTableRaySize(radius, i);
-
-			for (size_t n = 0; n < numSquares; n++) {
-				const int2 square = helper.GetLosTableRaySquare(radius, i, n);
-
-				if (safeRect.Inside(pos + square))
-					CastLos(&prvAngles[0], &maxAngles[0],  square,                   losRaySquares, raycastAngles, radius, threadNum);
-
-				if (safeRect.Inside(pos - square))
-					CastLos(&prvAngles[1], &maxAngles[1], -square,                   losRaySquares, raycastAngles, radius, threadNum);
+	if (clipMode == LosRaycast::CLIP_BREAK)
+		losRaySquares[ToAngleMapIdx(int2(0, 0), radius)] = true;
 
-				if (safeRect.Inside(pos + int2(square.y, -square.x)))
-					CastLos(&prvAngles[2], &maxAngles[2], int2(square.y, -square.x), losRaySquares, raycastAngles, radius, threadNum);
+	for (size_t i = 0; i < numRays; ++i) {
+		const CLosTableHelper::LosLine& ray = helper.GetLosTableRay(radius, i);
 
-				if (safeRect.Inside(pos + int2(-square.y, square.x)))
-					CastLos(&prvAngles[3], &maxAngles[3], int2(-square.y, square.x), losRaySquares, raycastAngles, radius, threadNum);
-			}
-		}
+		LosRaycast::CastRotatedRay(ray.data(), ray.size(), RADIUS_ISQRT_TABLES[threadNum].data(), raycastAngles.data(), losRaySquares.data(), radius, pos, safeRect, clipMode);
 	}
 
 	// translate visible square indices to map square idx + RLE
@@ -5,6 +5,7 @@
 #ifndef LOS_MAP_H
 #define LOS_MAP_H
 
+#include <cstdint>
 #include <vector>
 #include "System/type2.h"
 #include "System/myMath.h"
@@ -25,6 +26,8 @@ public:
 		losmap.clear();
 		losmap.resize(size.x * size.y, 0);
 
+		allyTeamBits = nullptr;
+
 		ctrHeightMap = ctrHeightMap_;
 		mipHeightMap = mipHeightMap_;
 
@@ -33,6 +36,13 @@ public:
 
 	void Kill() {}
 
+	/// <bits> is the owning ILosType's per-square allyteam bitmask array, already offset to our word
+	void SetAllyTeamBits(uint32_t* bits, int stride, uint32_t mask) {
+		allyTeamBits = bits;
+		allyTeamBitStride = stride;
+		allyTeamBitMask = mask;
+	}
+
 public:
 	/// circular area, for airLosMap, circular radar maps, jammer maps, ...
 	void AddCircle(SLosInstance* instance, int amount);
@@ -60,12 +70,25 @@ private:
 
 	void AddSquaresToInstance(SLosInstance* li, const std::vector<char>& losRaySquares) const;
 
+	void AddToSquare(int idx, int amount) {
+		const unsigned short prvCount = losmap[idx];
+		const unsigned short newCount = (losmap[idx] += amount);
+
+		// flip our allyteam's bit whenever the square enters or leaves sight
+		if (allyTeamBits != nullptr && ((prvCount == 0) != (newCount == 0)))
+			allyTeamBits[idx * allyTeamBitStride] ^= allyTeamBitMask;
+	}
+
 protected:
 	int2 size;
 	int2 LOS2HEIGHT;
 
 	std::vector<unsigned short> losmap;
 
+	uint32_t* allyTeamBits = nullptr;
+	uint32_t allyTeamBitMask = 0;
+	int allyTeamBitStride = 0;
+
 	const float* ctrHeightMap = nullptr;
 	const float* mipHeightMap = nullptr;
 
@@ -0,0 +1,227 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "LosRaycast.h"
+
+#include <cassert>
+
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
+
+
+static inline size_t ToAngleMapIdx(const int2 p, const int radius)
+{
+	// [-radius, +radius]^2 -> [0, +2*radius]^2 -> idx
+	return (p.y + radius) * (2 * radius + 1) + (p.x + radius);
+}
+
+static inline void GetRotatedSquares(const int2 square, int2 rotated[4])
+{
+	rotated[0] = int2( square.x,  square.y);
+	rotated[1] = int2(-square.x, -square.y);
+	rotated[2] = int2( square.y, -square.x);
+	rotated[3] = int2(-square.y,  square.x);
+}
+
+static inline int GetClippedLanes(const int2 rotated[4], int2 pos, const SRectangle& clipRect)
+{
+	int lanes = 0;
+
+	for (int k = 0; k < 4; k++) {
+		lanes |= (int(clipRect.Inside(pos + rotated[k])) << k);
+	}
+
+	return lanes;
+}
+
+
+void LosRaycast::CastRotatedRayScalar(
+	const int2* squares,
+	size_t numSquares,
+	const float* invRadii,
+	const float* angles,
+	char* visible,
+	int radius,
+	int2 pos,
+	const SRectangle& clipRect,
+	int clipMode
+) {
+	float maxAngles[4] = {-1e7f, -1e7f, -1e7f, -1e7f};
+	float prvAngles[4] = {-1e7f, -1e7f, -1e7f, -1e7f};
+
+	int2 rotated[4];
+	int activeLanes = 0xF;
+
+	for (size_t n = 0; n < numSquares && activeLanes != 0; n++) {
+		const int2 square = squares[n];
+
+		GetRotatedSquares(square, rotated);
+
+		int lanes = activeLanes;
+
+		if (clipMode != CLIP_NONE) {
+			lanes = GetClippedLanes(rotated, pos, clipRect);
+
+			if (clipMode == CLIP_BREAK)
+				lanes = (activeLanes &= lanes);
+		}
+
+		for (int k = 0; k < 4; k++) {
+			if ((lanes & (1 << k)) == 0)
+				continue;
+
+			const size_t oidx = ToAngleMapIdx(rotated[k], radius);
+
+			// angle to square is smaller than current max-angle, so not visible
+			if (angles[oidx] < maxAngles[k]) {
+				visible[oidx] = false;
+				continue;
+			}
+
+			if (angles[oidx] < prvAngles[k]) {
+				const float invR = invRadii[square.x * square.x + square.y * square.y];
+				const float angle = prvAngles[k] - LOS_BONUS_HEIGHT * invR;
+
+				if (angles[oidx] < (maxAngles[k] = angle)) {
+					visible[oidx] = false;
+					continue;
+				}
+			}
+
+			prvAngles[k] = angles[oidx];
+		}
+	}
+}
+
+
+#ifdef __SSE2__
+// lane-mask for each combination of active rotations
+static const struct LaneMasks {
+	LaneMasks() {
+		for (int i = 0; i < 16; i++) {
+			masks[i] = _mm_cmpneq_ps(_mm_setr_ps(i & 1, i & 2, i & 4, i & 8), _mm_setzero_ps());
+		}
+	}
+
+	__m128 masks[16];
+} LANE_MASKS;
+
+
+template<int clipMode>
+static void CastRotatedRaySSE(
+	const int2* squares,
+	size_t numSquares,
+	const float* invRadii,
+	const float* angles,
+	char* visible,
+	int radius,
+	int2 pos,
+	const SRectangle& clipRect
+) {
+	const __m128 bonusHeight = _mm_set1_ps(LOS_BONUS_HEIGHT);
+
+	__m128 maxAngles = _mm_set1_ps(-1e7f);
+	__m128 prvAngles = _mm_set1_ps(-1e7f);
+
+	// angle-map indices of a square and its rotations are {c + a, c - a, c - b, c + b}
+	const int stride = 2 * radius + 1;
+	const int center = radius * stride + radius;
+
+	int2 rotated[4];
+	int activeLanes = 0xF;
+
+	for (size_t n = 0; n < numSquares; n++) {
+		const int2 square = squares[n];
+
+		int lanes = 0xF;
+
+		if (clipMode != LosRaycast::CLIP_NONE) {
+			GetRotatedSquares(square, rotated);
+
+			lanes = GetClippedLanes(rotated, pos, clipRect);
+
+			if (clipMode == LosRaycast::CLIP_BREAK) {
+				if ((lanes = (activeLanes &= lanes)) == 0)
+					break;
+			} else {
+				if (lanes == 0)
+					continue;
+			}
+		}
+
+		const int a = square.y * stride + square.x;
+		const int b = square.x * stride - square.y;
+		const int oidx[4] = {center + a, center - a, center - b, center + b};
+
+		// all rotations are equally far from the emitter
+		const __m128 invR = _mm_set1_ps(invRadii[square.x * square.x + square.y * square.y]);
+		const __m128 angle = _mm_setr_ps(angles[oidx[0]], angles[oidx[1]], angles[oidx[2]], angles[oidx[3]]);
+
+		// same operations as the scalar version, evaluated for all lanes
+		const __m128 newMax = _mm_sub_ps(prvAngles, _mm_mul_ps(bonusHeight, invR));
+		const __m128 belowMax = _mm_cmplt_ps(angle, maxAngles);
+		const __m128 belowPrv = _mm_andnot_ps(belowMax, _mm_cmplt_ps(angle, prvAngles));
+		const __m128 belowNewMax = _mm_and_ps(belowPrv, _mm_cmplt_ps(angle, newMax));
+
+		__m128 hidden = _mm_or_ps(belowMax, belowNewMax);
+		__m128 setMax = belowPrv;
+		__m128 setPrv = _mm_andnot_ps(hidden, _mm_castsi128_ps(_mm_set1_epi32(-1)));
+
+		if (clipMode != LosRaycast::CLIP_NONE) {
+			const __m128 laneMask = LANE_MASKS.masks[lanes];
+
+			hidden = _mm_and_ps(hidden, laneMask);
+			setMax = _mm_and_ps(setMax, laneMask);
+			setPrv = _mm_and_ps(setPrv, laneMask);
+		}
+
+		maxAngles = _mm_or_ps(_mm_and_ps(setMax, newMax), _mm_andnot_ps(setMax, maxAngles));
+		prvAngles = _mm_or_ps(_mm_and_ps(setPrv,  angle), _mm_andnot_ps(setPrv, prvAngles));
+
+		const int hiddenLanes = _mm_movemask_ps(hidden);
+
+		if (hiddenLanes == 0)
+			continue;
+
+		for (int k = 0; k < 4; k++) {
+			if ((hiddenLanes & (1 << k)) != 0)
+				visible[oidx[k]] = false;
+		}
+	}
+}
+
+void LosRaycast::CastRotatedRaySSE(
+	const int2* squares,
+	size_t numSquares,
+	const float* invRadii,
+	const float* angles,
+	char* visible,
+	int radius,
+	int2 pos,
+	const SRectangle& clipRect,
+	int clipMode
+) {
+	switch (clipMode) {
+		case CLIP_NONE : { ::CastRotatedRaySSE<CLIP_NONE >(squares, numSquares, invRadii, angles, visible, radius, pos, clipRect); } break;
+		case CLIP_BREAK: { ::CastRotatedRaySSE<CLIP_BREAK>(squares, numSquares, invRadii, angles, visible, radius, pos, clipRect); } break;
+		case CLIP_SKIP : { ::CastRotatedRaySSE<CLIP_SKIP >(squares, numSquares, invRadii, angles, visible, radius, pos, clipRect); } break;
+		default        : { assert(false); } break;
+	}
+}
+
+#else
+
+void LosRaycast::CastRotatedRaySSE(
+	const int2* squares,
+	size_t numSquares,
+	const float* invRadii,
+	const float* angles,
+	char* visible,
+	int radius,
+	int2 pos,
+	const SRectangle& clipRect,
+	int clipMode
+) {
+	CastRotatedRayScalar(squares, numSquares, invRadii, angles, visible, radius, pos, clipRect, clipMode);
+}
+#endif
@@ -0,0 +1,74 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LOS_RAYCAST_H
+#define LOS_RAYCAST_H
+
+#include <cstddef>
+#include "System/Rectangle.h"
+#include "System/type2.h"
+
+constexpr float LOS_BONUS_HEIGHT = 5.0f;
+
+/**
+ * Ray-marching kernels used by CLosMap::{Unsafe,Safe}LosAdd.
+ *
+ * Every ray in the LOS-table is cast together with its three 90-degree
+ * rotations; <angles> and <visible> are (2 * radius + 1)^2 maps centered
+ * on the emitter, <invRadii> is indexed by squared distance. Casting only
+ * ever clears visibility flags and each rotation keeps its own state, so
+ * marching the four rotations in lockstep (one per SIMD lane) produces the
+ * same flags as casting them one after another.
+ */
+namespace LosRaycast {
+	enum {
+		CLIP_NONE  = 0, // every square of the ray lies within clipRect
+		CLIP_BREAK = 1, // a rotated ray ends at its first square outside clipRect
+		CLIP_SKIP  = 2, // squares outside clipRect are skipped (emitter is off-map)
+	};
+
+	/// reference implementation
+	void CastRotatedRayScalar(
+		const int2* squares,
+		size_t numSquares,
+		const float* invRadii,
+		const float* angles,
+		char* visible,
+		int radius,
+		int2 pos,
+		const SRectangle& clipRect,
+		int clipMode
+	);
+
+	/// four rotations per SSE2 register, bit-identical to the scalar version
+	void CastRotatedRaySSE(
+		const int2* squares,
+		size_t numSquares,
+		const float* invRadii,
+		const float* angles,
+		char* visible,
+		int radius,
+		int2 pos,
+		const SRectangle& clipRect,
+		int clipMode
+	);
+
+	inline void CastRotatedRay(
+		const int2* squares,
+		size_t numSquares,
+		const float* invRadii,
+		const float* angles,
+		char* visible,
+		int radius,
+		int2 pos,
+		const SRectangle& clipRect,
+		int clipMode
+	) {
+	#ifdef __SSE2__
+		CastRotatedRaySSE(squares, numSquares, invRadii, angles, visible, radius, pos, clipRect, clipMode);
+	#else
+		CastRotatedRayScalar(squares, numSquares, invRadii, angles, visible, radius, pos, clipRect, clipMode);
+	#endif
+	}
+}
+
+#endif // LOS_RAYCAST_H
@@ -80,6 +80,12 @@ void CModInfo::ResetState()
 	pathFinderSystem = PFS_TYPE_DEFAULT;
 	pfRawDistMult    = 1.25f;
 	pfUpdateRate     = 0.007f;
+	pfUpdateRateMaxMult = 1.0f;
+	pfRadixQueue = false;
+	qtpfsRadixQueue = false;
+	pfFlowFieldMinGroupSize = 0;
+
+	quadFieldMaxLoadFactor = 0.0f;
 
 	allowTake = true;
 }
@@ -117,6 +123,12 @@ void CModInfo::Init(const char* modArchive)
 		pathFinderSystem = system.GetInt("pathFinderSystem", PFS_TYPE_DEFAULT) % PFS_NUM_TYPES;
 		pfRawDistMult = system.GetFloat("pathFinderRawDistMult", pfRawDistMult);
 		pfUpdateRate = system.GetFloat("pathFinderUpdateRate", pfUpdateRate);
+		pfUpdateRateMaxMult = std::max(1.0f, system.GetFloat("pathFinderUpdateRateMaxMult", pfUpdateRateMaxMult));
+		pfRadixQueue = system.GetBool("pathFinderRadixQueue", pfRadixQueue);
+		qtpfsRadixQueue = system.GetBool("qtpfsRadixQueue", qtpfsRadixQueue);
+		pfFlowFieldMinGroupSize = std::max(0, system.GetInt("pathFinderFlowFieldMinGroupSize", pfFlowFieldMinGroupSize));
+
+		quadFieldMaxLoadFactor = system.GetFloat("quadFieldMaxLoadFactor", quadFieldMaxLoadFactor);
 
 		allowTake = system.GetBool("allowTake", true);
 	}
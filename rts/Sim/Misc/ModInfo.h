@@ -147,6 +147,21 @@ public:
 	int pathFinderSystem;
 	float pfRawDistMult;
 	float pfUpdateRate;
+	/// scales the maximum number of PE blocks re-estimated per frame (1 = off)
+	float pfUpdateRateMaxMult;
+	/// whether the open-lists of the default (PF and PE) and QTPFS searches are
+	/// monotone radix heaps rather than binary heaps; synced since ties between
+	/// equal-cost nodes can be broken differently
+	bool pfRadixQueue;
+	bool qtpfsRadixQueue;
+	/// minimum number of same-frame requests with equal MoveDef and goal that
+	/// share one goal-rooted low-res integration field instead of searching
+	/// individually (0 disables the field)
+	int pfFlowFieldMinGroupSize;
+
+	/// average number of objects per occupied QuadField quad above which
+	/// the field is rebuilt with finer quads (<= 0 keeps the quad size fixed)
+	float quadFieldMaxLoadFactor;
 
 	bool allowTake;
 };
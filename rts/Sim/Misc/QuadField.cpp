@@ -9,11 +9,15 @@
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "System/ContainerUtil.h"
+#include "System/Log/ILog.h"
 
 #ifndef UNIT_TEST
+	#include "Sim/Misc/ModInfo.h"
 	#include "Sim/Features/Feature.h"
 	#include "Sim/Projectiles/Projectile.h"
 	#include "Sim/Units/Unit.h"
+	#include "Sim/Units/UnitHandler.h"
+	#include "Sim/Units/UnitHotState.h"
 	#include "Sim/Weapons/PlasmaRepulser.h"
 #endif
 
@@ -24,12 +28,10 @@ CR_REG_METADATA(CQuadField, (
 	CR_MEMBER(numQuadsZ),
 	CR_MEMBER(quadSizeX),
 	CR_MEMBER(quadSizeZ),
+	CR_MEMBER(pendingQuadSize),
 
-	CR_IGNORED(tempUnits),
-	CR_IGNORED(tempFeatures),
-	CR_IGNORED(tempProjectiles),
-	CR_IGNORED(tempSolids),
-	CR_IGNORED(tempQuads)
+	CR_IGNORED(queryScratch),
+	CR_IGNORED(collisionGrid)
 ))
 
 CR_BIND(CQuadField::Quad, )
@@ -47,53 +49,203 @@ CR_REG_METADATA_SUB(CQuadField, Quad, (
 CQuadField quadField;
 
 
+template<typename T>
+static inline bool MarkObject(std::vector<int>& stamps, const T* obj, int tempNum)
+{
+	assert(obj->id >= 0);
+
+	if (static_cast<size_t>(obj->id) >= stamps.size())
+		stamps.resize(obj->id + 1, 0);
+
+	if (stamps[obj->id] == tempNum)
+		return false;
+
+	stamps[obj->id] = tempNum;
+	return true;
+}
+
+// frames between load-factor checks when adaptive resizing is enabled
+static constexpr int LOAD_CHECK_INTERVAL = GAME_SPEED * 5;
+
+
 #ifndef UNIT_TEST
-/*
-void CQuadField::Resize(int quad_size)
-{
-	CQuadField* oldQuadField = &quadField;
-	CQuadField newQuadField;
-
-	newQuadField.Init(int2(mapDims.mapx, mapDims.mapy), quad_size);
-
-	for (int zq = 0; zq < oldQuadField->GetNumQuadsZ(); zq++) {
-		for (int xq = 0; xq < oldQuadField->GetNumQuadsX(); xq++) {
-			const CQuadField::Quad& quad = oldQuadField->GetQuadAt(xq, zq);
-
-			// COPY the object lists because the Remove* functions modify them
-			// NOTE:
-			//   teamUnits is updated internally by RemoveUnit and MovedUnit
-			//
-			//   if a unit exists in multiple quads in the old field, it will
-			//   be removed from all of them and there is no danger of double
-			//   re-insertion (important if new grid has higher resolution)
-			const std::vector<CUnit*      > units       = quad.units;
-			const std::vector<CFeature*   > features    = quad.features;
-			const std::vector<CProjectile*> projectiles = quad.projectiles;
-
-			for (auto it = units.cbegin(); it != units.cend(); ++it) {
-				oldQuadField->RemoveUnit(*it);
-				newQuadField->MovedUnit(*it); // handles addition
-			}
+void CQuadField::Update()
+{
+	if (pendingQuadSize != 0) {
+		Resize(pendingQuadSize);
+		pendingQuadSize = 0;
+		return;
+	}
 
-			for (auto it = features.cbegin(); it != features.cend(); ++it) {
-				oldQuadField->RemoveFeature(*it);
-				newQuadField->AddFeature(*it);
-			}
+	if (modInfo.quadFieldMaxLoadFactor <= 0.0f)
+		return;
+	if ((gs->frameNum % LOAD_CHECK_INTERVAL) != 0)
+		return;
 
-			for (auto it = projectiles.cbegin(); it != projectiles.cend(); ++it) {
-				oldQuadField->RemoveProjectile(*it);
-				newQuadField->AddProjectile(*it);
-			}
+	assert(quadSizeX == quadSizeZ);
+
+	// halving the quad size divides the load by ~4 (and doubling multiplies
+	// it by ~4), so coarsening below 1/8th of the threshold can not result
+	// in a field that immediately wants to be refined again
+	const float loadFactor = GetLoadFactor();
+
+	if (loadFactor > modInfo.quadFieldMaxLoadFactor) {
+		if (IsValidQuadSize(quadSizeX >> 1))
+			Resize(quadSizeX >> 1);
+
+		return;
+	}
+
+	if (loadFactor < (modInfo.quadFieldMaxLoadFactor * 0.125f)) {
+		if (IsValidQuadSize(quadSizeX << 1))
+			Resize(quadSizeX << 1);
+	}
+}
+
+void CQuadField::Resize(int quadSize)
+{
+	if (quadSize == quadSizeX && quadSize == quadSizeZ)
+		return;
+
+	assert(IsValidQuadSize(quadSize));
+	assert(ThreadPool::GetThreadNum() == 0);
+
+	// taken before the quads are emptied below
+	const float loadFactor = GetLoadFactor();
+
+	std::vector<CUnit*> units;
+	std::vector<CFeature*> features;
+	std::vector<CProjectile*> projectiles;
+	std::vector<CPlasmaRepulser*> repulsers;
+
+	// collect every object exactly once and in quad order (so the rebuilt
+	// field is identical on all clients); objects that remember their quads
+	// are taken from the first one, features are deduplicated via tempNum
+	const int tempNum = gs->GetTempNum();
+
+	for (int qi = 0, n = baseQuads.size(); qi < n; qi++) {
+		Quad& quad = baseQuads[qi];
+
+		for (CUnit* u: quad.units) {
+			if (u->quads.front() == qi)
+				units.push_back(u);
+		}
+		for (CFeature* f: quad.features) {
+			if (f->tempNum == tempNum)
+				continue;
+
+			f->tempNum = tempNum;
+			features.push_back(f);
+		}
+		for (CProjectile* p: quad.projectiles) {
+			if (p->quads.front() == qi)
+				projectiles.push_back(p);
 		}
+		for (CPlasmaRepulser* r: quad.repulsers) {
+			if (r->GetQuads().front() == qi)
+				repulsers.push_back(r);
+		}
+
+		quad.Clear();
 	}
 
-	quadField = std::move(newQuadField);
+	LOG("[QuadField::%s] quad size %d -> %d (load factor %.2f)", __func__, quadSizeX, quadSize, loadFactor);
+
+	Init(int2(mapDims.mapx, mapDims.mapy), quadSize);
+
+	for (CUnit* u: units) {
+		u->quads.clear();
+		MovedUnit(u);
+	}
+	for (CFeature* f: features) {
+		AddFeature(f);
+	}
+	for (CProjectile* p: projectiles) {
+		p->quads.clear();
+		AddProjectile(p);
+	}
+	for (CPlasmaRepulser* r: repulsers) {
+		r->ClearQuads();
+		MovedRepulser(r);
+	}
 }
-*/
 #endif
 
 
+bool CQuadField::RequestResize(int quadSize)
+{
+	if (!IsValidQuadSize(quadSize))
+		return false;
+
+	pendingQuadSize = quadSize;
+	return true;
+}
+
+bool CQuadField::IsValidQuadSize(int quadSize) const
+{
+	if (quadSize < int(MIN_QUAD_SIZE) || quadSize > int(MAX_QUAD_SIZE))
+		return false;
+	if ((quadSize & (quadSize - 1)) != 0)
+		return false;
+
+	// the field must still cover the map exactly
+	return (((numQuadsX * quadSizeX) % quadSize) == 0 && ((numQuadsZ * quadSizeZ) % quadSize) == 0);
+}
+
+
+void CQuadField::GetOccupancyStats(OccupancyStats& stats) const
+{
+	const auto CountToBin = [](unsigned int count) {
+		unsigned int bin = 0;
+
+		for (; count != 0 && bin < (NUM_OCCUPANCY_BINS - 1); count >>= 1) {
+			bin++;
+		}
+
+		return bin;
+	};
+
+	for (auto& hist: stats.histograms) {
+		hist.fill(0);
+	}
+
+	stats.maxCounts.fill(0);
+	stats.sumCounts.fill(0);
+	stats.numOccupiedQuads = 0;
+
+	for (const Quad& quad: baseQuads) {
+		const std::array<unsigned int, QUAD_OBJECT_TYPES> counts = {{
+			static_cast<unsigned int>(quad.units.size()),
+			static_cast<unsigned int>(quad.features.size()),
+			static_cast<unsigned int>(quad.projectiles.size()),
+		}};
+
+		for (unsigned int i = 0; i < QUAD_OBJECT_TYPES; i++) {
+			stats.histograms[i][CountToBin(counts[i])] += 1;
+			stats.maxCounts[i] = std::max(stats.maxCounts[i], counts[i]);
+			stats.sumCounts[i] += counts[i];
+		}
+
+		stats.numOccupiedQuads += ((counts[0] + counts[1] + counts[2]) != 0);
+	}
+}
+
+float CQuadField::GetLoadFactor() const
+{
+	unsigned int numObjects = 0;
+	unsigned int numOccupiedQuads = 0;
+
+	for (const Quad& quad: baseQuads) {
+		const unsigned int n = quad.units.size() + quad.features.size() + quad.projectiles.size();
+
+		numObjects += n;
+		numOccupiedQuads += (n != 0);
+	}
+
+	return (numObjects / std::max(1.0f, numOccupiedQuads * 1.0f));
+}
+
+
 void CQuadField::Quad::PostLoad()
 {
 #ifndef UNIT_TEST
@@ -128,17 +280,27 @@ void CQuadField::Init(int2 mapDims, int quadSize)
 
 void CQuadField::Kill()
 {
+	pendingQuadSize = 0;
+
 	// reuse quads when reloading
 	// baseQuads.clear();
 	for (Quad& quad: baseQuads) {
 		quad.Clear();
 	}
 
-	tempUnits.ReleaseAll();
-	tempFeatures.ReleaseAll();
-	tempProjectiles.ReleaseAll();
-	tempSolids.ReleaseAll();
-	tempQuads.ReleaseAll();
+	for (std::vector<int>& cell: collisionGrid.cells) {
+		cell.clear();
+	}
+
+	collisionGrid.unitCells.clear();
+
+	for (QueryScratch& qs: queryScratch) {
+		qs.tempUnits.ReleaseAll();
+		qs.tempFeatures.ReleaseAll();
+		qs.tempProjectiles.ReleaseAll();
+		qs.tempSolids.ReleaseAll();
+		qs.tempQuads.ReleaseAll();
+	}
 }
 
 
@@ -162,7 +324,7 @@ void CQuadField::GetQuads(QuadFieldQuery& qfq, float3 pos, float radius)
 {
 	pos.AssertNaNs();
 	pos.ClampInBounds();
-	qfq.quads = tempQuads.GetVector();
+	qfq.quads = queryScratch[qfq.threadOwner].tempQuads.GetVector();
 
 	const int2 min = WorldPosToQuadField(pos - radius);
 	const int2 max = WorldPosToQuadField(pos + radius);
@@ -192,7 +354,7 @@ void CQuadField::GetQuadsRectangle(QuadFieldQuery& qfq, const float3& mins, cons
 {
 	mins.AssertNaNs();
 	maxs.AssertNaNs();
-	qfq.quads = tempQuads.GetVector();
+	qfq.quads = queryScratch[qfq.threadOwner].tempQuads.GetVector();
 
 	const int2 min = WorldPosToQuadField(mins);
 	const int2 max = WorldPosToQuadField(maxs);
@@ -218,7 +380,7 @@ void CQuadField::GetQuadsOnRay(QuadFieldQuery& qfq, const float3& start, const f
 {
 	dir.AssertNaNs();
 	start.AssertNaNs();
-	qfq.quads = tempQuads.GetVector();
+	qfq.quads = queryScratch[qfq.threadOwner].tempQuads.GetVector();
 
 	const float3 to = start + (dir * length);
 	const float3 invQuadSize = float3(1.0f / quadSizeX, 1.0f, 1.0f / quadSizeZ);
@@ -336,6 +498,112 @@ void CQuadField::RemoveUnit(CUnit* unit)
 }
 
 
+int CQuadField::GetColliderCell(int unitID) const
+{
+	const float4& posRadius = unitHotState.GetPosRadius(unitID);
+
+	if (posRadius.w > COLLISION_CELL_SIZE)
+		return (collisionGrid.cells.size() - 1);
+
+	const int x = Clamp(int(posRadius.x / COLLISION_CELL_SIZE), 0, collisionGrid.numCellsX - 1);
+	const int z = Clamp(int(posRadius.z / COLLISION_CELL_SIZE), 0, collisionGrid.numCellsZ - 1);
+
+	return (z * collisionGrid.numCellsX + x);
+}
+
+void CQuadField::BuildCollisionGrid(const std::vector<CUnit*>& units)
+{
+	CollisionGrid& cg = collisionGrid;
+
+	// quads always cover the whole map, whatever their size
+	cg.numCellsX = std::max(1, (numQuadsX * quadSizeX) / COLLISION_CELL_SIZE);
+	cg.numCellsZ = std::max(1, (numQuadsZ * quadSizeZ) / COLLISION_CELL_SIZE);
+
+	// keep the cells' capacity between frames
+	cg.cells.resize(cg.numCellsX * cg.numCellsZ + 1);
+
+	for (std::vector<int>& cell: cg.cells) {
+		cell.clear();
+	}
+
+	std::fill(cg.unitCells.begin(), cg.unitCells.end(), -1);
+
+	for (const CUnit* u: units) {
+		if (static_cast<size_t>(u->id) >= cg.unitCells.size())
+			cg.unitCells.resize(u->id + 1, -1);
+
+		cg.cells[cg.unitCells[u->id] = GetColliderCell(u->id)].push_back(u->id);
+	}
+}
+
+void CQuadField::MovedCollider(CUnit* unit)
+{
+	CollisionGrid& cg = collisionGrid;
+
+	// created after the grid was built, picked up by the next rebuild
+	if (static_cast<size_t>(unit->id) >= cg.unitCells.size() || cg.unitCells[unit->id] < 0)
+		return;
+
+	const int oldCell = cg.unitCells[unit->id];
+	const int newCell = GetColliderCell(unit->id);
+
+	if (newCell == oldCell)
+		return;
+
+	spring::VectorErase(cg.cells[oldCell], unit->id);
+	cg.cells[cg.unitCells[unit->id] = newCell].push_back(unit->id);
+}
+
+void CQuadField::GetCollidersExact(QuadFieldQuery& qfq, const float3& pos, float radius, bool spherical)
+{
+	const CollisionGrid& cg = collisionGrid;
+
+	if (cg.cells.empty()) {
+		GetUnitsExact(qfq, pos, radius, spherical);
+		return;
+	}
+
+	assert(ThreadPool::GetThreadNum() == 0);
+
+	QueryScratch& qs = queryScratch[qfq.threadOwner];
+	qfq.units = qs.tempUnits.GetVector();
+
+	// distances are tested against the hot-state store, only the units
+	// that pass are fetched
+	const auto AddCellUnits = [&](const std::vector<int>& cell) {
+		for (const int unitID: cell) {
+			const float4& posRadius  = unitHotState.GetPosRadius(unitID);
+			const float totRad       = radius + posRadius.w;
+			const float totRadSq     = totRad * totRad;
+			const float posUnitDstSq = spherical?
+				pos.SqDistance(posRadius):
+				pos.SqDistance2D(posRadius);
+
+			if (posUnitDstSq >= totRadSq)
+				continue;
+
+			qfq.units->push_back(unitHandler.GetUnit(unitID));
+		}
+	};
+
+	// units in the regular cells are at most COLLISION_CELL_SIZE in radius
+	const float cellRadius = radius + COLLISION_CELL_SIZE;
+
+	const int minX = Clamp(int((pos.x - cellRadius) / COLLISION_CELL_SIZE), 0, cg.numCellsX - 1);
+	const int minZ = Clamp(int((pos.z - cellRadius) / COLLISION_CELL_SIZE), 0, cg.numCellsZ - 1);
+	const int maxX = Clamp(int((pos.x + cellRadius) / COLLISION_CELL_SIZE), 0, cg.numCellsX - 1);
+	const int maxZ = Clamp(int((pos.z + cellRadius) / COLLISION_CELL_SIZE), 0, cg.numCellsZ - 1);
+
+	for (int z = minZ; z <= maxZ; z++) {
+		for (int x = minX; x <= maxX; x++) {
+			AddCellUnits(cg.cells[z * cg.numCellsX + x]);
+		}
+	}
+
+	AddCellUnits(cg.cells.back());
+}
+
+
 void CQuadField::MovedRepulser(CPlasmaRepulser* repulser)
 {
 	QuadFieldQuery qfQuery;
@@ -464,15 +732,14 @@ void CQuadField::GetUnits(QuadFieldQuery& qfq, const float3& pos, float radius)
 {
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, pos, radius);
-	const int tempNum = gs->GetTempNum();
-	qfq.units = tempUnits.GetVector();
+	QueryScratch& qs = queryScratch[qfq.threadOwner];
+	const int tempNum = qs.GetTempNum();
+	qfq.units = qs.tempUnits.GetVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CUnit* u: baseQuads[qi].units) {
-			if (u->tempNum == tempNum)
+			if (!MarkObject(qs.unitStamps, u, tempNum))
 				continue;
-
-			u->tempNum = tempNum;
 			qfq.units->push_back(u);
 		}
 	}
@@ -484,16 +751,15 @@ void CQuadField::GetUnitsExact(QuadFieldQuery& qfq, const float3& pos, float rad
 {
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, pos, radius);
-	const int tempNum = gs->GetTempNum();
-	qfq.units = tempUnits.GetVector();
+	QueryScratch& qs = queryScratch[qfq.threadOwner];
+	const int tempNum = qs.GetTempNum();
+	qfq.units = qs.tempUnits.GetVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CUnit* u: baseQuads[qi].units) {
-			if (u->tempNum == tempNum)
+			if (!MarkObject(qs.unitStamps, u, tempNum))
 				continue;
 
-			u->tempNum = tempNum;
-
 			const float totRad       = radius + u->radius;
 			const float totRadSq     = totRad * totRad;
 			const float posUnitDstSq = spherical?
@@ -514,17 +780,16 @@ void CQuadField::GetUnitsExact(QuadFieldQuery& qfq, const float3& mins, const fl
 {
 	QuadFieldQuery qfQuery;
 	GetQuadsRectangle(qfQuery, mins, maxs);
-	const int tempNum = gs->GetTempNum();
-	qfq.units = tempUnits.GetVector();
+	QueryScratch& qs = queryScratch[qfq.threadOwner];
+	const int tempNum = qs.GetTempNum();
+	qfq.units = qs.tempUnits.GetVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CUnit* unit: baseQuads[qi].units) {
 
-			if (unit->tempNum == tempNum)
+			if (!MarkObject(qs.unitStamps, unit, tempNum))
 				continue;
 
-			unit->tempNum = tempNum;
-
 			const float3& pos = unit->pos;
 			if (pos.x < mins.x || pos.x > maxs.x)
 				continue;
@@ -543,16 +808,15 @@ void CQuadField::GetFeaturesExact(QuadFieldQuery& qfq, const float3& pos, float
 {
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, pos, radius);
-	const int tempNum = gs->GetTempNum();
-	qfq.features = tempFeatures.GetVector();
+	QueryScratch& qs = queryScratch[qfq.threadOwner];
+	const int tempNum = qs.GetTempNum();
+	qfq.features = qs.tempFeatures.GetVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CFeature* f: baseQuads[qi].features) {
-			if (f->tempNum == tempNum)
+			if (!MarkObject(qs.featureStamps, f, tempNum))
 				continue;
 
-			f->tempNum = tempNum;
-
 			const float totRad       = radius + f->radius;
 			const float totRadSq     = totRad * totRad;
 			const float posDstSq = spherical?
@@ -573,16 +837,15 @@ void CQuadField::GetFeaturesExact(QuadFieldQuery& qfq, const float3& mins, const
 {
 	QuadFieldQuery qfQuery;
 	GetQuadsRectangle(qfQuery, mins, maxs);
-	const int tempNum = gs->GetTempNum();
-	qfq.features = tempFeatures.GetVector();
+	QueryScratch& qs = queryScratch[qfq.threadOwner];
+	const int tempNum = qs.GetTempNum();
+	qfq.features = qs.tempFeatures.GetVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CFeature* feature: baseQuads[qi].features) {
-			if (feature->tempNum == tempNum)
+			if (!MarkObject(qs.featureStamps, feature, tempNum))
 				continue;
 
-			feature->tempNum = tempNum;
-
 			const float3& pos = feature->pos;
 			if (pos.x < mins.x || pos.x > maxs.x)
 				continue;
@@ -602,16 +865,15 @@ void CQuadField::GetProjectilesExact(QuadFieldQuery& qfq, const float3& pos, flo
 {
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, pos, radius);
-	const int tempNum = gs->GetTempNum();
-	qfq.projectiles = tempProjectiles.GetVector();
+	QueryScratch& qs = queryScratch[qfq.threadOwner];
+	const int tempNum = qs.GetTempNum();
+	qfq.projectiles = qs.tempProjectiles.GetVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CProjectile* p: baseQuads[qi].projectiles) {
-			if (p->tempNum == tempNum)
+			if (!MarkObject(qs.projectileStamps, p, tempNum))
 				continue;
 
-			p->tempNum = tempNum;
-
 			if (pos.SqDistance(p->pos) >= Square(radius + p->radius))
 				continue;
 
@@ -626,16 +888,15 @@ void CQuadField::GetProjectilesExact(QuadFieldQuery& qfq, const float3& mins, co
 {
 	QuadFieldQuery qfQuery;
 	GetQuadsRectangle(qfQuery, mins, maxs);
-	const int tempNum = gs->GetTempNum();
-	qfq.projectiles = tempProjectiles.GetVector();
+	QueryScratch& qs = queryScratch[qfq.threadOwner];
+	const int tempNum = qs.GetTempNum();
+	qfq.projectiles = qs.tempProjectiles.GetVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CProjectile* p: baseQuads[qi].projectiles) {
-			if (p->tempNum == tempNum)
+			if (!MarkObject(qs.projectileStamps, p, tempNum))
 				continue;
 
-			p->tempNum = tempNum;
-
 			const float3& pos = p->pos;
 			if (pos.x < mins.x || pos.x > maxs.x)
 				continue;
@@ -660,16 +921,15 @@ void CQuadField::GetSolidsExact(
 ) {
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, pos, radius);
-	const int tempNum = gs->GetTempNum();
-	qfq.solids = tempSolids.GetVector();
+	QueryScratch& qs = queryScratch[qfq.threadOwner];
+	const int tempNum = qs.GetTempNum();
+	qfq.solids = qs.tempSolids.GetVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CUnit* u: baseQuads[qi].units) {
-			if (u->tempNum == tempNum)
+			if (!MarkObject(qs.unitStamps, u, tempNum))
 				continue;
 
-			u->tempNum = tempNum;
-
 			if (!u->HasPhysicalStateBit(physicalStateBits))
 				continue;
 			if (!u->HasCollidableStateBit(collisionStateBits))
@@ -681,11 +941,9 @@ void CQuadField::GetSolidsExact(
 		}
 
 		for (CFeature* f: baseQuads[qi].features) {
-			if (f->tempNum == tempNum)
+			if (!MarkObject(qs.featureStamps, f, tempNum))
 				continue;
 
-			f->tempNum = tempNum;
-
 			if (!f->HasPhysicalStateBit(physicalStateBits))
 				continue;
 			if (!f->HasCollidableStateBit(collisionStateBits))
@@ -709,15 +967,14 @@ bool CQuadField::NoSolidsExact(
 ) {
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, pos, radius);
-	const int tempNum = gs->GetTempNum();
+	QueryScratch& qs = queryScratch[qfQuery.threadOwner];
+	const int tempNum = qs.GetTempNum();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CUnit* u: baseQuads[qi].units) {
-			if (u->tempNum == tempNum)
+			if (!MarkObject(qs.unitStamps, u, tempNum))
 				continue;
 
-			u->tempNum = tempNum;
-
 			if (!u->HasPhysicalStateBit(physicalStateBits))
 				continue;
 			if (!u->HasCollidableStateBit(collisionStateBits))
@@ -729,11 +986,9 @@ bool CQuadField::NoSolidsExact(
 		}
 
 		for (CFeature* f: baseQuads[qi].features) {
-			if (f->tempNum == tempNum)
+			if (!MarkObject(qs.featureStamps, f, tempNum))
 				continue;
 
-			f->tempNum = tempNum;
-
 			if (!f->HasPhysicalStateBit(physicalStateBits))
 				continue;
 			if (!f->HasCollidableStateBit(collisionStateBits))
@@ -757,22 +1012,22 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 	std::vector<CFeature*>& features,
 	std::vector<CPlasmaRepulser*>* repulsers
 ) {
-	const int tempNum = gs->GetTempNum();
-
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, pos, radius);
+	QueryScratch& qs = queryScratch[qfQuery.threadOwner];
+	const int tempNum = qs.GetTempNum();
+
 	// start counting from the previous object-cache sizes
+	const size_t repulsersOffset = (repulsers != nullptr)? repulsers->size(): 0;
 
 	for (const int qi: *qfQuery.quads) {
 		const Quad& quad = baseQuads[qi];
 
 		for (CUnit* u: quad.units) {
 			// prevent double adding
-			if (u->tempNum == tempNum)
+			if (!MarkObject(qs.unitStamps, u, tempNum))
 				continue;
 
-			u->tempNum = tempNum;
-
 			const auto* colvol = &u->collisionVolume;
 			const float totRad = radius + colvol->GetBoundingRadius();
 
@@ -784,11 +1039,9 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 
 		for (CFeature* f: quad.features) {
 			// prevent double adding
-			if (f->tempNum == tempNum)
+			if (!MarkObject(qs.featureStamps, f, tempNum))
 				continue;
 
-			f->tempNum = tempNum;
-
 			const auto* colvol = &f->collisionVolume;
 			const float totRad = radius + colvol->GetBoundingRadius();
 
@@ -799,12 +1052,10 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 		}
 		if (repulsers != nullptr) {
 			for (CPlasmaRepulser* r: quad.repulsers) {
-				// prevent double adding
-				if (r->tempNum == tempNum)
+				// prevent double adding; repulsers have no ID to stamp but are few
+				if (std::find(repulsers->begin() + repulsersOffset, repulsers->end(), r) != repulsers->end())
 					continue;
 
-				r->tempNum = tempNum;
-
 				const auto* colvol = &r->collisionVolume;
 				const float totRad = radius + colvol->GetBoundingRadius();
 
@@ -11,6 +11,7 @@
 #include "System/creg/creg_cond.h"
 #include "System/float3.h"
 #include "System/type2.h"
+#include "System/Threading/ThreadPool.h"
 
 class CUnit;
 class CFeature;
@@ -19,12 +20,13 @@ class CSolidObject;
 class CPlasmaRepulser;
 struct QuadFieldQuery;
 
+// NOTE: not thread-safe, CQuadField keeps one set per thread
 template<typename T>
 class ExclusiveVectors {
 public:
 	// There should at most be 2 concurrent users of each vector type
-	// using 3 to be safe, increase this number if the assertions below
-	// fail
+	// (per thread) using 3 to be safe, increase this number if the
+	// assertions below fail
 	static constexpr int MAX_CONCURRENT_VECTORS = 3;
 
 	ExclusiveVectors() {
@@ -79,19 +81,52 @@ class CQuadField : spring::noncopyable
 	CR_DECLARE_SUB(Quad)
 
 public:
+	enum {
+		QUAD_OBJECT_UNITS       = 0,
+		QUAD_OBJECT_FEATURES    = 1,
+		QUAD_OBJECT_PROJECTILES = 2,
+		QUAD_OBJECT_TYPES       = 3,
+	};
+
+	// bin 0 counts empty quads, bin i > 0 counts quads holding
+	// [2^(i-1), 2^i) objects of a type; the last bin is open-ended
+	constexpr static unsigned int NUM_OCCUPANCY_BINS = 12;
 
-	/*
-	needed to support dynamic resizing (not used yet)
-	in large games the average loading factor (number of objects per quad)
-	can grow too large to maintain amortized constant performance so more
-	quads are needed
+	struct OccupancyStats {
+		std::array<std::array<unsigned int, NUM_OCCUPANCY_BINS>, QUAD_OBJECT_TYPES> histograms;
+		std::array<unsigned int, QUAD_OBJECT_TYPES> maxCounts;
+		std::array<unsigned int, QUAD_OBJECT_TYPES> sumCounts;
 
-	static void Resize(int quadSize);
-	*/
+		// number of quads holding at least one unit, feature or projectile
+		unsigned int numOccupiedQuads;
+	};
 
+public:
 	void Init(int2 mapDims, int quadSize);
 	void Kill();
 
+	/**
+	 * Called between sim-frames; applies a pending RequestResize or,
+	 * if enabled via modrules, adapts the quad size to the load factor.
+	 * In large games the average loading factor (number of objects per
+	 * quad) can grow too large to maintain amortized constant performance
+	 * so more quads are needed, and fewer are cheaper when units thin out.
+	 */
+	void Update();
+	/**
+	 * Rebuilds the field with the given quad size and reinserts every
+	 * object; must not be called while any QuadFieldQuery is alive
+	 */
+	void Resize(int quadSize);
+	/// schedules a Resize for the end of the current sim-frame
+	bool RequestResize(int quadSize);
+
+	bool IsValidQuadSize(int quadSize) const;
+
+	void GetOccupancyStats(OccupancyStats& stats) const;
+	/// average number of objects per occupied quad
+	float GetLoadFactor() const;
+
 	void GetQuads(QuadFieldQuery& qfq, float3 pos, float radius);
 	void GetQuadsRectangle(QuadFieldQuery& qfq, const float3& mins, const float3& maxs);
 	void GetQuadsOnRay(QuadFieldQuery& qfq, const float3& start, const float3& dir, float length);
@@ -153,6 +188,22 @@ public:
 	void MovedUnit(CUnit* unit);
 	void RemoveUnit(CUnit* unit);
 
+	/**
+	 * Rebuilds the collision grid from the current positions of <units>;
+	 * called once per frame before the move-types are updated. This is a
+	 * finer grid holding every unit exactly once (by its center) that the
+	 * ground move-types use as broadphase for unit-unit collisions. Unlike
+	 * the quads, which units only change on SlowUpdate, it is kept current
+	 * during the frame through MovedCollider.
+	 */
+	void BuildCollisionGrid(const std::vector<CUnit*>& units);
+	void MovedCollider(CUnit* unit);
+	/**
+	 * Same as GetUnitsExact, but answered by the collision grid; results
+	 * are ordered by cell and by insertion within a cell
+	 */
+	void GetCollidersExact(QuadFieldQuery& qfq, const float3& pos, float radius, bool spherical = true);
+
 	void AddFeature(CFeature* feature);
 	void RemoveFeature(CFeature* feature);
 
@@ -163,11 +214,11 @@ public:
 	void MovedRepulser(CPlasmaRepulser* repulser);
 	void RemoveRepulser(CPlasmaRepulser* repulser);
 
-	void ReleaseVector(std::vector<CUnit*>* v       ) { tempUnits.ReleaseVector(v); }
-	void ReleaseVector(std::vector<CFeature*>* v    ) { tempFeatures.ReleaseVector(v); }
-	void ReleaseVector(std::vector<CProjectile*>* v ) { tempProjectiles.ReleaseVector(v); }
-	void ReleaseVector(std::vector<CSolidObject*>* v) { tempSolids.ReleaseVector(v); }
-	void ReleaseVector(std::vector<int>* v          ) { tempQuads.ReleaseVector(v); }
+	void ReleaseVector(std::vector<CUnit*>* v       , int thread) { queryScratch[thread].tempUnits.ReleaseVector(v); }
+	void ReleaseVector(std::vector<CFeature*>* v    , int thread) { queryScratch[thread].tempFeatures.ReleaseVector(v); }
+	void ReleaseVector(std::vector<CProjectile*>* v , int thread) { queryScratch[thread].tempProjectiles.ReleaseVector(v); }
+	void ReleaseVector(std::vector<CSolidObject*>* v, int thread) { queryScratch[thread].tempSolids.ReleaseVector(v); }
+	void ReleaseVector(std::vector<int>* v          , int thread) { queryScratch[thread].tempQuads.ReleaseVector(v); }
 
 	struct Quad {
 	public:
@@ -226,6 +277,10 @@ public:
 	int GetQuadSizeZ() const { return quadSizeZ; }
 
 	constexpr static unsigned int BASE_QUAD_SIZE = 128;
+	constexpr static unsigned int MIN_QUAD_SIZE = BASE_QUAD_SIZE / 2;
+	constexpr static unsigned int MAX_QUAD_SIZE = BASE_QUAD_SIZE * 4;
+	/// units with a larger radius are kept in a separate list of the grid
+	constexpr static int COLLISION_CELL_SIZE = 64;
 
 private:
 	// optimized functions, somewhat less userfriendly
@@ -239,21 +294,62 @@ private:
 	int2 WorldPosToQuadField(const float3 p) const;
 	int WorldPosToQuadFieldIdx(const float3 p) const;
 
+	int GetColliderCell(int unitID) const;
+
+private:
+	// Queries only read the quads and otherwise touch nothing but the
+	// scratch state of the calling thread, so they can be issued from
+	// ThreadPool workers without locking as long as no Add/Moved/Remove
+	// or Resize call runs at the same time (those are main-thread only).
+	struct QueryScratch {
+	public:
+		int GetTempNum() { return tempNum++; }
+
+	public:
+		// preallocated vectors for Get*Exact functions
+		ExclusiveVectors<CUnit*> tempUnits;
+		ExclusiveVectors<CFeature*> tempFeatures;
+		ExclusiveVectors<CProjectile*> tempProjectiles;
+		ExclusiveVectors<CSolidObject*> tempSolids;
+		ExclusiveVectors<int> tempQuads;
+
+		// duplicate-filtering stamps indexed by object ID; objects are in
+		// multiple quads and CSolidObject::tempNum can not be shared with
+		// other threads
+		std::vector<int> unitStamps;
+		std::vector<int> featureStamps;
+		std::vector<int> projectileStamps;
+
+		int tempNum = 1;
+	};
+
 private:
 	std::vector<Quad> baseQuads;
 
-	// preallocated vectors for Get*Exact functions
-	ExclusiveVectors<CUnit*> tempUnits;
-	ExclusiveVectors<CFeature*> tempFeatures;
-	ExclusiveVectors<CProjectile*> tempProjectiles;
-	ExclusiveVectors<CSolidObject*> tempSolids;
-	ExclusiveVectors<int> tempQuads;
+	std::array<QueryScratch, ThreadPool::MAX_THREADS> queryScratch;
+
+	struct CollisionGrid {
+		// one list of unit-IDs per cell plus a trailing one for units larger
+		// than a cell, which every query has to check
+		std::vector< std::vector<int> > cells;
+		// cell per unit-ID, -1 for units not (yet) in the grid
+		std::vector<int> unitCells;
+
+		int numCellsX = 0;
+		int numCellsZ = 0;
+	};
+
+	// rebuilt every frame, main-thread only
+	CollisionGrid collisionGrid;
 
 	int numQuadsX;
 	int numQuadsZ;
 
 	int quadSizeX;
 	int quadSizeZ;
+
+	// requested by RequestResize, applied by Update (0 if none)
+	int pendingQuadSize = 0;
 };
 
 extern CQuadField quadField;
@@ -261,13 +357,16 @@ extern CQuadField quadField;
 
 struct QuadFieldQuery {
 	~QuadFieldQuery() {
-		quadField.ReleaseVector(units);
-		quadField.ReleaseVector(features);
-		quadField.ReleaseVector(projectiles);
-		quadField.ReleaseVector(solids);
-		quadField.ReleaseVector(quads);
+		quadField.ReleaseVector(units, threadOwner);
+		quadField.ReleaseVector(features, threadOwner);
+		quadField.ReleaseVector(projectiles, threadOwner);
+		quadField.ReleaseVector(solids, threadOwner);
+		quadField.ReleaseVector(quads, threadOwner);
 	}
 
+	// results live in the scratch vectors of the creating thread
+	const int threadOwner = ThreadPool::GetThreadNum();
+
 	std::vector<CUnit*>* units = nullptr;
 	std::vector<CFeature*>* features = nullptr;
 	std::vector<CProjectile*>* projectiles = nullptr;
@@ -3,22 +3,35 @@
 #ifndef SIMOBJECT_MEMPOOL_H
 #define SIMOBJECT_MEMPOOL_H
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef> // offsetof
+#include <cstdint>
 #include <cstring> // memset
 #include <array>
 #include <deque>
 #include <vector>
 
-#include "System/UnorderedMap.hpp"
 #include "System/ContainerUtil.h"
 #include "System/SafeUtil.h"
 
+// NOTE:
+//   freed pages are only zeroed up to the size that was requested for them,
+//   which is all a later object can observe of its predecessor; DEBUG builds
+//   wipe the full page
+//   this can not be moved to allocMem, the compiler is free to drop stores
+//   made right before a constructor runs (-flifetime-dse)
+#ifdef DEBUG
+#define SIMOBJECT_MEMPOOL_WIPE_FREED 1
+#else
+#define SIMOBJECT_MEMPOOL_WIPE_FREED 0
+#endif
+
 template<size_t S> struct DynMemPool {
 public:
 
 	void* allocMem(size_t size) {
 		assert(size <= page_size());
-		uint8_t* m = nullptr;
 
 		size_t i = 0;
 
@@ -31,10 +44,15 @@ public:
 			i = spring::VectorBackPop(indcs);
 		}
 
-		m = pages[curr_page_index = i].data();
+		Page& page = pages[curr_page_index = i];
+
+		page.index = i;
+		page.size = std::max(size, size_t(1));
+
+		live_page_count += 1;
+		peak_page_count = std::max(peak_page_count, live_page_count);
 
-		table.emplace(m, i);
-		return m;
+		return page.data;
 	}
 
 
@@ -47,13 +65,18 @@ public:
 	void freeMem(void* m) {
 		assert(mapped(m));
 
-		const auto iter = table.find(m);
-		const auto pair = std::pair<void*, size_t>{iter->first, iter->second};
+		Page* page = GetPage(m);
 
-		std::memset(pages[pair.second].data(), 0, page_size());
+		#if (SIMOBJECT_MEMPOOL_WIPE_FREED == 1)
+		std::memset(page->data, 0, page_size());
+		#else
+		std::memset(page->data, 0, page->size);
+		#endif
 
-		indcs.push_back(pair.second);
-		table.erase(pair.first);
+		page->size = 0;
+		live_page_count -= 1;
+
+		indcs.push_back(page->index);
 	}
 
 
@@ -74,29 +97,49 @@ public:
 	size_t alloc_size() const { return (pages.size() * page_size()); } // size of total number of pages added over the pool's lifetime
 	size_t freed_size() const { return (indcs.size() * page_size()); } // size of number of pages that were freed and are awaiting reuse
 
-	bool mapped(void* p) const { return (table.find(p) != table.end()); }
-	bool alloced(void* p) const { return ((curr_page_index < pages.size()) && (&pages[curr_page_index][0] == p)); }
+	size_t live_count() const { return live_page_count; } // number of pages currently holding an object
+	size_t peak_count() const { return peak_page_count; } // highest live_count over the pool's lifetime
+	// fraction of added pages that are free, i.e. held by the pool but unused
+	float frag_ratio() const { return (freed_size() / std::max(1.0f, alloc_size() * 1.0f)); }
+
+	bool mapped(void* p) const {
+		const Page* page = GetPage(p);
+		return ((page->index < pages.size()) && (&pages[page->index] == page) && (page->size != 0));
+	}
+	bool alloced(void* p) const { return ((curr_page_index < pages.size()) && (pages[curr_page_index].data == p)); }
 
 	void clear() {
 		pages.clear();
 		indcs.clear();
-		table.clear();
 
 		curr_page_index = 0;
+		live_page_count = 0;
+		peak_page_count = 0;
 	}
 	void reserve(size_t n) {
 		indcs.reserve(n);
-		table.reserve(n);
 	}
 
 private:
-	std::deque<std::array<uint8_t,S>> pages;
-	std::vector<size_t> indcs;
+	// index and (while in use) requested size are stored in-band, in front
+	// of the object, so freeMem needs no lookup
+	struct Page {
+		uint32_t index;
+		uint32_t size;
 
-	// <pointer, page index> (non-intrusive)
-	spring::unsynced_map<void*, size_t> table;
+		uint8_t data[S];
+	};
+
+	static Page* GetPage(void* p) { return (reinterpret_cast<Page*>(reinterpret_cast<uint8_t*>(p) - offsetof(Page, data))); }
+	static const Page* GetPage(const void* p) { return (reinterpret_cast<const Page*>(reinterpret_cast<const uint8_t*>(p) - offsetof(Page, data))); }
+
+private:
+	std::deque<Page> pages;
+	std::vector<size_t> indcs;
 
 	size_t curr_page_index = 0;
+	size_t live_page_count = 0;
+	size_t peak_page_count = 0;
 };
 
 
@@ -120,6 +163,9 @@ public:
 			i = indcs[--free_page_count];
 		}
 
+		sizes[i] = size;
+		peak_page_count = std::max(peak_page_count, used_page_count - free_page_count);
+
 		return (pages[curr_page_index = i].data());
 	}
 
@@ -133,10 +179,17 @@ public:
 		assert(can_free());
 		assert(mapped(m));
 
+		// the index follows from the address
+		const size_t i = base_offset(m) / page_size();
+
+		#if (SIMOBJECT_MEMPOOL_WIPE_FREED == 1)
 		std::memset(m, 0, page_size());
+		#else
+		std::memset(m, 0, sizes[i]);
+		#endif
 
 		// mark page as free
-		indcs[free_page_count++] = base_offset(m) / page_size();
+		indcs[free_page_count++] = i;
 	}
 
 
@@ -158,6 +211,11 @@ public:
 	size_t total_size() const { return (num_pages() * page_size()); }
 	size_t base_offset(const void* p) const { return (reinterpret_cast<const uint8_t*>(p) - reinterpret_cast<const uint8_t*>(&pages[0][0])); }
 
+	size_t live_count() const { return (used_page_count - free_page_count); } // number of pages currently holding an object
+	size_t peak_count() const { return peak_page_count; } // highest live_count over the pool's lifetime
+	// fraction of added pages that are free, i.e. held by the pool but unused
+	float frag_ratio() const { return (freed_size() / std::max(1.0f, alloc_size() * 1.0f)); }
+
 	bool mapped(const void* p) const { return (((base_offset(p) / page_size()) < total_size()) && ((base_offset(p) % page_size()) == 0)); }
 	bool alloced(const void* p) const { return (&pages[curr_page_index][0] == p); }
 
@@ -172,15 +230,19 @@ public:
 		used_page_count = 0;
 		free_page_count = 0;
 		curr_page_index = 0;
+		peak_page_count = 0;
 	}
 
 private:
 	std::array<std::array<uint8_t, S>, N> pages;
 	std::array<size_t, N> indcs;
+	// size requested for each page by its current (or last) object
+	std::array<uint32_t, N> sizes;
 
 	size_t used_page_count = 0;
 	size_t free_page_count = 0; // indcs[fpc-1] is the last recycled page
 	size_t curr_page_index = 0;
+	size_t peak_page_count = 0;
 };
 
 #endif
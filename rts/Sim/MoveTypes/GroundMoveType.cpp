@@ -1803,7 +1803,7 @@ void CGroundMoveType::HandleUnitCollisions(
 
 	// copy on purpose, since the below can call Lua
 	QuadFieldQuery qfQuery;
-	quadField.GetUnitsExact(qfQuery, collider->pos, searchRadius);
+	quadField.GetCollidersExact(qfQuery, collider->pos, searchRadius);
 
 	// NOTE: probably too large for most units (eg. causes tree falling animations to be skipped)
 	const int dirSign = Sign(int(!reversing));
@@ -2009,6 +2009,7 @@ void CGroundMoveType::HandleUnitCollisions(
 		if ((pushCollidee || !pushCollider) && collideeMobile) {
 			if (collideeMD->TestMoveSquare(collidee, collidee->pos + collideeMoveVec, collideeMoveVec)) {
 				collidee->Move(collideeMoveVec, true);
+				quadField.MovedCollider(collidee);
 			}
 		}
 	}
@@ -177,6 +177,7 @@ void CSolidObject::UpdatePhysicalState(float eps)
 	#undef MASK_NOAIR
 
 	physicalState = static_cast<PhysicalState>(ps);
+	StoreHotState();
 
 	// verify mutex relations (A != B); if one
 	// fails then A and B *must* both be false
@@ -114,6 +114,10 @@ public:
 
 	virtual void UpdatePhysicalState(float eps);
 
+	// mirrors the per-frame state read by hot loops into CUnitHotState;
+	// called by every accessor below that changes any part of it
+	virtual void StoreHotState() {}
+
 	void SlowUpdateLocalModel() { localModel.UpdateBoundingVolume(); }
 	void     UpdateLocalModel() { localModel.UpdatePieceMatrices(); }
 
@@ -123,6 +127,8 @@ public:
 		pos += dv;
 		midPos += dv;
 		aimPos += dv;
+
+		StoreHotState();
 	}
 
 	// this should be called whenever the direction
@@ -250,8 +256,8 @@ public:
 	bool IsBlocking() const { return (HasPhysicalStateBit(PSTATE_BIT_BLOCKING)); }
 
 	bool    HasPhysicalStateBit(unsigned int bit) const { return ((physicalState & bit) != 0); }
-	void    SetPhysicalStateBit(unsigned int bit) { unsigned int ps = physicalState; ps |= ( bit); physicalState = static_cast<PhysicalState>(ps); }
-	void  ClearPhysicalStateBit(unsigned int bit) { unsigned int ps = physicalState; ps &= (~bit); physicalState = static_cast<PhysicalState>(ps); }
+	void    SetPhysicalStateBit(unsigned int bit) { unsigned int ps = physicalState; ps |= ( bit); physicalState = static_cast<PhysicalState>(ps); StoreHotState(); }
+	void  ClearPhysicalStateBit(unsigned int bit) { unsigned int ps = physicalState; ps &= (~bit); physicalState = static_cast<PhysicalState>(ps); StoreHotState(); }
 	void   PushPhysicalStateBit(unsigned int bit) { UpdatePhysicalStateBit(1u << (32u - bits_ffs(bit)), HasPhysicalStateBit(bit)); }
 	void    PopPhysicalStateBit(unsigned int bit) { UpdatePhysicalStateBit(bit, HasPhysicalStateBit(1u << (32u - bits_ffs(bit)))); }
 	bool UpdatePhysicalStateBit(unsigned int bit, bool set) {
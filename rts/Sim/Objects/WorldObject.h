@@ -47,9 +47,9 @@ public:
 
 	// by default, SetVelocity does not set magnitude (for efficiency)
 	// so SetSpeed must be explicitly called to update the w-component
-	float SetSpeed(const float3& v) { return (speed.w = v.Length()); }
+	virtual float SetSpeed(const float3& v) { return (speed.w = v.Length()); }
 
-	void SetRadiusAndHeight(float r, float h) {
+	virtual void SetRadiusAndHeight(float r, float h) {
 		radius = r;
 		height = h;
 		sqRadius = r * r;
@@ -3,6 +3,7 @@
 #include "IPathFinder.h"
 #include "PathFinderDef.h"
 #include "PathLog.h"
+#include "Sim/Misc/ModInfo.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
 #include "System/Log/ILog.h"
 
@@ -21,8 +22,10 @@ IPathFinder::IPathFinder(unsigned int _BLOCK_SIZE)
 	, maxBlocksToBeSearched(0)
 	, testedBlocks(0)
 	, instanceIndex(pathFinderInstances.size())
+	, sharedStates(&blockStates)
 {
 	pathFinderInstances.push_back(this);
+	openBlocks.SetRadixQueue(modInfo.pfRadixQueue);
 
 	AllocStateBuffer();
 	ResetSearch();
@@ -111,7 +114,7 @@ IPath::SearchResult IPathFinder::GetPath(
 	// if search was successful, generate new path and cache it
 	if (result == IPath::Ok || result == IPath::GoalOutOfRange) {
 		FinishSearch(moveDef, pfDef, path);
-		AddCache(&path, result, mStartBlock, goalBlock, pfDef.sqGoalRadius, moveDef.pathType, pfDef.synced);
+		AddCache(&path, result, mStartBlock, goalBlock, pfDef.sqGoalRadius, moveDef.pathType, testedBlocks, pfDef.synced);
 
 		if (LOG_IS_ENABLED(L_DEBUG)) {
 			LOG_L(L_DEBUG, "==== %s: Search completed ====", (BLOCK_SIZE != 1) ? "PE" : "PF");
@@ -140,7 +143,7 @@ IPath::SearchResult IPathFinder::InitSearch(const MoveDef& moveDef, const CPathF
 	int2 square = mStartBlock;
 
 	if (BLOCK_SIZE != 1)
-		square = blockStates.peNodeOffsets[moveDef.pathType][mStartBlockIdx];
+		square = sharedStates->peNodeOffsets[moveDef.pathType][mStartBlockIdx];
 
 	const bool isStartGoal = pfDef.IsGoal(square.x, square.y);
 	const bool startInGoal = pfDef.startInGoalRadius;
@@ -119,6 +119,7 @@ protected:
 		const int2 goalBlock,
 		float goalRadius,
 		int pathType,
+		unsigned int searchCost,
 		const bool synced
 	) = 0;
 
@@ -143,7 +144,12 @@ public:
 
 	PathNodeBuffer openBlockBuffer;
 	PathNodeStateBuffer blockStates;
-	PathPriorityQueue openBlocks;
+	PathOpenQueue openBlocks;
+
+	// node extra-costs and PE node-offsets read by searches; points to
+	// blockStates except for the per-thread search instances, which use
+	// those of the instance they were created for
+	const PathNodeStateBuffer* sharedStates;
 
 	// list of blocks changed in last search
 	std::vector<unsigned int> dirtyBlocks;
@@ -1,6 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include <algorithm>
+#include <cassert>
 
 #include "PathCache.h"
 #include "Sim/Misc/GlobalConstants.h"
@@ -19,10 +20,17 @@ CPathCache::CPathCache(int blocksX, int blocksZ)
 	, maxCacheSize(0)
 	, numCacheHits(0)
 	, numCacheMisses(0)
+	, numCacheEvictions(0)
 	, numHashCollisions(0)
+
+	, curFrameHits{0}
+	, curFrameMisses{0}
+	, curFrameEvictions(0)
+	, curFrameExpirations(0)
 {
-	// {result, path, strtBlock, goalBlock, goalRadius, pathType}
-	dummyCacheItem = {IPath::Error, {}, {-1, -1}, {-1, -1}, -1.0f, -1};
+	// {result, path, strtBlock, goalBlock, goalRadius, pathType, searchCost}
+	dummyCacheItem = {IPath::Error, {}, {-1, -1}, {-1, -1}, -1.0f, -1, 0};
+	frameStats = {0, 0, 0, 0, 0};
 
 	cachedPaths.reserve(4096);
 }
@@ -31,12 +39,12 @@ CPathCache::~CPathCache()
 {
 	const char* fmt =
 #ifdef _WIN32
-		"[%s(%ux%u)] cacheHits=%u hitPercentage=%.0f%% numHashColls=%u maxCacheSize=%I64u";
+		"[%s(%ux%u)] cacheHits=%u hitPercentage=%.0f%% numEvictions=%u numHashColls=%u maxCacheSize=%I64u";
 #else
-		"[%s(%ux%u)] cacheHits=%u hitPercentage=%.0f%% numHashColls=%u maxCacheSize=%lu";
+		"[%s(%ux%u)] cacheHits=%u hitPercentage=%.0f%% numEvictions=%u numHashColls=%u maxCacheSize=%lu";
 #endif
 
-	LOG(fmt, __FUNCTION__, numBlocksX, numBlocksZ, numCacheHits, GetCacheHitPercentage(), numHashCollisions, maxCacheSize);
+	LOG(fmt, __FUNCTION__, numBlocksX, numBlocksZ, numCacheHits, GetCacheHitPercentage(), numCacheEvictions, numHashCollisions, maxCacheSize);
 }
 
 bool CPathCache::AddPath(
@@ -45,25 +53,26 @@ bool CPathCache::AddPath(
 	const int2 strtBlock,
 	const int2 goalBlock,
 	float goalRadius,
-	int pathType
+	int pathType,
+	unsigned int searchCost
 ) {
-	if (cacheQue.size() > MAX_CACHE_QUEUE_SIZE)
-		RemoveFrontQueItem();
-
 	const std::uint64_t hash = GetHash(strtBlock, goalBlock, goalRadius, pathType);
 	const std::uint32_t cols = numHashCollisions;
 	const auto iter = cachedPaths.find(hash);
 
 	// register any hash collisions
 	if (iter != cachedPaths.end())
-		return ((numHashCollisions += HashCollision(iter->second, strtBlock, goalBlock, goalRadius, pathType)) != cols);
+		return ((numHashCollisions += HashCollision((iter->second).item, strtBlock, goalBlock, goalRadius, pathType)) != cols);
 
-	cachedPaths[hash] = CacheItem{result, *path, strtBlock, goalBlock, goalRadius, pathType};
+	if (cachedPaths.size() >= MAX_CACHE_QUEUE_SIZE)
+		EvictCachedPath();
 
 	const int lifeTime = (result == IPath::Ok) ? GAME_SPEED * MAX_PATH_LIFETIME_SECS : GAME_SPEED * (MAX_PATH_LIFETIME_SECS / 2);
 
+	cachedPaths[hash] = CachedPath{CacheItem{result, *path, strtBlock, goalBlock, goalRadius, pathType, searchCost}, gs->frameNum + lifeTime, 0};
+
 	cacheQue.push_back({gs->frameNum + lifeTime, hash});
-	maxCacheSize = std::max<std::uint64_t>(maxCacheSize, cacheQue.size());
+	maxCacheSize = std::max<std::uint64_t>(maxCacheSize, cachedPaths.size());
 	return false;
 }
 
@@ -73,41 +82,143 @@ const CPathCache::CacheItem& CPathCache::GetCachedPath(
 	float goalRadius,
 	int pathType
 ) {
+	const CachedPath* cp = FindCachedPathIter(strtBlock, goalBlock, goalRadius, pathType);
+
+	if (cp == nullptr)
+		return dummyCacheItem;
+
+	cp->numHits += 1;
+	return (cp->item);
+}
+
+const CPathCache::CacheItem& CPathCache::FindCachedPath(
+	const int2 strtBlock,
+	const int2 goalBlock,
+	float goalRadius,
+	int pathType
+) const {
+	const CachedPath* cp = FindCachedPathIter(strtBlock, goalBlock, goalRadius, pathType);
+
+	if (cp == nullptr)
+		return dummyCacheItem;
+
+	return (cp->item);
+}
+
+void CPathCache::AddHit(const CacheKey& key)
+{
+	const auto iter = cachedPaths.find(GetHash(key.strtBlock, key.goalBlock, key.goalRadius, key.pathType));
+
+	if (iter == cachedPaths.end())
+		return;
+
+	const CacheItem& ci = (iter->second).item;
+
+	if (ci.strtBlock != key.strtBlock || ci.goalBlock != key.goalBlock || ci.pathType != key.pathType)
+		return;
+
+	(iter->second).numHits += 1;
+}
+
+const CPathCache::CachedPath* CPathCache::FindCachedPathIter(
+	const int2 strtBlock,
+	const int2 goalBlock,
+	float goalRadius,
+	int pathType
+) const {
 	const std::uint64_t hash = GetHash(strtBlock, goalBlock, goalRadius, pathType);
 	const auto iter = cachedPaths.find(hash);
 
-	if (iter == cachedPaths.end()) {
-		++numCacheMisses; return dummyCacheItem;
-	}
-	if ((iter->second).strtBlock != strtBlock) {
-		++numCacheMisses; return dummyCacheItem;
-	}
-	if ((iter->second).goalBlock != goalBlock) {
-		++numCacheMisses; return dummyCacheItem;
-	}
-	if ((iter->second).pathType != pathType) {
-		++numCacheMisses; return dummyCacheItem;
-	}
+	const bool miss =
+		(iter == cachedPaths.end()) ||
+		((iter->second).item.strtBlock != strtBlock) ||
+		((iter->second).item.goalBlock != goalBlock) ||
+		((iter->second).item.pathType != pathType);
 
-	++numCacheHits;
-	return (iter->second);
+	curFrameHits.fetch_add(!miss, std::memory_order_relaxed);
+	curFrameMisses.fetch_add(miss, std::memory_order_relaxed);
+
+	if (miss)
+		return nullptr;
+
+	return &(iter->second);
 }
 
 void CPathCache::Update()
 {
 	while (!cacheQue.empty() && (cacheQue.front().timeout) < gs->frameNum)
 		RemoveFrontQueItem();
+
+	// called once per frame, publish and reset the counters
+	frameStats.numHits = curFrameHits.exchange(0);
+	frameStats.numMisses = curFrameMisses.exchange(0);
+	frameStats.numEvictions = curFrameEvictions;
+	frameStats.numExpirations = curFrameExpirations;
+	frameStats.numCachedPaths = cachedPaths.size();
+
+	numCacheHits += frameStats.numHits;
+	numCacheMisses += frameStats.numMisses;
+
+	curFrameEvictions = 0;
+	curFrameExpirations = 0;
 }
 
 void CPathCache::RemoveFrontQueItem()
 {
-	const auto it = cachedPaths.find((cacheQue.front()).hash);
+	const CacheQueItem& cqi = cacheQue.front();
+	const auto it = cachedPaths.find(cqi.hash);
+
+	// skip items whose path was evicted (and possibly re-added) since
+	if (it != cachedPaths.end() && (it->second).timeout == cqi.timeout) {
+		cachedPaths.erase(it);
+		curFrameExpirations += 1;
+	}
 
-	assert(it != cachedPaths.end());
-	cachedPaths.erase(it);
 	cacheQue.pop_front();
 }
 
+void CPathCache::EvictCachedPath()
+{
+	// drop the path that is cheapest to recompute, weighted by how often it
+	// was reused; ties go to the oldest path (and the smallest hash, so the
+	// choice does not depend on the map's iteration order which matters for
+	// the synced cache)
+	const auto Value = [](const CachedPath& cp) { return (std::uint64_t(cp.item.searchCost) * (cp.numHits + 1)); };
+
+	auto evictIter = cachedPaths.end();
+
+	for (auto iter = cachedPaths.begin(); iter != cachedPaths.end(); ++iter) {
+		if (evictIter == cachedPaths.end()) {
+			evictIter = iter;
+			continue;
+		}
+
+		const CachedPath& cp = iter->second;
+		const CachedPath& ep = evictIter->second;
+
+		if (Value(cp) != Value(ep)) {
+			if (Value(cp) < Value(ep))
+				evictIter = iter;
+
+			continue;
+		}
+		if (cp.timeout != ep.timeout) {
+			if (cp.timeout < ep.timeout)
+				evictIter = iter;
+
+			continue;
+		}
+		if (iter->first < evictIter->first)
+			evictIter = iter;
+	}
+
+	assert(evictIter != cachedPaths.end());
+	cachedPaths.erase(evictIter);
+
+	numCacheEvictions += 1;
+	curFrameEvictions += 1;
+}
+
 std::uint64_t CPathCache::GetHash(
 	const int2 strtBlk,
 	const int2 goalBlk,
@@ -3,6 +3,7 @@
 #ifndef PATHCACHE_H
 #define PATHCACHE_H
 
+#include <atomic>
 #include <deque>
 
 #include "IPath.h"
@@ -22,6 +23,26 @@ public:
 		int2 goalBlock;
 		float goalRadius;
 		int pathType;
+		/// number of nodes the search expanded, i.e. the cost of a miss
+		unsigned int searchCost;
+	};
+
+	/// identifies a cached path, see FindCachedPath and AddHit
+	struct CacheKey {
+		int2 strtBlock;
+		int2 goalBlock;
+		float goalRadius;
+		int pathType;
+	};
+
+	struct CacheStats {
+		std::uint32_t numHits;
+		std::uint32_t numMisses;
+		/// paths dropped to make room for new ones
+		std::uint32_t numEvictions;
+		/// paths dropped because their lifetime ran out
+		std::uint32_t numExpirations;
+		std::uint32_t numCachedPaths;
 	};
 
 	void Update();
@@ -31,7 +52,8 @@ public:
 		const int2 strtBlock,
 		const int2 goalBlock,
 		float goalRadius,
-		int pathType
+		int pathType,
+		unsigned int searchCost
 	);
 
 	const CacheItem& GetCachedPath(
@@ -41,8 +63,41 @@ public:
 		int pathType
 	);
 
+	/// same as GetCachedPath, but does not update the item's hit-count; may
+	/// be called concurrently (from searches running in parallel) as long as
+	/// the cache is not modified
+	const CacheItem& FindCachedPath(
+		const int2 strtBlock,
+		const int2 goalBlock,
+		float goalRadius,
+		int pathType
+	) const;
+
+	/// adds a hit returned earlier by FindCachedPath to the item's hit-count
+	/// (if it is still cached); the frame statistics already include it
+	void AddHit(const CacheKey& key);
+
+	/// statistics of the last completed frame
+	const CacheStats& GetFrameStats() const { return frameStats; }
+
 private:
+	struct CachedPath {
+		CacheItem item;
+
+		std::int32_t timeout;
+		// only modified by GetCachedPath and AddHit, i.e. on the sim-thread
+		mutable std::uint32_t numHits;
+	};
+
 	void RemoveFrontQueItem();
+	void EvictCachedPath();
+
+	const CachedPath* FindCachedPathIter(
+		const int2 strtBlock,
+		const int2 goalBlock,
+		float goalRadius,
+		int pathType
+	) const;
 
 	std::uint64_t GetHash(
 		const int2 strtBlk,
@@ -75,8 +130,9 @@ private:
 	// returned on any cache-miss
 	CacheItem dummyCacheItem;
 
+	// ordered by timeout; may still reference paths that were evicted
 	std::deque<CacheQueItem> cacheQue;
-	spring::unordered_map<std::uint64_t, CacheItem> cachedPaths; // ints are sync-safe keys
+	spring::unordered_map<std::uint64_t, CachedPath> cachedPaths; // ints are sync-safe keys
 
 	std::uint32_t numBlocksX;
 	std::uint32_t numBlocksZ;
@@ -85,7 +141,16 @@ private:
 	std::uint64_t maxCacheSize;
 	std::uint32_t numCacheHits;
 	std::uint32_t numCacheMisses;
+	std::uint32_t numCacheEvictions;
 	std::uint32_t numHashCollisions;
+
+	// lookups of the current frame, counted atomically for FindCachedPath
+	mutable std::atomic<std::uint32_t> curFrameHits;
+	mutable std::atomic<std::uint32_t> curFrameMisses;
+	std::uint32_t curFrameEvictions;
+	std::uint32_t curFrameExpirations;
+
+	CacheStats frameStats;
 };
 
 #endif
@@ -3,12 +3,17 @@
 #ifndef PATH_DATATYPES_H
 #define PATH_DATATYPES_H
 
+#include <array>
 #include <queue>
 #include <vector>
 #include <algorithm> // for std::fill
+#include <cassert>
+#include <cstring>
 
-#include "PathConstants.h"
 #include "System/type2.h"
+#include "PathConstants.h"
+#include "System/bitops.h"
+#include "System/float3.h"
 #include <cinttypes>
 
 /// represents either a single square (PF) or a block of squares (PE)
@@ -327,4 +332,139 @@ public:
 	void Clear() { c.clear(); }
 };
 
+
+/**
+ * Monotone radix heap keyed on the nodes' f-costs. Pops in the same order
+ * as PathPriorityQueue (lowest f-cost first, highest g-cost among equal
+ * f-costs); only nodes tied on both costs can come out differently.
+ *
+ * Bucket i > 0 holds the nodes whose key first differs from the most
+ * recently extracted minimum in bit i-1; bucket 0 holds those equal to it
+ * and is kept as a binary heap. Nodes cheaper than that minimum (possible
+ * with inconsistent heuristics) are clamped into bucket 0, where they are
+ * still ordered by their real costs, so the next pop is always the global
+ * minimum.
+ */
+class PathRadixQueue {
+public:
+	void Clear() {
+		for (std::vector<PathNode*>& bucket: buckets) {
+			bucket.clear();
+		}
+
+		lastKey = 0;
+		numNodes = 0;
+	}
+
+	bool empty() const { return (numNodes == 0); }
+	size_t size() const { return numNodes; }
+
+	const PathNode* top() {
+		Refill();
+		return buckets[0].front();
+	}
+
+	void push(PathNode* n) {
+		const std::uint32_t key = GetKey(n->fCost);
+
+		numNodes += 1;
+
+		if (key <= lastKey) {
+			buckets[0].push_back(n);
+			std::push_heap(buckets[0].begin(), buckets[0].end(), lessCost());
+			return;
+		}
+
+		buckets[GetBucket(key)].push_back(n);
+	}
+
+	void pop() {
+		Refill();
+
+		std::pop_heap(buckets[0].begin(), buckets[0].end(), lessCost());
+		buckets[0].pop_back();
+
+		numNodes -= 1;
+	}
+
+private:
+	// maps a float onto an unsigned integer with the same ordering
+	static std::uint32_t GetKey(float cost) {
+		std::uint32_t bits;
+		std::memcpy(&bits, &cost, sizeof(bits));
+		return (bits ^ (((bits >> 31) != 0)? 0xFFFFFFFFu: 0x80000000u));
+	}
+
+	unsigned int GetBucket(std::uint32_t key) const { return (count_significant_bits(key ^ lastKey)); }
+
+	void Refill() {
+		assert(!empty());
+
+		if (!buckets[0].empty())
+			return;
+
+		unsigned int idx = 1;
+
+		while (buckets[idx].empty())
+			idx++;
+
+		std::vector<PathNode*>& bucket = buckets[idx];
+
+		// every key in the lowest non-empty bucket differs from its minimum
+		// in fewer bits than <idx>, so all of them move to lower buckets
+		lastKey = GetKey((*std::min_element(bucket.begin(), bucket.end(), [](const PathNode* a, const PathNode* b) { return (a->fCost < b->fCost); }))->fCost);
+
+		for (PathNode* n: bucket) {
+			buckets[GetBucket(GetKey(n->fCost))].push_back(n);
+		}
+
+		bucket.clear();
+		std::make_heap(buckets[0].begin(), buckets[0].end(), lessCost());
+	}
+
+private:
+	std::array<std::vector<PathNode*>, 33> buckets;
+
+	std::uint32_t lastKey = 0;
+	size_t numNodes = 0;
+};
+
+
+/// open-list of PF and PE searches, see CModInfo::pfRadixQueue
+class PathOpenQueue {
+public:
+	void SetRadixQueue(bool b) { assert(empty()); useRadixQueue = b; }
+
+	void Clear() {
+		heapQueue.Clear();
+		radixQueue.Clear();
+	}
+
+	bool empty() const { return (useRadixQueue? radixQueue.empty(): heapQueue.empty()); }
+
+	const PathNode* top() { return (useRadixQueue? radixQueue.top(): heapQueue.top()); }
+
+	void push(PathNode* n) {
+		if (useRadixQueue) {
+			radixQueue.push(n);
+		} else {
+			heapQueue.push(n);
+		}
+	}
+
+	void pop() {
+		if (useRadixQueue) {
+			radixQueue.pop();
+		} else {
+			heapQueue.pop();
+		}
+	}
+
+private:
+	PathPriorityQueue heapQueue;
+	PathRadixQueue radixQueue;
+
+	bool useRadixQueue = false;
+};
+
 #endif // PATH_DATATYPES_H
@@ -31,6 +31,9 @@
 #include "System/Sync/HsiehHash.h"
 #include "System/Sync/SHA512.hpp"
 
+#include <functional>
+#include <queue>
+
 #define ENABLE_NETLOG_CHECKSUM 1
 
 
@@ -40,10 +43,18 @@ PCMemPool pcMemPool;
 PEMemPool peMemPool;
 
 
+// radius (in blocks) of the areas updated first by CPathEstimator::Update
+static constexpr int PRIORITY_BLOCK_RADIUS = 2;
+
+
 static const std::string GetPathCacheDir() {
 	return (FileSystem::GetCacheDir() + "/paths/");
 }
 
+static const std::string GetCacheFileName(const std::string& mapName, const std::string& baseFileName, std::uint32_t hashCode, const char* ext) {
+	return (GetPathCacheDir() + mapName + "." + baseFileName + "-" + IntToString(hashCode, "%x") + ext);
+}
+
 static size_t GetNumThreads() {
 	const size_t numThreads = std::max(0, configHandler->GetInt("PathingThreadCount"));
 	const size_t numCores = Threading::GetLogicalCpuCores();
@@ -63,9 +74,12 @@ CPathEstimator::CPathEstimator(IPathFinder* pf, unsigned int BLOCK_SIZE, const s
 	, costBlockNum(nbrOfBlocks.x * nbrOfBlocks.y)
 	, parentPathFinder(pf)
 	, nextPathEstimator(nullptr)
+	, sharedPE(this)
+	, vertexCosts(nullptr)
+	, numVertexCosts(moveDefHandler->GetNumMoveDefs() * blockStates.GetSize() * PATH_DIRECTION_VERTICES)
+	, numObsoleteBlocks(0)
 	, blockUpdatePenalty(0)
 {
-	vertexCosts.resize(moveDefHandler->GetNumMoveDefs() * blockStates.GetSize() * PATH_DIRECTION_VERTICES, PATHCOST_INFINITY);
 	maxSpeedMods.resize(moveDefHandler->GetNumMoveDefs(), 0.001f);
 
 	CPathEstimator*  childPE = this;
@@ -117,8 +131,32 @@ CPathEstimator::CPathEstimator(IPathFinder* pf, unsigned int BLOCK_SIZE, const s
 }
 
 
+CPathEstimator::CPathEstimator(const CPathEstimator* pe, IPathFinder* pf)
+	: IPathFinder(pe->BLOCK_SIZE)
+	, BLOCKS_TO_UPDATE(pe->BLOCKS_TO_UPDATE)
+	, nextOffsetMessageIdx(0)
+	, nextCostMessageIdx(0)
+	, pathChecksum(pe->pathChecksum)
+	, fileHashCode(pe->fileHashCode)
+	, offsetBlockNum(0)
+	, costBlockNum(0)
+	, parentPathFinder(pf)
+	, nextPathEstimator(nullptr)
+	, pathCache{nullptr, nullptr}
+	, sharedPE(pe)
+	, vertexCosts(nullptr)
+	, numVertexCosts(0)
+	, numObsoleteBlocks(0)
+	, blockUpdatePenalty(0)
+{
+	sharedStates = &pe->blockStates;
+}
+
 CPathEstimator::~CPathEstimator()
 {
+	if (sharedPE != this)
+		return;
+
 	pcMemPool.free(pathCache[0]);
 	pcMemPool.free(pathCache[1]);
 }
@@ -133,19 +171,21 @@ void CPathEstimator::InitEstimator(const std::string& cacheFileName, const std::
 		pathFinders.resize(numThreads);
 	}
 
-	// always use PF for initialization, later PE maybe used
-	pathFinders[0] = pfMemPool.alloc<CPathFinder>();
-
 	// Not much point in multithreading these...
 	InitBlocks();
 
-	if (!ReadFile(cacheFileName, mapName)) {
-		// start extra threads if applicable, but always keep the total
-		// memory-footprint made by CPathFinder instances within bounds
-		const unsigned int minMemFootPrint = sizeof(CPathFinder) + parentPathFinder->GetMemFootPrint();
-		const unsigned int maxMemFootPrint = configHandler->GetInt("MaxPathCostsMemoryFootPrint") * 1024 * 1024;
-		const unsigned int numExtraThreads = Clamp(int(maxMemFootPrint / minMemFootPrint) - 1, 0, int(numThreads) - 1);
-		const unsigned int reqMemFootPrint = minMemFootPrint * (numExtraThreads + 1);
+	// a valid flat file also provides pathChecksum (which it had to verify)
+	if (!ReadFlatFile(cacheFileName, mapName)) {
+		// always use PF for initialization, later PE maybe used
+		pathFinders[0] = pfMemPool.alloc<CPathFinder>();
+
+		vertexCostsBuffer.clear();
+		vertexCostsBuffer.resize(numVertexCosts, PATHCOST_INFINITY);
+		vertexCosts = vertexCostsBuffer.data();
+
+		// zip-files are only written if the flat file can not be, but older
+		// versions always wrote them
+		const bool readZipFile = ReadFile(cacheFileName, mapName);
 
 		char calcMsg[512];
 		const char* fmtStrs[4] = {
@@ -155,43 +195,64 @@ void CPathEstimator::InitEstimator(const std::string& cacheFileName, const std::
 			"[%s] written PE%u %s-cache to file",
 		};
 
-		{
-			sprintf(calcMsg, fmtStrs[numExtraThreads == 0], __func__, BLOCK_SIZE, numExtraThreads + 1, reqMemFootPrint / (1024 * 1024));
-			loadscreen->SetLoadMessage(calcMsg);
-		}
+		if (!readZipFile) {
+			// start extra threads if applicable, but always keep the total
+			// memory-footprint made by CPathFinder instances within bounds
+			const unsigned int minMemFootPrint = sizeof(CPathFinder) + parentPathFinder->GetMemFootPrint();
+			const unsigned int maxMemFootPrint = configHandler->GetInt("MaxPathCostsMemoryFootPrint") * 1024 * 1024;
+			const unsigned int numExtraThreads = Clamp(int(maxMemFootPrint / minMemFootPrint) - 1, 0, int(numThreads) - 1);
+			const unsigned int reqMemFootPrint = minMemFootPrint * (numExtraThreads + 1);
+
+			{
+				sprintf(calcMsg, fmtStrs[numExtraThreads == 0], __func__, BLOCK_SIZE, numExtraThreads + 1, reqMemFootPrint / (1024 * 1024));
+				loadscreen->SetLoadMessage(calcMsg);
+			}
 
 
-		// note: only really needed if numExtraThreads > 0
-		spring::barrier pathBarrier(numExtraThreads + 1);
+			// note: only really needed if numExtraThreads > 0
+			spring::barrier pathBarrier(numExtraThreads + 1);
 
-		for (unsigned int i = 1; i <= numExtraThreads; i++) {
-			pathFinders[i] = pfMemPool.alloc<CPathFinder>();
-			threads[i] = std::move(spring::thread(&CPathEstimator::CalcOffsetsAndPathCosts, this, i, &pathBarrier));
-		}
+			for (unsigned int i = 1; i <= numExtraThreads; i++) {
+				pathFinders[i] = pfMemPool.alloc<CPathFinder>();
+				threads[i] = std::move(spring::thread(&CPathEstimator::CalcOffsetsAndPathCosts, this, i, &pathBarrier));
+			}
 
-		// Use the current thread as thread zero
-		CalcOffsetsAndPathCosts(0, &pathBarrier);
+			// Use the current thread as thread zero
+			CalcOffsetsAndPathCosts(0, &pathBarrier);
 
-		for (unsigned int i = 1; i <= numExtraThreads; i++) {
-			threads[i].join();
-			pfMemPool.free(pathFinders[i]);
+			for (unsigned int i = 1; i <= numExtraThreads; i++) {
+				threads[i].join();
+				pfMemPool.free(pathFinders[i]);
+			}
 		}
 
+		// Calculate PreCached PathData Checksum
+		pathChecksum = CalcChecksum();
 
-		sprintf(calcMsg, fmtStrs[2], __func__, BLOCK_SIZE, cacheFileName.c_str());
-		loadscreen->SetLoadMessage(calcMsg, true);
+		// keep a single cache-file, preferably the flat one (also when
+		// converting a zip-file)
+		if (!readZipFile) {
+			sprintf(calcMsg, fmtStrs[2], __func__, BLOCK_SIZE, cacheFileName.c_str());
+			loadscreen->SetLoadMessage(calcMsg, true);
+		}
 
-		WriteFile(cacheFileName, mapName);
+		if (WriteFlatFile(cacheFileName, mapName)) {
+			if (readZipFile)
+				FileSystem::Remove(GetCacheFileName(mapName, cacheFileName, fileHashCode, ".zip"));
+		} else if (!readZipFile) {
+			WriteFile(cacheFileName, mapName);
+		}
 
-		sprintf(calcMsg, fmtStrs[3], __func__, BLOCK_SIZE, cacheFileName.c_str());
-		loadscreen->SetLoadMessage(calcMsg, true);
-	}
+		if (!readZipFile) {
+			sprintf(calcMsg, fmtStrs[3], __func__, BLOCK_SIZE, cacheFileName.c_str());
+			loadscreen->SetLoadMessage(calcMsg, true);
+		}
 
-	// Calculate PreCached PathData Checksum
-	pathChecksum = CalcChecksum();
+		pfMemPool.free(pathFinders[0]);
+	}
 
 	// switch to runtime wanted IPathFinder (maybe PF or PE)
-	pfMemPool.free(pathFinders[0]);
+	pathFinders.resize(1);
 	pathFinders[0] = parentPathFinder;
 
 	pathCache[0] = pcMemPool.alloc<CPathCache>(nbrOfBlocks.x, nbrOfBlocks.y);
@@ -445,13 +506,61 @@ void CPathEstimator::MapChanged(unsigned int x1, unsigned int z1, unsigned int x
 
 			updatedBlocks.emplace_back(x, z);
 			blockStates.nodeMask[idx] |= PATHOPT_OBSOLETE;
+
+			numObsoleteBlocks += 1;
 		}
 	}
 }
 
 
+int2 CPathEstimator::GetBlockPos(const float3& pos) const
+{
+	const int x = Clamp(int(pos.x / BLOCK_PIXEL_SIZE), 0, int(nbrOfBlocks.x - 1));
+	const int z = Clamp(int(pos.z / BLOCK_PIXEL_SIZE), 0, int(nbrOfBlocks.y - 1));
+
+	return {x, z};
+}
+
+void CPathEstimator::PrioritizeBlocks(const float3& pos)
+{
+	priorityBlocks.emplace_back(GetBlockPos(pos));
+}
+
+
+/**
+ * Queue the re-estimation of an obsolete block for all movedefs
+ */
+bool CPathEstimator::ConsumeBlock(const int2& blockPos)
+{
+	const int idx = BlockPosToIdx(blockPos);
+
+	if ((blockStates.nodeMask[idx] & PATHOPT_OBSOLETE) == 0)
+		return false;
+
+	// issue repathing for all active movedefs
+	for (unsigned int i = 0; i < moveDefHandler->GetNumMoveDefs(); i++) {
+		const MoveDef* md = moveDefHandler->GetMoveDefByPathType(i);
+
+		consumedBlocks.emplace_back(blockPos, md);
+	}
+
+	// inform dependent estimator that costs were updated and it should do the same
+	// FIXME?
+	//   adjacent med-res PE blocks will cause a low-res block to be updated twice
+	//   (in addition to the overlap that already exists because MapChanged() adds
+	//   boundary blocks)
+	if (true && nextPathEstimator != nullptr)
+		nextPathEstimator->MapChanged(blockPos.x * BLOCK_SIZE, blockPos.y * BLOCK_SIZE, blockPos.x * BLOCK_SIZE, blockPos.y * BLOCK_SIZE);
+
+	blockStates.nodeMask[idx] &= ~PATHOPT_OBSOLETE;
+	numObsoleteBlocks -= 1;
+	return true;
+}
+
+
 /**
- * Update some obsolete blocks using the FIFO-principle
+ * Update some obsolete blocks, those around prioritized positions first
+ * and then using the FIFO-principle
  */
 void CPathEstimator::Update()
 {
@@ -460,16 +569,18 @@ void CPathEstimator::Update()
 
 	const unsigned int numMoveDefs = moveDefHandler->GetNumMoveDefs();
 
-	if (numMoveDefs == 0)
+	if (numMoveDefs == 0) {
+		priorityBlocks.clear();
 		return;
+	}
 
 	// determine how many blocks we should update
 	int blocksToUpdate = 0;
 	int consumeBlocks = 0;
 	{
-		const int progressiveUpdates = updatedBlocks.size() * numMoveDefs * modInfo.pfUpdateRate;
+		const int progressiveUpdates = numObsoleteBlocks * numMoveDefs * modInfo.pfUpdateRate;
 		const int MIN_BLOCKS_TO_UPDATE = std::max<int>(BLOCKS_TO_UPDATE >> 1, 4U);
-		const int MAX_BLOCKS_TO_UPDATE = std::max<int>(BLOCKS_TO_UPDATE << 1, MIN_BLOCKS_TO_UPDATE);
+		const int MAX_BLOCKS_TO_UPDATE = std::max<int>((BLOCKS_TO_UPDATE << 1) * modInfo.pfUpdateRateMaxMult, MIN_BLOCKS_TO_UPDATE);
 
 		blocksToUpdate = Clamp(progressiveUpdates, MIN_BLOCKS_TO_UPDATE, MAX_BLOCKS_TO_UPDATE);
 		blockUpdatePenalty = std::max(0, blockUpdatePenalty - blocksToUpdate);
@@ -482,21 +593,36 @@ void CPathEstimator::Update()
 		blockUpdatePenalty += consumeBlocks;
 	}
 
-	if (blocksToUpdate == 0)
-		return;
-
-	if (updatedBlocks.empty())
+	if (blocksToUpdate == 0 || numObsoleteBlocks == 0) {
+		priorityBlocks.clear();
 		return;
+	}
 
 	consumedBlocks.clear();
 	consumedBlocks.reserve(consumeBlocks);
 
-	// get blocks to update
+	// get blocks to update; those near queued path-requests go first since
+	// these are searched right after (the prioritized positions are synced)
+	for (const int2& blockPos: priorityBlocks) {
+		const int minX = std::max(blockPos.x - PRIORITY_BLOCK_RADIUS, 0);
+		const int maxX = std::min(blockPos.x + PRIORITY_BLOCK_RADIUS, int(nbrOfBlocks.x - 1));
+		const int minZ = std::max(blockPos.y - PRIORITY_BLOCK_RADIUS, 0);
+		const int maxZ = std::min(blockPos.y + PRIORITY_BLOCK_RADIUS, int(nbrOfBlocks.y - 1));
+
+		for (int z = minZ; z <= maxZ && consumedBlocks.size() < blocksToUpdate; z++) {
+			for (int x = minX; x <= maxX && consumedBlocks.size() < blocksToUpdate; x++) {
+				ConsumeBlock(int2(x, z));
+			}
+		}
+	}
+
+	priorityBlocks.clear();
+
+	// consumed blocks are left in the queue and skipped here
 	while (!updatedBlocks.empty()) {
-		const int2& pos = updatedBlocks.front();
-		const int idx = BlockPosToIdx(pos);
+		const int2 blockPos = updatedBlocks.front();
 
-		if ((blockStates.nodeMask[idx] & PATHOPT_OBSOLETE) == 0) {
+		if ((blockStates.nodeMask[BlockPosToIdx(blockPos)] & PATHOPT_OBSOLETE) == 0) {
 			updatedBlocks.pop_front();
 			continue;
 		}
@@ -504,23 +630,8 @@ void CPathEstimator::Update()
 		if (consumedBlocks.size() >= blocksToUpdate)
 			break;
 
-		// issue repathing for all active movedefs
-		for (unsigned int i = 0; i < numMoveDefs; i++) {
-			const MoveDef* md = moveDefHandler->GetMoveDefByPathType(i);
-
-			consumedBlocks.emplace_back(pos, md);
-		}
-
-		// inform dependent estimator that costs were updated and it should do the same
-		// FIXME?
-		//   adjacent med-res PE blocks will cause a low-res block to be updated twice
-		//   (in addition to the overlap that already exists because MapChanged() adds
-		//   boundary blocks)
-		if (true && nextPathEstimator != nullptr)
-			nextPathEstimator->MapChanged(pos.x * BLOCK_SIZE, pos.y * BLOCK_SIZE, pos.x * BLOCK_SIZE, pos.y * BLOCK_SIZE);
-
-		updatedBlocks.pop_front(); // must happen _after_ last usage of the `pos` reference!
-		blockStates.nodeMask[idx] &= ~PATHOPT_OBSOLETE;
+		ConsumeBlock(blockPos);
+		updatedBlocks.pop_front();
 	}
 
 	// FindOffset (threadsafe)
@@ -535,11 +646,46 @@ void CPathEstimator::Update()
 		});
 	}
 
-	// CalcVertexPathCosts (not threadsafe)
+	// CalcVertexPathCosts; each block only writes its own vertices and the
+	// searches only read offsets and parent data (plus a snapshot of its
+	// cache), so the costs do not depend on which instance handles a block
 	{
 		SCOPED_TIMER("Sim::Path::Estimator::CalcVertexPathCosts");
+
+		CPathEstimator* parentPE = dynamic_cast<CPathEstimator*>(parentPathFinder);
+		std::atomic<unsigned int> nextBlockIdx(0);
+
+		if (consumedCacheItems.size() < consumedBlocks.size()) {
+			consumedCacheItems.resize(consumedBlocks.size());
+			consumedCacheHits.resize(consumedBlocks.size());
+		}
+
+		for_mt(0, pathFinders.size(), [&](const int i) {
+			for (unsigned int n = nextBlockIdx++; n < consumedBlocks.size(); n = nextBlockIdx++) {
+				CalcVertexPathCosts(*consumedBlocks[n].moveDef, consumedBlocks[n].blockPos, i);
+
+				if (parentPE == nullptr)
+					continue;
+
+				std::swap(consumedCacheItems[n], static_cast<CPathEstimator*>(pathFinders[i])->deferredCacheItems);
+				std::swap(consumedCacheHits[n], static_cast<CPathEstimator*>(pathFinders[i])->deferredCacheHits);
+			}
+		});
+
+		if (parentPE == nullptr)
+			return;
+
+		// add the hits and paths found by the parent's search instances in block order
 		for (unsigned int n = 0; n < consumedBlocks.size(); ++n) {
-			CalcVertexPathCosts(*consumedBlocks[n].moveDef, consumedBlocks[n].blockPos);
+			for (const CPathCache::CacheKey& ck: consumedCacheHits[n]) {
+				parentPE->AddCacheHit(ck, true);
+			}
+			for (const CPathCache::CacheItem& ci: consumedCacheItems[n]) {
+				parentPE->AddCache(&ci.path, ci.result, ci.strtBlock, ci.goalBlock, ci.goalRadius, ci.pathType, ci.searchCost, true);
+			}
+
+			consumedCacheHits[n].clear();
+			consumedCacheItems[n].clear();
 		}
 	}
 }
@@ -547,12 +693,38 @@ void CPathEstimator::Update()
 
 const CPathCache::CacheItem& CPathEstimator::GetCache(const int2 strtBlock, const int2 goalBlock, float goalRadius, int pathType, const bool synced) const
 {
+	// search-only instances run concurrently, cache must not be modified;
+	// hits are counted when the owner applies deferredCacheItems
+	if (sharedPE != this) {
+		const CPathCache::CacheItem& ci = sharedPE->pathCache[synced]->FindCachedPath(strtBlock, goalBlock, goalRadius, pathType);
+
+		if (ci.pathType != -1) {
+			assert(synced);
+			deferredCacheHits.push_back(CPathCache::CacheKey{strtBlock, goalBlock, goalRadius, pathType});
+		}
+
+		return ci;
+	}
+
 	return pathCache[synced]->GetCachedPath(strtBlock, goalBlock, goalRadius, pathType);
 }
 
-void CPathEstimator::AddCache(const IPath::Path* path, const IPath::SearchResult result, const int2 strtBlock, const int2 goalBlock, float goalRadius, int pathType, const bool synced)
+void CPathEstimator::AddCacheHit(const CPathCache::CacheKey& key, const bool synced)
 {
-	pathCache[synced]->AddPath(path, result, strtBlock, goalBlock, goalRadius, pathType);
+	assert(sharedPE == this);
+	pathCache[synced]->AddHit(key);
+}
+
+void CPathEstimator::AddCache(const IPath::Path* path, const IPath::SearchResult result, const int2 strtBlock, const int2 goalBlock, float goalRadius, int pathType, unsigned int searchCost, const bool synced)
+{
+	if (sharedPE != this) {
+		// only synced requests are searched by these, see CPathManager::RequestPath
+		assert(synced);
+		deferredCacheItems.push_back(CPathCache::CacheItem{result, *path, strtBlock, goalBlock, goalRadius, pathType, searchCost});
+		return;
+	}
+
+	pathCache[synced]->AddPath(path, result, strtBlock, goalBlock, goalRadius, pathType, searchCost);
 }
 
 
@@ -600,7 +772,7 @@ IPath::SearchResult CPathEstimator::DoSearch(const MoveDef& moveDef, const CPath
 
 	// get the goal square offset
 	const int2 goalSqrOffset = peDef.GoalSquareOffset(BLOCK_SIZE);
-	const float maxSpeedMod = maxSpeedMods[moveDef.pathType];
+	const float maxSpeedMod = sharedPE->maxSpeedMods[moveDef.pathType];
 
 	while (!openBlocks.empty() && (openBlockBuffer.GetSize() < maxBlocksToBeSearched)) {
 		// get the open block with lowest cost
@@ -612,7 +784,7 @@ IPath::SearchResult CPathEstimator::DoSearch(const MoveDef& moveDef, const CPath
 			continue;
 
 		// no, check if the goal is already reached
-		const int2 bSquare = blockStates.peNodeOffsets[moveDef.pathType][ob->nodeNum];
+		const int2 bSquare = sharedStates->peNodeOffsets[moveDef.pathType][ob->nodeNum];
 		const int2 gSquare = ob->nodePos * BLOCK_SIZE + goalSqrOffset;
 
 		bool runBlkSearch = false;
@@ -710,14 +882,14 @@ bool CPathEstimator::TestBlock(
 		openBlockIdx * PATH_DIRECTION_VERTICES +
 		GetBlockVertexOffset(pathDir, nbrOfBlocks.x);
 
-	assert(testBlockIdx < blockStates.peNodeOffsets[moveDef.pathType].size());
-	assert(vertexCostIdx < vertexCosts.size());
+	assert(testBlockIdx < sharedStates->peNodeOffsets[moveDef.pathType].size());
+	assert(vertexCostIdx < sharedPE->numVertexCosts);
 
 	// best accessible heightmap-coordinate within tested block
-	const int2 testBlockSquare = blockStates.peNodeOffsets[moveDef.pathType][testBlockIdx];
+	const int2 testBlockSquare = sharedStates->peNodeOffsets[moveDef.pathType][testBlockIdx];
 
 	// transition-cost from parent to tested child
-	float testVertexCost = vertexCosts[vertexCostIdx];
+	float testVertexCost = sharedPE->vertexCosts[vertexCostIdx];
 
 
 	// this means we can not get from the parent VERTEX to the child
@@ -798,7 +970,7 @@ bool CPathEstimator::TestBlock(
 	// maximum modifier value
 	//
 	// const float  flowCost = (peDef.testMobile) ? (PathFlowMap::GetInstance())->GetFlowCost(testBlockSquare.x, testBlockSquare.y, moveDef, PathDir2PathOpt(pathDir)) : 0.0f;
-	const float extraCost = blockStates.GetNodeExtraCost(testBlockSquare.x, testBlockSquare.y, peDef.synced);
+	const float extraCost = sharedStates->GetNodeExtraCost(testBlockSquare.x, testBlockSquare.y, peDef.synced);
 	const float  nodeCost = testVertexCost + extraCost;
 
 	const float gCost = parentOpenBlock->gCost + nodeCost;
@@ -881,7 +1053,7 @@ void CPathEstimator::FinishSearch(const MoveDef& moveDef, const CPathFinderDef&
 
 		while (true) {
 			// use offset defined by the block
-			const int2 square = blockStates.peNodeOffsets[moveDef.pathType][blockIdx];
+			const int2 square = sharedStates->peNodeOffsets[moveDef.pathType][blockIdx];
 
 			// foundPath.squares.push_back(square);
 			foundPath.path.emplace_back(square.x * SQUARE_SIZE, CMoveMath::yLevel(moveDef, square.x, square.y), square.y * SQUARE_SIZE);
@@ -904,13 +1076,210 @@ void CPathEstimator::FinishSearch(const MoveDef& moveDef, const CPathFinderDef&
 }
 
 
+/**
+ * Dijkstra over the block-graph from the goal-region outward; vertices are
+ * shared by both directions of a block-edge so the cost of moving from a
+ * neighbor into the current block can be read from the current block, and
+ * as in TestBlock the extra-cost of the entered block is added on top
+ */
+void CPathEstimator::CalcIntegrationField(
+	const MoveDef& moveDef,
+	const CPathFinderDef& peDef,
+	const std::vector<int2>& startBlocks,
+	IntegrationField& field
+) const {
+	typedef std::pair<float, unsigned int> FieldNode;
+
+	const unsigned int numBlocks = nbrOfBlocks.x * nbrOfBlocks.y;
+	const unsigned int vertexBaseIdx = moveDef.pathType * numBlocks * PATH_DIRECTION_VERTICES;
+
+	const std::vector<short2>& nodeOffsets = sharedStates->peNodeOffsets[moveDef.pathType];
+
+	// ties are broken by block-index, the field never depends on the thread building it
+	std::priority_queue<FieldNode, std::vector<FieldNode>, std::greater<FieldNode> > fieldQueue;
+
+	std::vector<bool> closedBlocks(numBlocks, false);
+	std::vector<bool> startBlockMask(numBlocks, false);
+
+	unsigned int numOpenStartBlocks = 0;
+
+	for (const int2 blockPos: startBlocks) {
+		const unsigned int blockIdx = BlockPosToIdx(blockPos);
+
+		numOpenStartBlocks += (!startBlockMask[blockIdx]);
+		startBlockMask[blockIdx] = true;
+	}
+
+	field.costs.clear();
+	field.costs.resize(numBlocks, PATHCOST_INFINITY);
+	field.pathType = moveDef.pathType;
+	field.synced = peDef.synced;
+
+	{
+		// seed with the goal-block and every block whose offset-square lies within the goal-radius
+		const int2 goalBlockPos = {int(peDef.goalSquareX / BLOCK_SIZE), int(peDef.goalSquareZ / BLOCK_SIZE)};
+		const int goalBlockRadius = math::sqrt(peDef.sqGoalRadius) / BLOCK_PIXEL_SIZE + 1;
+
+		for (int z = std::max(goalBlockPos.y - goalBlockRadius, 0); z <= std::min(goalBlockPos.y + goalBlockRadius, nbrOfBlocks.y - 1); z++) {
+			for (int x = std::max(goalBlockPos.x - goalBlockRadius, 0); x <= std::min(goalBlockPos.x + goalBlockRadius, nbrOfBlocks.x - 1); x++) {
+				const unsigned int blockIdx = BlockPosToIdx(int2(x, z));
+				const int2 blockSquare = nodeOffsets[blockIdx];
+
+				if (int2(x, z) != goalBlockPos && !peDef.IsGoal(blockSquare.x, blockSquare.y))
+					continue;
+
+				field.costs[blockIdx] = 0.0f;
+				fieldQueue.emplace(0.0f, blockIdx);
+			}
+		}
+	}
+
+	while (!fieldQueue.empty() && numOpenStartBlocks > 0) {
+		const unsigned int blockIdx = fieldQueue.top().second;
+
+		fieldQueue.pop();
+
+		// outdated entry
+		if (closedBlocks[blockIdx])
+			continue;
+
+		closedBlocks[blockIdx] = true;
+		numOpenStartBlocks -= startBlockMask[blockIdx];
+
+		const int2 blockPos = BlockIdxToPos(blockIdx);
+		const int2 blockSquare = nodeOffsets[blockIdx];
+
+		const float extraCost = sharedStates->GetNodeExtraCost(blockSquare.x, blockSquare.y, peDef.synced);
+
+		for (unsigned int pathDir = 0; pathDir < PATH_DIRECTIONS; pathDir++) {
+			const int2 ngbBlockPos = blockPos + PE_DIRECTION_VECTORS[pathDir];
+
+			if (static_cast<unsigned int>(ngbBlockPos.x) >= nbrOfBlocks.x)
+				continue;
+			if (static_cast<unsigned int>(ngbBlockPos.y) >= nbrOfBlocks.y)
+				continue;
+
+			const unsigned int ngbBlockIdx = BlockPosToIdx(ngbBlockPos);
+
+			if (closedBlocks[ngbBlockIdx])
+				continue;
+
+			const unsigned int vertexCostIdx =
+				vertexBaseIdx +
+				blockIdx * PATH_DIRECTION_VERTICES +
+				GetBlockVertexOffset(pathDir, nbrOfBlocks.x);
+
+			assert(vertexCostIdx < sharedPE->numVertexCosts);
+
+			const float vertexCost = sharedPE->vertexCosts[vertexCostIdx];
+
+			if (vertexCost >= PATHCOST_INFINITY)
+				continue;
+
+			// same expression as in GetIntegrationFieldPath, which relies on it
+			const float ngbCost = field.costs[blockIdx] + (vertexCost + extraCost);
+
+			if (ngbCost >= field.costs[ngbBlockIdx])
+				continue;
+
+			field.costs[ngbBlockIdx] = ngbCost;
+			fieldQueue.emplace(ngbCost, ngbBlockIdx);
+		}
+	}
+}
+
+bool CPathEstimator::GetIntegrationFieldPath(
+	const MoveDef& moveDef,
+	const IntegrationField& field,
+	const float3& startPos,
+	IPath::Path& path
+) const {
+	assert(field.pathType == moveDef.pathType);
+
+	const unsigned int numBlocks = nbrOfBlocks.x * nbrOfBlocks.y;
+	const unsigned int vertexBaseIdx = moveDef.pathType * numBlocks * PATH_DIRECTION_VERTICES;
+
+	const std::vector<short2>& nodeOffsets = sharedStates->peNodeOffsets[moveDef.pathType];
+
+	const int2 startBlockPos = GetBlockPos(startPos);
+
+	unsigned int blockIdx = BlockPosToIdx(startBlockPos);
+
+	path.path.clear();
+	path.squares.clear();
+	path.pathCost = field.costs[blockIdx];
+
+	// unreached, or already within the goal-region (left to a regular search)
+	if (path.pathCost >= PATHCOST_INFINITY || path.pathCost <= 0.0f)
+		return false;
+
+	// collected start-first, stored goal-first like FinishSearch does
+	std::vector<unsigned int> pathBlocks;
+	pathBlocks.reserve(64);
+	pathBlocks.push_back(blockIdx);
+
+	while (field.costs[blockIdx] > 0.0f) {
+		const int2 blockPos = BlockIdxToPos(blockIdx);
+
+		unsigned int nextBlockIdx = blockIdx;
+		float nextBlockCost = field.costs[blockIdx];
+
+		// step to the neighbor through which the field reached this block
+		for (unsigned int pathDir = 0; pathDir < PATH_DIRECTIONS; pathDir++) {
+			const int2 ngbBlockPos = blockPos + PE_DIRECTION_VECTORS[pathDir];
+
+			if (static_cast<unsigned int>(ngbBlockPos.x) >= nbrOfBlocks.x)
+				continue;
+			if (static_cast<unsigned int>(ngbBlockPos.y) >= nbrOfBlocks.y)
+				continue;
+
+			const unsigned int ngbBlockIdx = BlockPosToIdx(ngbBlockPos);
+
+			if (field.costs[ngbBlockIdx] >= nextBlockCost)
+				continue;
+
+			const float vertexCost = sharedPE->vertexCosts[vertexBaseIdx + blockIdx * PATH_DIRECTION_VERTICES + GetBlockVertexOffset(pathDir, nbrOfBlocks.x)];
+
+			if (vertexCost >= PATHCOST_INFINITY)
+				continue;
+
+			const int2 ngbBlockSquare = nodeOffsets[ngbBlockIdx];
+			const float extraCost = sharedStates->GetNodeExtraCost(ngbBlockSquare.x, ngbBlockSquare.y, field.synced);
+
+			if ((field.costs[ngbBlockIdx] + (vertexCost + extraCost)) > field.costs[blockIdx])
+				continue;
+
+			nextBlockIdx = ngbBlockIdx;
+			nextBlockCost = field.costs[ngbBlockIdx];
+		}
+
+		// costs strictly decrease along the way, so this can only trip on a broken field
+		if (nextBlockIdx == blockIdx || pathBlocks.size() >= numBlocks)
+			return false;
+
+		pathBlocks.push_back(blockIdx = nextBlockIdx);
+	}
+
+	path.path.reserve(pathBlocks.size());
+
+	for (auto it = pathBlocks.rbegin(); it != pathBlocks.rend(); ++it) {
+		const int2 square = nodeOffsets[*it];
+
+		path.path.emplace_back(square.x * SQUARE_SIZE, CMoveMath::yLevel(moveDef, square.x, square.y), square.y * SQUARE_SIZE);
+	}
+
+	path.pathGoal = path.path[0];
+	return true;
+}
+
+
 /**
  * Try to read offset and vertices data from file, return false on failure
  */
 bool CPathEstimator::ReadFile(const std::string& baseFileName, const std::string& mapName)
 {
 	const std::string hashHexString = IntToString(fileHashCode, "%x");
-	const std::string cacheFileName = GetPathCacheDir() + mapName + "." + baseFileName + "-" + hashHexString + ".zip";
+	const std::string cacheFileName = GetCacheFileName(mapName, baseFileName, fileHashCode, ".zip");
 
 	LOG("[PathEstimator::%s] hash=%s file=\"%s\" (exists=%d)", __func__, hashHexString.c_str(), cacheFileName.c_str(), FileSystem::FileExists(cacheFileName));
 
@@ -965,12 +1334,12 @@ bool CPathEstimator::ReadFile(const std::string& baseFileName, const std::string
 	}
 
 	// read vertex-cost data
-	if (buffer.size() < (pos + vertexCosts.size() * sizeof(float))) {
+	if (buffer.size() < (pos + numVertexCosts * sizeof(float))) {
 		FileSystem::Remove(cacheFileName);
 		return false;
 	}
 
-	std::memcpy(&vertexCosts[0], &buffer[pos], vertexCosts.size() * sizeof(float));
+	std::memcpy(&vertexCosts[0], &buffer[pos], numVertexCosts * sizeof(float));
 	return true;
 }
 
@@ -985,7 +1354,7 @@ void CPathEstimator::WriteFile(const std::string& baseFileName, const std::strin
 		return;
 
 	const std::string hashHexString = IntToString(fileHashCode, "%x");
-	const std::string cacheFileName = GetPathCacheDir() + mapName + "." + baseFileName + "-" + hashHexString + ".zip";
+	const std::string cacheFileName = GetCacheFileName(mapName, baseFileName, fileHashCode, ".zip");
 
 	LOG("[PathEstimator::%s] hash=%s file=\"%s\" (exists=%d)", __func__, hashHexString.c_str(), cacheFileName.c_str(), FileSystem::FileExists(cacheFileName));
 
@@ -1006,7 +1375,7 @@ void CPathEstimator::WriteFile(const std::string& baseFileName, const std::strin
 	}
 
 	// write vertex-costs
-	zipWriteInFileInZip(file, vertexCosts.data(), vertexCosts.size() * sizeof(float));
+	zipWriteInFileInZip(file, vertexCosts, numVertexCosts * sizeof(float));
 
 	zipCloseFileInZip(file);
 	zipClose(file, nullptr);
@@ -1026,6 +1395,66 @@ void CPathEstimator::WriteFile(const std::string& baseFileName, const std::strin
 }
 
 
+/**
+ * Try to map the flat cache-file, return false on failure
+ */
+bool CPathEstimator::ReadFlatFile(const std::string& baseFileName, const std::string& mapName)
+{
+	const std::string cacheFileName = GetCacheFileName(mapName, baseFileName, fileHashCode, ".bin");
+
+	LOG("[PathEstimator::%s] hash=%x file=\"%s\" (exists=%d)", __func__, fileHashCode, cacheFileName.c_str(), FileSystem::FileExists(cacheFileName));
+
+	if (!FileSystem::FileExists(cacheFileName))
+		return false;
+
+	char calcMsg[512];
+	sprintf(calcMsg, "Mapping Estimate PathCosts [%d]", BLOCK_SIZE);
+	loadscreen->SetLoadMessage(calcMsg);
+
+	if (!vertexCostsFile.Map(dataDirsAccess.LocateFile(cacheFileName), GetFlatFileLayout())) {
+		FileSystem::Remove(cacheFileName);
+		return false;
+	}
+
+	// the offsets are small, copy them
+	for (int pathType = 0; pathType < moveDefHandler->GetNumMoveDefs(); ++pathType) {
+		std::memcpy(&blockStates.peNodeOffsets[pathType][0], vertexCostsFile.GetOffsets(pathType), blockStates.GetSize() * sizeof(short2));
+	}
+
+	// MapChanged updates write to (private copies of) the mapped pages
+	vertexCosts = vertexCostsFile.GetVertexCosts();
+	pathChecksum = vertexCostsFile.GetChecksum();
+	return true;
+}
+
+
+/**
+ * Try to write offset and vertex data to the flat cache-file.
+ */
+bool CPathEstimator::WriteFlatFile(const std::string& baseFileName, const std::string& mapName)
+{
+	if (!FileSystem::CreateDirectory(GetPathCacheDir()))
+		return false;
+
+	const std::string cacheFileName = GetCacheFileName(mapName, baseFileName, fileHashCode, ".bin");
+
+	LOG("[PathEstimator::%s] hash=%x file=\"%s\"", __func__, fileHashCode, cacheFileName.c_str());
+
+	return (CPathFlatCache::Write(dataDirsAccess.LocateFile(cacheFileName, FileQueryFlags::WRITE), GetFlatFileLayout(), pathChecksum, blockStates.peNodeOffsets, vertexCosts));
+}
+
+CPathFlatCache::Layout CPathEstimator::GetFlatFileLayout() const
+{
+	CPathFlatCache::Layout layout;
+	layout.hashCode = fileHashCode;
+	layout.blockSize = BLOCK_SIZE;
+	layout.numPathTypes = moveDefHandler->GetNumMoveDefs();
+	layout.numBlocks = blockStates.GetSize();
+	layout.numVertexCosts = numVertexCosts;
+	return layout;
+}
+
+
 std::uint32_t CPathEstimator::CalcChecksum() const
 {
 	std::uint32_t cs = 0;
@@ -1049,14 +1478,14 @@ std::uint32_t CPathEstimator::CalcChecksum() const
 		#endif
 	}
 
-	nb = vertexCosts.size() * sizeof(float);
-	cs = HsiehHash(vertexCosts.data(), nb, cs);
+	nb = numVertexCosts * sizeof(float);
+	cs = HsiehHash(vertexCosts, nb, cs);
 
 	#if (ENABLE_NETLOG_CHECKSUM == 1)
 	{
 		rawBytes.resize(rawBytes.size() + nb);
 
-		std::memcpy(&rawBytes[rawBytes.size() - nb], vertexCosts.data(), nb);
+		std::memcpy(&rawBytes[rawBytes.size() - nb], vertexCosts, nb);
 		sha512::calc_digest(rawBytes, shaBytes); // hash(offsets|costs)
 		sha512::dump_digest(shaBytes, hexChars); // hexify(hash)
 
@@ -13,6 +13,7 @@
 #include "IPathFinder.h"
 #include "PathConstants.h"
 #include "PathDataTypes.h"
+#include "PathFlatCache.h"
 #include "System/float3.h"
 #include "System/Threading/SpringThreading.h"
 
@@ -41,6 +42,14 @@ public:
 	 *   Ex. PE-name "pe" + Mapname "Desert" => "Desert.pe"
 	 */
 	CPathEstimator(IPathFinder*, unsigned int BSIZE, const std::string& cacheFileName, const std::string& mapFileName);
+	/**
+	 * Creates a search-only estimator that reads the precalculated data and
+	 * the synced path-cache of <pe>, but keeps its own search state so that
+	 * it can run in parallel to other instances. Paths it would add to the
+	 * cache are collected in deferredCacheItems instead, and the hits it
+	 * finds in deferredCacheHits.
+	 */
+	CPathEstimator(const CPathEstimator* pe, IPathFinder* pf);
 	~CPathEstimator();
 
 
@@ -52,6 +61,12 @@ public:
 	 */
 	void MapChanged(unsigned int x1, unsigned int z1, unsigned int x2, unsigned int z2);
 
+	/**
+	 * Makes the next Update re-estimate the obsolete blocks around <pos>
+	 * (e.g. the start or goal of a queued path-request) before any others.
+	 */
+	void PrioritizeBlocks(const float3& pos);
+
 	/**
 	 * called every frame
 	 */
@@ -65,6 +80,39 @@ public:
 	 */
 	std::uint32_t GetPathChecksum() const { return pathChecksum; }
 
+	/**
+	 * Goal-rooted integration field over the blocks of this estimator; holds
+	 * the cost of the cheapest block-path from each block to the goal-region
+	 * it was built for, PATHCOST_INFINITY for blocks that were not reached.
+	 */
+	struct IntegrationField {
+		std::vector<float> costs;
+		int pathType = -1;
+		bool synced = true;
+	};
+
+	/**
+	 * Integrates <field> outward from the blocks within the goal-radius of
+	 * <peDef> until every block in <startBlocks> is settled or no more can
+	 * be reached. Only reads shared estimator data, so any number of fields
+	 * can be built in parallel.
+	 */
+	void CalcIntegrationField(const MoveDef& moveDef, const CPathFinderDef& peDef, const std::vector<int2>& startBlocks, IntegrationField& field) const;
+
+	/**
+	 * Descends <field> from the block containing <startPos> and stores the
+	 * resulting block-path in the same form as a regular search. Returns
+	 * false if the start-block was not reached by the field.
+	 */
+	bool GetIntegrationFieldPath(const MoveDef& moveDef, const IntegrationField& field, const float3& startPos, IPath::Path& path) const;
+
+	/// block containing <pos>, clamped to the map so it can always be indexed
+	int2 GetBlockPos(const float3& pos) const;
+
+	/// number of blocks waiting to be re-estimated
+	unsigned int GetNumObsoleteBlocks() const { return numObsoleteBlocks; }
+	const CPathCache::CacheStats& GetPathCacheStats(bool synced) const { return pathCache[synced]->GetFrameStats(); }
+
 
 protected: // IPathFinder impl
 	IPath::SearchResult DoBlockSearch(const CSolidObject* owner, const MoveDef& moveDef, const int2 s, const int2 g);
@@ -97,12 +145,16 @@ protected: // IPathFinder impl
 		const int2 goalBlock,
 		float goalRadius,
 		int pathType,
+		unsigned int searchCost,
 		const bool synced
 	) override;
+	/// applies a hit collected by a search-only instance to this one's cache
+	void AddCacheHit(const CPathCache::CacheKey& key, const bool synced);
 
 private:
 	void InitEstimator(const std::string& cacheFileName, const std::string& mapName);
 	void InitBlocks();
+	bool ConsumeBlock(const int2& blockPos);
 
 	void CalcOffsetsAndPathCosts(unsigned int threadNum, spring::barrier* pathBarrier);
 	void CalculateBlockOffsets(unsigned int, unsigned int);
@@ -114,6 +166,9 @@ private:
 
 	bool ReadFile(const std::string& baseFileName, const std::string& mapName);
 	void WriteFile(const std::string& baseFileName, const std::string& mapName);
+	bool ReadFlatFile(const std::string& baseFileName, const std::string& mapName);
+	bool WriteFlatFile(const std::string& baseFileName, const std::string& mapName);
+	CPathFlatCache::Layout GetFlatFileLayout() const;
 
 	std::uint32_t CalcChecksum() const;
 	std::uint32_t CalcHash(const char* caller) const;
@@ -137,13 +192,30 @@ private:
 	CPathEstimator* nextPathEstimator; // next lower-resolution estimator
 	CPathCache* pathCache[2]; // [0] = !synced, [1] = synced
 
-	std::vector<IPathFinder*> pathFinders; // InitEstimator helpers
+	const CPathEstimator* sharedPE; // owner of vertexCosts etc (this, unless search-only)
+	std::vector<CPathCache::CacheItem> deferredCacheItems;
+	mutable std::vector<CPathCache::CacheKey> deferredCacheHits;
+
+	// InitEstimator helpers; afterwards the instances (one per worker) used
+	// by Update, set up by CPathManager
+	std::vector<IPathFinder*> pathFinders;
 	std::vector<spring::thread> threads;
 
 	std::vector<float> maxSpeedMods;
-	std::vector<float> vertexCosts;
+
+	// points either into vertexCostsBuffer or into the mapped flat cache-file
+	float* vertexCosts;
+	size_t numVertexCosts;
+
+	std::vector<float> vertexCostsBuffer;
+	CPathFlatCache vertexCostsFile;
+
 	/// blocks that may need an update due to map changes
 	std::deque<int2> updatedBlocks;
+	/// centers of the areas to update first, see PrioritizeBlocks
+	std::vector<int2> priorityBlocks;
+
+	unsigned int numObsoleteBlocks;
 
 	int blockUpdatePenalty;
 
@@ -159,6 +231,9 @@ private:
 	};
 
 	std::vector<SingleBlock> consumedBlocks;
+	/// parent-cache additions and hits made while re-estimating each consumed block
+	std::vector< std::vector<CPathCache::CacheItem> > consumedCacheItems;
+	std::vector< std::vector<CPathCache::CacheKey> > consumedCacheHits;
 	std::vector<SOffsetBlock> offsetBlocksSortedByCost;
 };
 
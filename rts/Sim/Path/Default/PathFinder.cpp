@@ -76,7 +76,12 @@ static constexpr float3 PF_DIRECTION_VECTORS_3D[] = {
 CPathFinder::CPathFinder(bool threadSafe): IPathFinder(1)
 {
 	blockCheckFunc = blockCheckFuncs[threadSafe];
-	dummyCacheItem = CPathCache::CacheItem{IPath::Error, {}, {-1, -1}, {-1, -1}, -1.0f, -1};
+	dummyCacheItem = CPathCache::CacheItem{IPath::Error, {}, {-1, -1}, {-1, -1}, -1.0f, -1, 0};
+}
+
+CPathFinder::CPathFinder(const CPathFinder* pf): CPathFinder(true)
+{
+	sharedStates = &pf->blockStates;
 }
 
 
@@ -381,7 +386,7 @@ bool CPathFinder::TestBlock(
 
 	const float heatCost  = (pfDef.testMobile) ? (PathHeatMap::GetInstance())->GetHeatCost(square.x, square.y, moveDef, ((owner != NULL)? owner->id: -1U)) : 0.0f;
 	//const float flowCost  = (pfDef.testMobile) ? (PathFlowMap::GetInstance())->GetFlowCost(square.x, square.y, moveDef, pathOptDir) : 0.0f;
-	const float extraCost = blockStates.GetNodeExtraCost(square.x, square.y, pfDef.synced);
+	const float extraCost = sharedStates->GetNodeExtraCost(square.x, square.y, pfDef.synced);
 
 	const float dirMoveCost = (1.0f + heatCost) * PF_DIRECTION_COSTS[pathOptDir];
 	const float nodeCost = (dirMoveCost / speedMod) + extraCost;
@@ -20,6 +20,8 @@ class CPathFinderDef;
 class CPathFinder: public IPathFinder {
 public:
 	CPathFinder(bool threadSafe = true);
+	/// creates a thread-safe search instance that uses the node extra-costs of <pf>
+	CPathFinder(const CPathFinder* pf);
 
 	static void InitStatic();
 
@@ -69,6 +71,7 @@ protected:
 		const int2 goalBlock,
 		float goalRadius,
 		int pathType,
+		unsigned int searchCost,
 		const bool synced
 	) { }
 
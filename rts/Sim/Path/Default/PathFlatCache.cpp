@@ -0,0 +1,136 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <cstdio>
+#include <cstring>
+
+#include "PathFlatCache.h"
+#include "System/StringUtil.h"
+#include "System/Misc/SpringTime.h"
+#include "System/Sync/HsiehHash.h"
+
+static constexpr char FLAT_CACHE_MAGIC[8] = {'S', 'P', 'R', 'I', 'N', 'G', 'P', 'E'};
+static constexpr std::uint32_t FLAT_CACHE_VERSION = 1;
+static constexpr std::uint64_t FLAT_CACHE_ALIGNMENT = 4096;
+
+
+bool CPathFlatCache::Write(
+	const std::string& filePath,
+	const Layout& layout,
+	std::uint32_t checksum,
+	const std::vector< std::vector<short2> >& offsets,
+	const float* vertexCosts
+) {
+	const std::string tempFilePath = filePath + "." + IntToString(spring_gettime().toNanoSecsi() & 0x7fffffff, "%x");
+
+	const std::uint64_t offsetsSize = layout.numBlocks * sizeof(short2);
+	const std::uint64_t offsetsPos = sizeof(Header);
+	const std::uint64_t offsetsEnd = offsetsPos + offsetsSize * layout.numPathTypes;
+	const std::uint64_t costsPos = ((offsetsEnd + FLAT_CACHE_ALIGNMENT - 1) / FLAT_CACHE_ALIGNMENT) * FLAT_CACHE_ALIGNMENT;
+
+	if (offsets.size() != layout.numPathTypes)
+		return false;
+
+	Header header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, FLAT_CACHE_MAGIC, sizeof(FLAT_CACHE_MAGIC));
+
+	header.version = FLAT_CACHE_VERSION;
+	header.hashCode = layout.hashCode;
+	header.blockSize = layout.blockSize;
+	header.numPathTypes = layout.numPathTypes;
+	header.numBlocks = layout.numBlocks;
+	header.checksum = checksum;
+	header.numVertexCosts = layout.numVertexCosts;
+	header.offsetsPos = offsetsPos;
+	header.costsPos = costsPos;
+	header.fileSize = costsPos + layout.numVertexCosts * sizeof(float);
+
+	FILE* file = fopen(tempFilePath.c_str(), "wb");
+
+	if (file == nullptr)
+		return false;
+
+	const std::vector<std::uint8_t> padding(costsPos - offsetsEnd, 0);
+
+	bool written = (fwrite(&header, sizeof(header), 1, file) == 1);
+
+	for (const std::vector<short2>& pathTypeOffsets: offsets) {
+		written = written && (pathTypeOffsets.size() == layout.numBlocks);
+		written = written && (fwrite(pathTypeOffsets.data(), offsetsSize, 1, file) == 1);
+	}
+
+	written = written && (padding.empty() || fwrite(padding.data(), padding.size(), 1, file) == 1);
+	written = written && (fwrite(vertexCosts, layout.numVertexCosts * sizeof(float), 1, file) == 1);
+	written = (fclose(file) == 0) && written;
+
+	// rename does not replace existing files on Windows
+	if (written)
+		std::remove(filePath.c_str());
+
+	if (written && std::rename(tempFilePath.c_str(), filePath.c_str()) == 0)
+		return true;
+
+	std::remove(tempFilePath.c_str());
+	return false;
+}
+
+
+std::uint32_t CPathFlatCache::CalcChecksum(const Layout& layout, const short2* offsets, const float* vertexCosts)
+{
+	std::uint32_t cs = 0;
+
+	// hashed per path-type, as CPathEstimator keeps them in separate arrays
+	for (std::uint32_t pathType = 0; pathType < layout.numPathTypes; ++pathType) {
+		cs = HsiehHash(offsets + pathType * layout.numBlocks, layout.numBlocks * sizeof(short2), cs);
+	}
+
+	return (HsiehHash(vertexCosts, layout.numVertexCosts * sizeof(float), cs));
+}
+
+
+bool CPathFlatCache::Map(const std::string& filePath, const Layout& layout)
+{
+	if (!file.Open(filePath))
+		return false;
+
+	const std::uint8_t* fileData = file.GetData();
+	const std::uint64_t fileSize = file.GetSize();
+	const std::uint64_t offsetsSize = layout.numBlocks * sizeof(short2);
+
+	std::memset(&header, 0, sizeof(header));
+
+	if (fileSize >= sizeof(header))
+		std::memcpy(&header, fileData, sizeof(header));
+
+	bool validFile = true;
+
+	validFile &= (std::memcmp(header.magic, FLAT_CACHE_MAGIC, sizeof(FLAT_CACHE_MAGIC)) == 0);
+	validFile &= (header.version == FLAT_CACHE_VERSION);
+	validFile &= (header.hashCode == layout.hashCode);
+	validFile &= (header.blockSize == layout.blockSize);
+	validFile &= (header.numPathTypes == layout.numPathTypes);
+	validFile &= (header.numBlocks == layout.numBlocks);
+	validFile &= (header.numVertexCosts == layout.numVertexCosts);
+	validFile &= (header.fileSize == fileSize);
+	validFile &= (header.offsetsPos >= sizeof(header) && (header.offsetsPos % alignof(short2)) == 0);
+	validFile &= (header.costsPos >= (header.offsetsPos + offsetsSize * header.numPathTypes) && (header.costsPos % FLAT_CACHE_ALIGNMENT) == 0);
+	validFile &= (header.costsPos + layout.numVertexCosts * sizeof(float) == fileSize);
+
+	if (!validFile || CalcChecksum(layout, GetOffsets(0), GetVertexCosts()) != header.checksum) {
+		file.Close();
+		return false;
+	}
+
+	return true;
+}
+
+
+const short2* CPathFlatCache::GetOffsets(unsigned int pathType) const
+{
+	return (reinterpret_cast<const short2*>(file.GetData() + header.offsetsPos) + pathType * header.numBlocks);
+}
+
+float* CPathFlatCache::GetVertexCosts() const
+{
+	return (reinterpret_cast<float*>(file.GetData() + header.costsPos));
+}
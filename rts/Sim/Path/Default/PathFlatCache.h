@@ -0,0 +1,80 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef PATHFLATCACHE_H
+#define PATHFLATCACHE_H
+
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+#include "System/type2.h"
+#include "System/Platform/MappedFile.h"
+
+/**
+ * Uncompressed PE cache-file, used in place by mapping it (copy-on-write)
+ * into memory. Holds the block center-offsets of every path-type followed
+ * by the vertex-costs, which start on a page boundary.
+ */
+class CPathFlatCache
+{
+public:
+	/// everything a file must agree on with the estimator loading it
+	struct Layout {
+		std::uint32_t hashCode; // CPathEstimator::fileHashCode
+		std::uint32_t blockSize;
+		std::uint32_t numPathTypes;
+		std::uint32_t numBlocks;
+		std::uint64_t numVertexCosts;
+	};
+
+	/**
+	 * Writes a new cache-file; goes through a temporary file so that other
+	 * processes loading the same map never see a partial one. Returns false
+	 * if nothing was written.
+	 */
+	static bool Write(
+		const std::string& filePath,
+		const Layout& layout,
+		std::uint32_t checksum,
+		const std::vector< std::vector<short2> >& offsets,
+		const float* vertexCosts
+	);
+
+	/// same value as CPathEstimator::CalcChecksum
+	static std::uint32_t CalcChecksum(const Layout& layout, const short2* offsets, const float* vertexCosts);
+
+	/// false unless the file matches <layout> and the checksum stored in it
+	bool Map(const std::string& filePath, const Layout& layout);
+	void Close() { file.Close(); }
+
+	bool IsMapped() const { return file.IsOpen(); }
+
+	/// numBlocks offsets per path-type
+	const short2* GetOffsets(unsigned int pathType) const;
+	/// writes go to private copies of the mapped pages
+	float* GetVertexCosts() const;
+
+	std::uint32_t GetChecksum() const { return header.checksum; }
+
+private:
+	struct Header {
+		char magic[8];
+
+		std::uint32_t version;
+		std::uint32_t hashCode;
+		std::uint32_t blockSize;
+		std::uint32_t numPathTypes;
+		std::uint32_t numBlocks;
+		std::uint32_t checksum; // CalcChecksum over both sections
+
+		std::uint64_t numVertexCosts;
+		std::uint64_t offsetsPos;
+		std::uint64_t costsPos;
+		std::uint64_t fileSize;
+	};
+
+	CMappedFile file;
+	Header header;
+};
+
+#endif
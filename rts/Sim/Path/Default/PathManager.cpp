@@ -12,9 +12,16 @@
 #include "Sim/Misc/ModInfo.h"
 #include "Sim/Objects/SolidObject.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Log/ILog.h"
+#include "System/Threading/ThreadPool.h"
 #include "System/TimeProfiler.h"
 
+#include <algorithm>
+#include <atomic>
+#include <tuple>
+
+CONFIG(int, MaxPathSearchMemoryFootPrint).defaultValue(256).minimumValue(16).description("Maximum memusage (in MByte) of the per-thread pathfinder instances that service queued path-requests in parallel.");
 
 
 CPathManager::CPathManager()
@@ -43,6 +50,13 @@ CPathManager::CPathManager()
 
 CPathManager::~CPathManager()
 {
+	// search-only instances refer to the main ones, free them first
+	for (PathFinderSet& finders: searchFinders) {
+		peMemPool.free(finders.lowResPE);
+		peMemPool.free(finders.medResPE);
+		pfMemPool.free(finders.maxResPF);
+	}
+
 	peMemPool.free(lowResPE);
 	peMemPool.free(medResPE);
 	pfMemPool.free(maxResPF);
@@ -66,6 +80,34 @@ std::int64_t CPathManager::Finalize() {
 		// cache it desyncs from the start, not minutes later
 		{ SyncedUint tmp(GetPathCheckSum()); }
 	}
+	{
+		// one set of search instances per thread servicing queued requests, but
+		// keep their memory-footprint (dominated by the max-res PF node states)
+		// within bounds
+		const size_t minMemFootPrint = sizeof(CPathFinder) + maxResPF->GetMemFootPrint();
+		const size_t maxMemFootPrint = size_t(configHandler->GetInt("MaxPathSearchMemoryFootPrint")) * 1024 * 1024;
+		const size_t numSearchSets = Clamp(maxMemFootPrint / minMemFootPrint, size_t(1), size_t(ThreadPool::GetNumThreads()));
+
+		searchFinders.resize(numSearchSets);
+
+		for (PathFinderSet& finders: searchFinders) {
+			finders.maxResPF = pfMemPool.alloc<CPathFinder>(maxResPF);
+			finders.medResPE = peMemPool.alloc<CPathEstimator>(medResPE, finders.maxResPF);
+			finders.lowResPE = peMemPool.alloc<CPathEstimator>(lowResPE, finders.medResPE);
+		}
+
+		// the same instances re-estimate the PE's in parallel after map changes
+		medResPE->pathFinders.clear();
+		lowResPE->pathFinders.clear();
+
+		for (const PathFinderSet& finders: searchFinders) {
+			medResPE->pathFinders.push_back(finders.maxResPF);
+			lowResPE->pathFinders.push_back(finders.medResPE);
+		}
+
+		queuedPathIDs.reserve(1024);
+		queuedSearches.reserve(1024);
+	}
 
 	const spring_time dt = spring_gettime() - t0;
 	return (dt.toMilliSecsi());
@@ -110,6 +152,7 @@ void CPathManager::FinalizePath(MultiPath* path, const float3 startPos, const fl
 
 
 IPath::SearchResult CPathManager::ArrangePath(
+	const PathFinderSet& finders,
 	MultiPath* newPath,
 	const MoveDef* moveDef,
 	const float3& startPos,
@@ -138,7 +181,7 @@ IPath::SearchResult CPathManager::ArrangePath(
 	constexpr bool useConstraints[] = {false, false, false};
 	constexpr bool allowRawSearch[] = {false, false, false};
 
-	IPathFinder* pathFinders[] = {lowResPE, medResPE, maxResPF};
+	IPathFinder* pathFinders[] = {finders.lowResPE, finders.medResPE, finders.maxResPF};
 	IPath::Path* pathObjects[] = {&newPath->lowResPath, &newPath->medResPath, &newPath->maxResPath};
 
 	IPath::SearchResult bestResult = IPath::Error;
@@ -331,6 +374,10 @@ IPath::SearchResult CPathManager::ArrangePath(
 
 /*
 Request a new multipath, store the result and return a handle-id to it.
+
+Synced requests on behalf of an object (i.e. from its MoveType) are only
+queued here and searched in parallel during the next Update; until then
+NextWayPoint hands out temporary waypoints for them.
 */
 unsigned int CPathManager::RequestPath(
 	CSolidObject* caller,
@@ -357,35 +404,22 @@ unsigned int CPathManager::RequestPath(
 	newPath.caller = caller;
 	newPath.peDef.synced = synced;
 
+	if (caller != nullptr && synced) {
+		newPath.queued = true;
+
+		queuedPathIDs.push_back(Store(newPath));
+		return nextPathID;
+	}
+
 	if (caller != nullptr)
 		caller->UnBlock();
 
-	const IPath::SearchResult result = ArrangePath(&newPath, moveDef, startPos, goalPos, caller);
+	SearchPath(GetMainFinders(), newPath, startPos, goalPos, synced);
 
 	unsigned int pathID = 0;
 
-	if (result != IPath::Error) {
-		if (newPath.maxResPath.path.empty()) {
-			if (result != IPath::CantGetCloser) {
-				LowRes2MedRes(newPath, startPos, caller, synced);
-				MedRes2MaxRes(newPath, startPos, caller, synced);
-			} else {
-				// add one dummy waypoint so that the calling MoveType
-				// does not consider this request a failure, which can
-				// happen when startPos is very close to goalPos
-				//
-				// otherwise, code relying on MoveType::progressState
-				// (eg. BuilderCAI::MoveInBuildRange) would misbehave
-				// (eg. reject build orders)
-				newPath.maxResPath.path.push_back(startPos);
-				newPath.maxResPath.squares.push_back(int2(startPos.x / SQUARE_SIZE, startPos.z / SQUARE_SIZE));
-			}
-		}
-
-		FinalizePath(&newPath, startPos, goalPos, result == IPath::CantGetCloser);
-		newPath.searchResult = result;
+	if (newPath.searchResult != IPath::Error)
 		pathID = Store(newPath);
-	}
 
 	if (caller != nullptr)
 		caller->Block();
@@ -394,8 +428,229 @@ unsigned int CPathManager::RequestPath(
 }
 
 
+void CPathManager::SearchPath(
+	const PathFinderSet& finders,
+	MultiPath& multiPath,
+	const float3& startPos,
+	const float3& goalPos,
+	bool synced
+) const {
+	if ((multiPath.searchResult = ArrangePath(finders, &multiPath, multiPath.moveDef, startPos, goalPos, multiPath.caller)) == IPath::Error)
+		return;
+
+	RefinePath(finders, multiPath, startPos, goalPos, synced);
+}
+
+bool CPathManager::SearchFieldPath(
+	const PathFinderSet& finders,
+	MultiPath& multiPath,
+	const CPathEstimator::IntegrationField& field
+) const {
+	// takes the place of the low-res search ArrangePath would have run
+	if (!finders.lowResPE->GetIntegrationFieldPath(*multiPath.moveDef, field, multiPath.start, multiPath.lowResPath))
+		return false;
+
+	multiPath.searchResult = IPath::Ok;
+
+	RefinePath(finders, multiPath, multiPath.start, multiPath.finalGoal, true);
+	return true;
+}
+
+void CPathManager::RefinePath(
+	const PathFinderSet& finders,
+	MultiPath& multiPath,
+	const float3& startPos,
+	const float3& goalPos,
+	bool synced
+) const {
+	const IPath::SearchResult result = multiPath.searchResult;
+
+	if (multiPath.maxResPath.path.empty()) {
+		if (result != IPath::CantGetCloser) {
+			LowRes2MedRes(finders, multiPath, startPos, multiPath.caller, synced);
+			MedRes2MaxRes(finders, multiPath, startPos, multiPath.caller, synced);
+		} else {
+			// add one dummy waypoint so that the calling MoveType
+			// does not consider this request a failure, which can
+			// happen when startPos is very close to goalPos
+			//
+			// otherwise, code relying on MoveType::progressState
+			// (eg. BuilderCAI::MoveInBuildRange) would misbehave
+			// (eg. reject build orders)
+			multiPath.maxResPath.path.push_back(startPos);
+			multiPath.maxResPath.squares.push_back(int2(startPos.x / SQUARE_SIZE, startPos.z / SQUARE_SIZE));
+		}
+	}
+
+	FinalizePath(&multiPath, startPos, goalPos, result == IPath::CantGetCloser);
+}
+
+
+void CPathManager::SearchQueuedPaths()
+{
+	SCOPED_TIMER("Sim::Path::Requests");
+
+	queuedSearches.clear();
+
+	for (const unsigned int pathID: queuedPathIDs) {
+		MultiPath* multiPath = GetMultiPath(pathID);
+
+		// request was deleted again before it could be serviced
+		if (multiPath == nullptr)
+			continue;
+
+		queuedSearches.emplace_back();
+		queuedSearches.back().pathID = pathID;
+		queuedSearches.back().multiPath = multiPath;
+		queuedSearches.back().fieldGroupIdx = -1;
+	}
+
+	queuedPathIDs.clear();
+
+	if (queuedSearches.empty())
+		return;
+
+	GroupQueuedSearches();
+
+	// every search only reads shared state (blocking-map, PE vertex costs and
+	// caches, ...) and writes to its own MultiPath and search instances, so
+	// results do not depend on which thread services a request or in which
+	// order; owners are not unblocked, the thread-safe block-checks used by
+	// the search instances already ignore them
+	std::atomic<unsigned int> nextSearchIdx(0);
+
+	for_mt(0, searchFinders.size(), [&](const int i) {
+		const PathFinderSet& finders = searchFinders[i];
+
+		for (unsigned int n = nextSearchIdx++; n < queuedSearches.size(); n = nextSearchIdx++) {
+			QueuedSearch& search = queuedSearches[n];
+			MultiPath& multiPath = *search.multiPath;
+
+			if (search.fieldGroupIdx < 0 || !SearchFieldPath(finders, multiPath, fieldGroups[search.fieldGroupIdx].field))
+				SearchPath(finders, multiPath, multiPath.start, multiPath.finalGoal, true);
+
+			std::swap(search.cacheHits[0], finders.medResPE->deferredCacheHits);
+			std::swap(search.cacheHits[1], finders.lowResPE->deferredCacheHits);
+			std::swap(search.cacheItems[0], finders.medResPE->deferredCacheItems);
+			std::swap(search.cacheItems[1], finders.lowResPE->deferredCacheItems);
+		}
+	});
+
+	// hand out the results in request order
+	for (QueuedSearch& search: queuedSearches) {
+		MultiPath* multiPath = search.multiPath;
+
+		for (const CPathCache::CacheKey& ck: search.cacheHits[0]) {
+			medResPE->AddCacheHit(ck, true);
+		}
+		for (const CPathCache::CacheKey& ck: search.cacheHits[1]) {
+			lowResPE->AddCacheHit(ck, true);
+		}
+		for (const CPathCache::CacheItem& ci: search.cacheItems[0]) {
+			medResPE->AddCache(&ci.path, ci.result, ci.strtBlock, ci.goalBlock, ci.goalRadius, ci.pathType, ci.searchCost, true);
+		}
+		for (const CPathCache::CacheItem& ci: search.cacheItems[1]) {
+			lowResPE->AddCache(&ci.path, ci.result, ci.strtBlock, ci.goalBlock, ci.goalRadius, ci.pathType, ci.searchCost, true);
+		}
+
+		multiPath->queued = false;
+
+		// same as a failed synchronous request, but the owner only finds
+		// out when NextWayPoint returns an error-vector for the dangling ID
+		if (multiPath->searchResult == IPath::Error)
+			pathMap.erase(search.pathID);
+	}
+}
+
+
+/*
+Large groups given the same move order would each run their own low-res
+search over mostly the same blocks; requests that are far enough from their
+goal to end up with a low-res path are instead grouped by MoveDef, low-res
+goal-block and goal-radius, and every group that is large enough gets one
+integration field (rooted at the goal-region of its first request) which
+its members descend to obtain their low-res paths. The refinement near the
+start and the final approach still happen per request.
+*/
+void CPathManager::GroupQueuedSearches()
+{
+	fieldGroups.clear();
+
+	const unsigned int minGroupSize = modInfo.pfFlowFieldMinGroupSize;
+
+	if (minGroupSize == 0 || queuedSearches.size() < minGroupSize)
+		return;
+
+	// {pathType, goal-block index, goal-radius, search index}; sorted so that
+	// groups and their members are always formed in the same order
+	typedef std::tuple<int, int, float, unsigned int> SearchKey;
+
+	std::vector<SearchKey> searchKeys;
+	searchKeys.reserve(queuedSearches.size());
+
+	for (unsigned int n = 0; n < queuedSearches.size(); n++) {
+		const MultiPath* multiPath = queuedSearches[n].multiPath;
+		const CPathFinderDef& peDef = multiPath->peDef;
+
+		const float3& startPos = multiPath->start;
+		const float3& goalPos = multiPath->finalGoal;
+
+		// same distance as used by ArrangePath to pick the low-res PE
+		const float heurGoalDist2D = peDef.Heuristic(startPos.x / SQUARE_SIZE, startPos.z / SQUARE_SIZE, 1) + math::fabs(goalPos.y - startPos.y) / SQUARE_SIZE;
+
+		if (heurGoalDist2D <= MEDRES_SEARCH_DISTANCE)
+			continue;
+
+		const int2 goalBlockPos = lowResPE->GetBlockPos(goalPos);
+		const int goalBlockIdx = lowResPE->BlockPosToIdx(goalBlockPos);
+
+		searchKeys.emplace_back(multiPath->moveDef->pathType, goalBlockIdx, peDef.sqGoalRadius, n);
+	}
+
+	std::sort(searchKeys.begin(), searchKeys.end());
+
+	for (size_t i = 0, j = 0; i < searchKeys.size(); i = j) {
+		for (j = i + 1; j < searchKeys.size(); j++) {
+			if (std::get<0>(searchKeys[i]) != std::get<0>(searchKeys[j]))
+				break;
+			if (std::get<1>(searchKeys[i]) != std::get<1>(searchKeys[j]))
+				break;
+			if (std::get<2>(searchKeys[i]) != std::get<2>(searchKeys[j]))
+				break;
+		}
+
+		if ((j - i) < minGroupSize)
+			continue;
+
+		fieldGroups.emplace_back();
+		fieldGroups.back().multiPath = queuedSearches[std::get<3>(searchKeys[i])].multiPath;
+		fieldGroups.back().startBlocks.reserve(j - i);
+
+		for (size_t k = i; k < j; k++) {
+			QueuedSearch& search = queuedSearches[std::get<3>(searchKeys[k])];
+
+			search.fieldGroupIdx = fieldGroups.size() - 1;
+			fieldGroups.back().startBlocks.push_back(lowResPE->GetBlockPos(search.multiPath->start));
+		}
+	}
+
+	if (fieldGroups.empty())
+		return;
+
+	SCOPED_TIMER("Sim::Path::Requests::FlowFields");
+
+	// fields only read shared PE data; each goes into its own group
+	for_mt(0, fieldGroups.size(), [&](const int i) {
+		FieldGroup& group = fieldGroups[i];
+		const MultiPath* multiPath = group.multiPath;
+
+		lowResPE->CalcIntegrationField(*multiPath->moveDef, multiPath->peDef, group.startBlocks, group.field);
+	});
+}
+
+
 // converts part of a med-res path into a max-res path
-void CPathManager::MedRes2MaxRes(MultiPath& multiPath, const float3& startPos, const CSolidObject* owner, bool synced) const
+void CPathManager::MedRes2MaxRes(const PathFinderSet& finders, MultiPath& multiPath, const float3& startPos, const CSolidObject* owner, bool synced) const
 {
 	assert(IsFinalized());
 
@@ -428,7 +683,7 @@ void CPathManager::MedRes2MaxRes(MultiPath& multiPath, const float3& startPos, c
 	// Perform the search.
 	// If this is the final improvement of the path, then use the original goal.
 	const auto& pfd = (medResPath.path.empty() && lowResPath.path.empty()) ? multiPath.peDef : rangedGoalDef;
-	const IPath::SearchResult result = maxResPF->GetPath(*multiPath.moveDef, pfd, owner, startPos, maxResPath, MAX_SEARCHED_NODES_ON_REFINE);
+	const IPath::SearchResult result = finders.maxResPF->GetPath(*multiPath.moveDef, pfd, owner, startPos, maxResPath, MAX_SEARCHED_NODES_ON_REFINE);
 
 	// If no refined path could be found, set goal as desired goal.
 	if (result == IPath::CantGetCloser || result == IPath::Error) {
@@ -437,7 +692,7 @@ void CPathManager::MedRes2MaxRes(MultiPath& multiPath, const float3& startPos, c
 }
 
 // converts part of a low-res path into a med-res path
-void CPathManager::LowRes2MedRes(MultiPath& multiPath, const float3& startPos, const CSolidObject* owner, bool synced) const
+void CPathManager::LowRes2MedRes(const PathFinderSet& finders, MultiPath& multiPath, const float3& startPos, const CSolidObject* owner, bool synced) const
 {
 	assert(IsFinalized());
 
@@ -467,7 +722,7 @@ void CPathManager::LowRes2MedRes(MultiPath& multiPath, const float3& startPos, c
 	// Perform the search.
 	// If there is no low-res path left, use original goal.
 	const auto& pfd = (lowResPath.path.empty()) ? multiPath.peDef : rangedGoalDef;
-	const IPath::SearchResult result = medResPE->GetPath(*multiPath.moveDef, pfd, owner, startPos, medResPath, MAX_SEARCHED_NODES_ON_REFINE);
+	const IPath::SearchResult result = finders.medResPE->GetPath(*multiPath.moveDef, pfd, owner, startPos, medResPath, MAX_SEARCHED_NODES_ON_REFINE);
 
 	// If no refined path could be found, set goal as desired goal.
 	if (result == IPath::CantGetCloser || result == IPath::Error) {
@@ -505,6 +760,18 @@ float3 CPathManager::NextWayPoint(
 	if (multiPath == nullptr)
 		return noPathPoint;
 
+	if (multiPath->queued) {
+		// request has not been searched yet (happens in Update), just
+		// set the owner off toward its goal to hide the latency; keep
+		// the returned point a fixed small distance ahead s.t. the owner
+		// asks again soon
+		//
+		// make the y-coordinate -1 to indicate these are temporary
+		// waypoints to GMT and should not be followed religiously
+		const float3 targetDirec = (multiPath->finalGoal - callerPos).SafeNormalize() * SQUARE_SIZE;
+		return float3(callerPos.x + targetDirec.x, -1.0f, callerPos.z + targetDirec.z);
+	}
+
 	if (numRetries > MAX_PATH_REFINEMENT_DEPTH)
 		return (multiPath->finalGoal);
 
@@ -530,9 +797,9 @@ float3 CPathManager::NextWayPoint(
 			multiPath->caller->UnBlock();
 
 		if (extendMedResPath)
-			LowRes2MedRes(*multiPath, callerPos, owner, synced);
+			LowRes2MedRes(GetMainFinders(), *multiPath, callerPos, owner, synced);
 
-		MedRes2MaxRes(*multiPath, callerPos, owner, synced);
+		MedRes2MaxRes(GetMainFinders(), *multiPath, callerPos, owner, synced);
 
 		if (multiPath->caller != nullptr)
 			multiPath->caller->Block();
@@ -574,7 +841,6 @@ float3 CPathManager::NextWayPoint(
 	} while ((callerPos.SqDistance2D(waypoint) < Square(radius)) && (waypoint != maxResPath.pathGoal));
 
 	// y=0 indicates this is not a temporary waypoint
-	// (the default PFS does not queue path-requests)
 	return (waypoint * XZVector);
 }
 
@@ -600,11 +866,29 @@ void CPathManager::Update()
 	SCOPED_TIMER("Sim::Path");
 	assert(IsFinalized());
 
-	pathFlowMap->Update();
-	pathHeatMap->Update();
+	// re-estimate the changed areas around queued requests first, so
+	// these are searched with up-to-date costs
+	for (const unsigned int pathID: queuedPathIDs) {
+		const MultiPath* multiPath = GetMultiPathConst(pathID);
+
+		if (multiPath == nullptr)
+			continue;
+
+		medResPE->PrioritizeBlocks(multiPath->start);
+		medResPE->PrioritizeBlocks(multiPath->finalGoal);
+		lowResPE->PrioritizeBlocks(multiPath->start);
+		lowResPE->PrioritizeBlocks(multiPath->finalGoal);
+	}
 
 	medResPE->Update();
 	lowResPE->Update();
+
+	// service the requests made during the previous frame, so they
+	// all see the same state regardless of when they were issued
+	SearchQueuedPaths();
+
+	pathFlowMap->Update();
+	pathHeatMap->Update();
 }
 
 // used to deposit heat on the heat-map as a unit moves along its path
@@ -768,10 +1052,29 @@ int2 CPathManager::GetNumQueuedUpdates() const {
 	int2 data;
 
 	if (IsFinalized()) {
-		data.x = medResPE->updatedBlocks.size();
-		data.y = lowResPE->updatedBlocks.size();
+		data.x = medResPE->GetNumObsoleteBlocks();
+		data.y = lowResPE->GetNumObsoleteBlocks();
 	}
 
 	return data;
 }
 
+IPathManager::PathCacheStats CPathManager::GetPathCacheStats(bool synced) const {
+	PathCacheStats stats = {0, 0, 0, 0, 0};
+
+	if (!IsFinalized())
+		return stats;
+
+	for (const CPathEstimator* pe: {medResPE, lowResPE}) {
+		const CPathCache::CacheStats& cs = pe->GetPathCacheStats(synced);
+
+		stats.numHits        += cs.numHits;
+		stats.numMisses      += cs.numMisses;
+		stats.numEvictions   += cs.numEvictions;
+		stats.numExpirations += cs.numExpirations;
+		stats.numCachedPaths += cs.numCachedPaths;
+	}
+
+	return stats;
+}
+
@@ -4,15 +4,17 @@
 #define PATHMANAGER_H
 
 #include <cinttypes>
+#include <vector>
 
 #include "Sim/Path/IPathManager.h"
 #include "IPath.h"
+#include "PathCache.h"
+#include "PathEstimator.h"
 #include "PathFinderDef.h"
 #include "System/UnorderedMap.hpp"
 
 class CSolidObject;
 class CPathFinder;
-class CPathEstimator;
 class PathFlowMap;
 class PathHeatMap;
 class CPathFinderDef;
@@ -90,16 +92,18 @@ public:
 	const float* GetNodeExtraCosts(bool) const override;
 
 	int2 GetNumQueuedUpdates() const override;
+	PathCacheStats GetPathCacheStats(bool synced) const override;
 
 private:
 	struct MultiPath {
-		MultiPath(): moveDef(nullptr), caller(nullptr) {}
+		MultiPath(): moveDef(nullptr), caller(nullptr), queued(false) {}
 		MultiPath(const MoveDef* moveDef, const float3& startPos, const float3& goalPos, float goalRadius)
 			: searchResult(IPath::Error)
 			, start(startPos)
 			, peDef(startPos, goalPos, goalRadius, 3.0f, 2000)
 			, moveDef(moveDef)
 			, caller(nullptr)
+			, queued(false)
 		{}
 
 		MultiPath(const MultiPath& mp) = delete;
@@ -119,6 +123,7 @@ private:
 			peDef   = mp.peDef;
 			moveDef = mp.moveDef;
 			caller  = mp.caller;
+			queued  = mp.queued;
 
 			mp.moveDef = nullptr;
 			mp.caller  = nullptr;
@@ -142,10 +147,44 @@ private:
 
 		// additional information
 		CSolidObject* caller;
+
+		// true until the request has been serviced by Update
+		bool queued;
+	};
+
+	struct PathFinderSet {
+		CPathFinder* maxResPF;
+		CPathEstimator* medResPE;
+		CPathEstimator* lowResPE;
+	};
+
+	struct QueuedSearch {
+		unsigned int pathID;
+		MultiPath* multiPath;
+
+		// hits on and additions to the synced {med,low}-res PE caches made by
+		// this search, applied in request order after all queued searches have
+		// finished
+		std::vector<CPathCache::CacheKey> cacheHits[2];
+		std::vector<CPathCache::CacheItem> cacheItems[2];
+
+		// index into fieldGroups, or -1 if searched on its own
+		int fieldGroupIdx;
+	};
+
+	// queued requests that share a MoveDef and a low-res goal-block
+	// (and goal-radius), all served from a single integration field
+	struct FieldGroup {
+		// first request of the group, defines the goal-region
+		const MultiPath* multiPath;
+
+		std::vector<int2> startBlocks;
+		CPathEstimator::IntegrationField field;
 	};
 
 private:
 	IPath::SearchResult ArrangePath(
+		const PathFinderSet& finders,
 		MultiPath* newPath,
 		const MoveDef* moveDef,
 		const float3& startPos,
@@ -153,6 +192,13 @@ private:
 		CSolidObject* caller
 	) const;
 
+	void SearchPath(const PathFinderSet& finders, MultiPath& multiPath, const float3& startPos, const float3& goalPos, bool synced) const;
+	bool SearchFieldPath(const PathFinderSet& finders, MultiPath& multiPath, const CPathEstimator::IntegrationField& field) const;
+	void RefinePath(const PathFinderSet& finders, MultiPath& multiPath, const float3& startPos, const float3& goalPos, bool synced) const;
+
+	void SearchQueuedPaths();
+	void GroupQueuedSearches();
+
 	MultiPath* GetMultiPath(int pathID) { return (const_cast<MultiPath*>(GetMultiPathConst(pathID))); }
 
 	const MultiPath* GetMultiPathConst(int pathID) const {
@@ -170,11 +216,13 @@ private:
 
 	static void FinalizePath(MultiPath* path, const float3 startPos, const float3 goalPos, const bool cantGetCloser);
 
-	void LowRes2MedRes(MultiPath& path, const float3& startPos, const CSolidObject* owner, bool synced) const;
-	void MedRes2MaxRes(MultiPath& path, const float3& startPos, const CSolidObject* owner, bool synced) const;
+	void LowRes2MedRes(const PathFinderSet& finders, MultiPath& path, const float3& startPos, const CSolidObject* owner, bool synced) const;
+	void MedRes2MaxRes(const PathFinderSet& finders, MultiPath& path, const float3& startPos, const CSolidObject* owner, bool synced) const;
 
 	bool IsFinalized() const { return (maxResPF != nullptr); }
 
+	PathFinderSet GetMainFinders() const { return {maxResPF, medResPE, lowResPE}; }
+
 private:
 	CPathFinder* maxResPF;
 	CPathEstimator* medResPE;
@@ -185,6 +233,15 @@ private:
 
 	spring::unordered_map<unsigned int, MultiPath> pathMap;
 
+	// search instances used by SearchQueuedPaths, one set per worker;
+	// these share node-costs and PE data with the main instances above
+	std::vector<PathFinderSet> searchFinders;
+
+	// ID's of synced unit requests issued since the last Update
+	std::vector<unsigned int> queuedPathIDs;
+	std::vector<QueuedSearch> queuedSearches;
+	std::vector<FieldGroup> fieldGroups;
+
 	unsigned int nextPathID;
 };
 
@@ -14,6 +14,15 @@ struct MoveDef;
 class CSolidObject;
 
 class IPathManager {
+public:
+	struct PathCacheStats {
+		unsigned int numHits;
+		unsigned int numMisses;
+		unsigned int numEvictions;
+		unsigned int numExpirations;
+		unsigned int numCachedPaths;
+	};
+
 public:
 	static IPathManager* GetInstance(unsigned int type);
 	static void FreeInstance(IPathManager*);
@@ -164,6 +173,8 @@ public:
 	virtual const float* GetNodeExtraCosts(bool synced) const { return NULL; }
 
 	virtual int2 GetNumQueuedUpdates() const { return (int2(0, 0)); }
+	/// path-cache counters of the last completed sim-frame, summed over all caches
+	virtual PathCacheStats GetPathCacheStats(bool synced) const { return {0, 0, 0, 0, 0}; }
 };
 
 extern IPathManager* pathManager;
@@ -3,9 +3,13 @@
 #ifndef QTPFS_NODEHEAP_HDR
 #define QTPFS_NODEHEAP_HDR
 
+#include <array>
+#include <cassert>
+#include <cstring>
 #include <limits>
 #include <vector>
 #include "PathDefines.hpp"
+#include "System/bitops.h"
 
 #define NODE_CMP_EQ(a, b) (a->operator==(b))
 #define NODE_CMP_LT(a, b) (a->operator< (b))
@@ -291,6 +295,234 @@ namespace QTPFS {
 		size_t cur_idx; // index of first free (unused) slot
 		size_t max_idx; // index of last free (unused) slot
 	};
+
+
+
+	// monotone radix heap with the same interface as binary_heap
+	//
+	// bucket i > 0 holds the nodes whose priority first differs from the
+	// most recently extracted minimum in bit i-1 and bucket 0 those equal
+	// to it; the first non-empty bucket is split up again whenever bucket
+	// 0 runs dry. nodes below the minimum (which inconsistent heuristics
+	// can cause) are clamped into an extra bucket that is always emptied
+	// first. each node's heap-index encodes its bucket and slot, so that
+	// resort() does not have to search for it
+	template<class TNode> class radix_heap {
+	public:
+		radix_heap() { clear(); }
+		~radix_heap() { clear(); }
+
+		// interface functions
+		void push(TNode n) {
+			insert(n);
+			num_nodes += 1;
+		}
+
+		void pop() {
+			const size_t b_idx = refill();
+			const size_t s_idx = min_idx(b_idx);
+
+			TNode n = buckets[b_idx][s_idx];
+
+			erase(b_idx, s_idx);
+			n->SetHeapIndex(-1u);
+
+			num_nodes -= 1;
+		}
+
+		TNode top() {
+			const size_t b_idx = refill();
+			return buckets[b_idx][min_idx(b_idx)];
+		}
+
+		void resort(TNode n) {
+			assert(n != NULL);
+
+			const size_t b_idx = n->GetHeapIndex() >> SLOT_BITS;
+			const size_t s_idx = n->GetHeapIndex() & SLOT_MASK;
+
+			assert(b_idx < buckets.size());
+			assert(s_idx < buckets[b_idx].size());
+			assert(buckets[b_idx][s_idx] == n);
+
+			// bail if <n> is still in the right bucket
+			if (bucket_idx(get_key(n)) == b_idx)
+				return;
+
+			erase(b_idx, s_idx);
+			insert(n);
+		}
+
+
+		// utility functions
+		bool empty() const { return (size() == 0); }
+		size_t size() const { return num_nodes; }
+		size_t capacity() const { return max_size; }
+
+		void clear() {
+			reset();
+			max_size = 0;
+		}
+
+		void reserve(size_t size) {
+			assert(size <= SLOT_MASK);
+			reset();
+
+			// buckets grow on demand, nodes are spread out over all of them
+			max_size = size;
+		}
+
+		// like binary_heap::reset(), the buckets keep their memory
+		void reset() {
+			for (std::vector<TNode>& bucket: buckets) {
+				bucket.clear();
+			}
+
+			last_key = 0;
+			num_nodes = 0;
+		}
+
+
+		void check_heap_property(size_t) const {
+			#ifdef QTPFS_DEBUG_NODE_HEAP
+			for (size_t b_idx = 0; b_idx < buckets.size(); b_idx++) {
+				for (size_t s_idx = 0; s_idx < buckets[b_idx].size(); s_idx++) {
+					assert(buckets[b_idx][s_idx]->GetHeapIndex() == ((b_idx << SLOT_BITS) | s_idx));
+					assert(bucket_idx(get_key(buckets[b_idx][s_idx])) == b_idx);
+				}
+			}
+			#endif
+		}
+
+	private:
+		// maps a node's priority onto an unsigned integer with the same ordering
+		static std::uint32_t get_key(const TNode n) {
+			const float p = n->GetHeapPriority();
+
+			std::uint32_t bits;
+			std::memcpy(&bits, &p, sizeof(bits));
+			return (bits ^ (((bits >> 31) != 0)? 0xFFFFFFFFu: 0x80000000u));
+		}
+
+		size_t bucket_idx(std::uint32_t key) const {
+			if (key < last_key)
+				return CLAMP_BUCKET;
+
+			return (count_significant_bits(key ^ last_key));
+		}
+
+		// slot of the lowest-priority node in bucket <b_idx>; every node in
+		// bucket 0 has the same key, only the clamped ones need a scan
+		size_t min_idx(size_t b_idx) const {
+			const std::vector<TNode>& bucket = buckets[b_idx];
+
+			if (b_idx == 0)
+				return (bucket.size() - 1);
+
+			size_t n_idx = 0;
+
+			for (size_t s_idx = 1; s_idx < bucket.size(); s_idx++) {
+				if (NODE_CMP_LT(bucket[s_idx], bucket[n_idx])) {
+					n_idx = s_idx;
+				}
+			}
+
+			return n_idx;
+		}
+
+		// returns the bucket holding the minimum
+		size_t refill() {
+			assert(!empty());
+
+			if (!buckets[CLAMP_BUCKET].empty())
+				return CLAMP_BUCKET;
+			if (!buckets[0].empty())
+				return 0;
+
+			size_t b_idx = 1;
+
+			while (buckets[b_idx].empty())
+				b_idx++;
+
+			std::vector<TNode>& bucket = buckets[b_idx];
+
+			last_key = std::numeric_limits<std::uint32_t>::max();
+
+			for (const TNode n: bucket) {
+				last_key = std::min(last_key, get_key(n));
+			}
+
+			// every key in <bucket> now differs from the new minimum in
+			// bits below b_idx-1 only, so they all move to lower buckets
+			for (const TNode n: bucket) {
+				assert(bucket_idx(get_key(n)) < b_idx);
+				insert(n);
+			}
+
+			bucket.clear();
+			return 0;
+		}
+
+		void insert(TNode n) {
+			const size_t b_idx = bucket_idx(get_key(n));
+
+			std::vector<TNode>& bucket = buckets[b_idx];
+
+			n->SetHeapIndex((b_idx << SLOT_BITS) | bucket.size());
+			bucket.push_back(n);
+		}
+
+		void erase(size_t b_idx, size_t s_idx) {
+			std::vector<TNode>& bucket = buckets[b_idx];
+
+			if (s_idx != (bucket.size() - 1)) {
+				bucket[s_idx] = bucket.back();
+				bucket[s_idx]->SetHeapIndex((b_idx << SLOT_BITS) | s_idx);
+			}
+
+			bucket.pop_back();
+		}
+
+	private:
+		static constexpr unsigned int SLOT_BITS = 26;
+		static constexpr unsigned int SLOT_MASK = (1u << SLOT_BITS) - 1;
+		static constexpr unsigned int CLAMP_BUCKET = 33;
+
+		std::array<std::vector<TNode>, CLAMP_BUCKET + 1> buckets;
+
+		std::uint32_t last_key;
+
+		size_t num_nodes;
+		size_t max_size;
+	};
+
+
+
+	// open-list of a QTPFS search, see CModInfo::qtpfsRadixQueue
+	template<class TNode> class node_heap {
+	public:
+		void set_radix(bool b) { assert(empty()); use_radix = b; }
+
+		void push(TNode n) { if (use_radix) { radix.push(n); } else { binary.push(n); } }
+		void pop() { if (use_radix) { radix.pop(); } else { binary.pop(); } }
+		void resort(TNode n) { if (use_radix) { radix.resort(n); } else { binary.resort(n); } }
+		TNode top() { return (use_radix? radix.top(): binary.top()); }
+
+		bool empty() const { return (use_radix? radix.empty(): binary.empty()); }
+		size_t capacity() const { return (use_radix? radix.capacity(): binary.capacity()); }
+
+		void clear() { radix.clear(); binary.clear(); }
+		void reserve(size_t size) { if (use_radix) { radix.reserve(size); } else { binary.reserve(size); } }
+		void reset() { if (use_radix) { radix.reset(); } else { binary.reset(); } }
+
+		void check_heap_property(size_t idx) const { if (use_radix) { radix.check_heap_property(idx); } else { binary.check_heap_property(idx); } }
+
+	private:
+		binary_heap<TNode> binary;
+		radix_heap<TNode> radix;
+
+		bool use_radix = false;
+	};
 }
 
 #endif
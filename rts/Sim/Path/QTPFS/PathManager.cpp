@@ -119,6 +119,8 @@ QTPFS::PathManager::~PathManager() {
 	nodeLayers.clear();
 	pathCaches.clear();
 	pathSearches.clear();
+	scheduledSearches.clear();
+	sharedPaths.clear();
 	pathTypes.clear();
 	pathTraces.clear();
 
@@ -181,6 +183,8 @@ void QTPFS::PathManager::Load() {
 	nodeLayers.resize(moveDefHandler->GetNumMoveDefs());
 	pathCaches.resize(moveDefHandler->GetNumMoveDefs());
 	pathSearches.resize(moveDefHandler->GetNumMoveDefs());
+	scheduledSearches.resize(moveDefHandler->GetNumMoveDefs());
+	sharedPaths.resize(moveDefHandler->GetNumMoveDefs());
 
 	// add one extra element for object-less requests
 	numCurrExecutedSearches.resize(teamHandler->ActiveTeams() + 1, 0);
@@ -687,19 +691,38 @@ void QTPFS::PathManager::ThreadUpdate() {
 		static unsigned int minPathTypeUpdate = 0;
 		static unsigned int maxPathTypeUpdate = numPathTypeUpdates;
 
-		sharedPaths.clear();
-
+		// NOTE:
+		//   searches (and layer updates) for different path-types only touch
+		//   their own NodeLayer, node-tree and PathCache, so the layers in this
+		//   batch are processed concurrently; everything that is shared among
+		//   layers (path-ID map, team search limits, node search-states) gets
+		//   handled serially and in path-type order before or after, such that
+		//   the results do not depend on the number of threads
+		#ifndef QTPFS_IGNORE_DEAD_PATHS
 		for (unsigned int pathTypeUpdate = minPathTypeUpdate; pathTypeUpdate < maxPathTypeUpdate; pathTypeUpdate++) {
-			#ifndef QTPFS_IGNORE_DEAD_PATHS
 			QueueDeadPathSearches(pathTypeUpdate);
-			#endif
+		}
+		#endif
 
-			#ifdef QTPFS_STAGGERED_LAYER_UPDATES
-			// NOTE: *must* be called between QueueDeadPathSearches and ExecuteQueuedSearches
+		#ifdef QTPFS_STAGGERED_LAYER_UPDATES
+		// NOTE:
+		//   *must* be called between QueueDeadPathSearches and ExecuteQueuedSearches
+		//   for_mt returns only when all layers are updated, no search can overlap
+		for_mt(minPathTypeUpdate, maxPathTypeUpdate, [&](const int pathTypeUpdate) {
 			ExecQueuedNodeLayerUpdates(pathTypeUpdate, !pathSearches[pathTypeUpdate].empty());
-			#endif
+		});
+		#endif
+
+		for (unsigned int pathTypeUpdate = minPathTypeUpdate; pathTypeUpdate < maxPathTypeUpdate; pathTypeUpdate++) {
+			ScheduleQueuedSearches(pathTypeUpdate);
+		}
 
+		for_mt(minPathTypeUpdate, maxPathTypeUpdate, [&](const int pathTypeUpdate) {
 			ExecuteQueuedSearches(pathTypeUpdate);
+		});
+
+		for (unsigned int pathTypeUpdate = minPathTypeUpdate; pathTypeUpdate < maxPathTypeUpdate; pathTypeUpdate++) {
+			CommitQueuedSearches(pathTypeUpdate);
 		}
 
 		std::copy(numCurrExecutedSearches.begin(), numCurrExecutedSearches.end(), numPrevExecutedSearches.begin());
@@ -724,98 +747,125 @@ void QTPFS::PathManager::ThreadUpdate() {
 
 
 
-void QTPFS::PathManager::ExecuteQueuedSearches(unsigned int pathType) {
+void QTPFS::PathManager::ScheduleQueuedSearches(unsigned int pathType) {
 	NodeLayer& nodeLayer = nodeLayers[pathType];
 	PathCache& pathCache = pathCaches[pathType];
 
 	std::vector<IPathSearch*>& searches = pathSearches[pathType];
 	std::vector<IPathSearch*>::iterator searchesIt = searches.begin();
 
-	if (!searches.empty()) {
-		// execute pending searches collected via
-		// RequestPath and QueueDeadPathSearches
-		while (searchesIt != searches.end()) {
-			if (ExecuteSearch(searches, searchesIt, nodeLayer, pathCache, pathType)) {
-				searchStateOffset += NODE_STATE_OFFSET;
-			}
+	sharedPaths[pathType].clear();
+	scheduledSearches[pathType].clear();
+
+	// pick the pending searches collected via RequestPath and
+	// QueueDeadPathSearches that get to run during this update
+	while (searchesIt != searches.end()) {
+		IPathSearch* search = *searchesIt;
+		IPath* path = pathCache.GetTempPath(search->GetID());
+
+		assert(search != nullptr);
+		assert(path != nullptr);
+
+		// temp-path might have been removed already via
+		// DeletePath before we got a chance to process it
+		if (path->GetID() == 0) {
+			// ordering of still-queued searches is not relevant
+			*searchesIt = searches.back();
+			searches.pop_back();
+			delete search;
+			continue;
 		}
-	}
-}
 
-bool QTPFS::PathManager::ExecuteSearch(
-	PathSearchVect& searches,
-	PathSearchVectIt& searchesIt,
-	NodeLayer& nodeLayer,
-	PathCache& pathCache,
-	unsigned int pathType
-) {
-	IPathSearch* search = *searchesIt;
-	IPath* path = pathCache.GetTempPath(search->GetID());
+		assert(search->GetID() != 0);
+		assert(path->GetID() == search->GetID());
 
-	assert(search != nullptr);
-	assert(path != nullptr);
+		search->Initialize(&nodeLayer, &pathCache, path->GetSourcePoint(), path->GetTargetPoint(), MAP_RECTANGLE);
+		path->SetHash(search->GetHash(mapDims.mapx * mapDims.mapy, pathType));
 
-	const auto DeleteSearch = [](IPathSearch* s, PathSearchVect& v, PathSearchVectIt& it) {
-		// ordering of still-queued searches is not relevant
-		*it = v.back();
-		v.pop_back();
-		delete s;
-	};
+		bool sharedPath = false;
 
-	// temp-path might have been removed already via
-	// DeletePath before we got a chance to process it
-	if (path->GetID() == 0) {
-		DeleteSearch(search, searches, searchesIt);
-		return false;
-	}
+		#ifdef QTPFS_SEARCH_SHARED_PATHS
+		// an earlier search with the same hash will most likely provide our
+		// path, in which case we would not have been counted as a search
+		// (whether it does is only known after both have been executed)
+		sharedPath = (sharedPaths[pathType].find(path->GetHash()) != sharedPaths[pathType].end());
+		#endif
 
-	assert(search->GetID() != 0);
-	assert(path->GetID() == search->GetID());
+		#ifdef QTPFS_LIMIT_TEAM_SEARCHES
+		if (!sharedPath) {
+			const unsigned int numCurrSearches = numCurrExecutedSearches[search->GetTeam()];
+			const unsigned int numPrevSearches = numPrevExecutedSearches[search->GetTeam()];
 
-	search->Initialize(&nodeLayer, &pathCache, path->GetSourcePoint(), path->GetTargetPoint(), MAP_RECTANGLE);
-	path->SetHash(search->GetHash(mapDims.mapx * mapDims.mapy, pathType));
+			if ((numCurrSearches - numPrevSearches) >= MAX_TEAM_SEARCHES) {
+				++searchesIt; continue;
+			}
+
+			numCurrExecutedSearches[search->GetTeam()] += 1;
+		}
+		#endif
 
-	{
 		#ifdef QTPFS_SEARCH_SHARED_PATHS
-		SharedPathMap::const_iterator sharedPathsIt = sharedPaths.find(path->GetHash());
+		sharedPaths[pathType].emplace(path->GetHash(), nullptr);
+		#endif
+
+		scheduledSearches[pathType].push_back({search, path, searchStateOffset, false, false});
+		searchStateOffset += NODE_STATE_OFFSET;
+
+		*searchesIt = searches.back();
+		searches.pop_back();
+	}
+}
 
-		if (sharedPathsIt != sharedPaths.end()) {
-			if (search->SharedFinalize(sharedPathsIt->second, path)) {
-				DeleteSearch(search, searches, searchesIt);
-				return false;
+void QTPFS::PathManager::ExecuteQueuedSearches(unsigned int pathType) {
+	for (ScheduledSearch& scheduledSearch: scheduledSearches[pathType]) {
+		ExecuteSearch(scheduledSearch, pathType);
+	}
+}
+
+void QTPFS::PathManager::CommitQueuedSearches(unsigned int pathType) {
+	for (ScheduledSearch& scheduledSearch: scheduledSearches[pathType]) {
+		if (scheduledSearch.executed) {
+			if (scheduledSearch.succeeded) {
+				#ifdef QTPFS_TRACE_PATH_SEARCHES
+				pathTraces[scheduledSearch.path->GetID()] = scheduledSearch.search->GetExecutionTrace();
+				#endif
+			} else {
+				DeletePath(scheduledSearch.path->GetID());
 			}
 		}
-		#endif
 
-		#ifdef QTPFS_LIMIT_TEAM_SEARCHES
-		const unsigned int numCurrSearches = numCurrExecutedSearches[search->GetTeam()];
-		const unsigned int numPrevSearches = numPrevExecutedSearches[search->GetTeam()];
+		delete scheduledSearch.search;
+	}
 
-		if ((numCurrSearches - numPrevSearches) >= MAX_TEAM_SEARCHES) {
-			++searchesIt; return false;
-		}
+	scheduledSearches[pathType].clear();
+}
 
-		numCurrExecutedSearches[search->GetTeam()] += 1;
-		#endif
+void QTPFS::PathManager::ExecuteSearch(ScheduledSearch& scheduledSearch, unsigned int pathType) {
+	IPathSearch* search = scheduledSearch.search;
+	IPath* path = scheduledSearch.path;
+
+	#ifdef QTPFS_SEARCH_SHARED_PATHS
+	SharedPathMap::iterator sharedPathsIt = sharedPaths[pathType].find(path->GetHash());
+
+	assert(sharedPathsIt != sharedPaths[pathType].end());
+
+	if (sharedPathsIt->second != nullptr) {
+		if (search->SharedFinalize(sharedPathsIt->second, path)) {
+			return;
+		}
 	}
+	#endif
+
+	scheduledSearch.executed = true;
 
 	// removes path from temp-paths, adds it to live-paths
-	if (search->Execute(searchStateOffset, numTerrainChanges)) {
+	if ((scheduledSearch.succeeded = search->Execute(scheduledSearch.searchState, numTerrainChanges))) {
 		search->Finalize(path);
 
 		#ifdef QTPFS_SEARCH_SHARED_PATHS
-		sharedPaths[path->GetHash()] = path;
-		#endif
-
-		#ifdef QTPFS_TRACE_PATH_SEARCHES
-		pathTraces[path->GetID()] = search->GetExecutionTrace();
+		sharedPathsIt->second = path;
 		#endif
-	} else {
-		DeletePath(path->GetID());
 	}
-
-	DeleteSearch(search, searches, searchesIt);
-	return true;
 }
 
 void QTPFS::PathManager::QueueDeadPathSearches(unsigned int pathType) {
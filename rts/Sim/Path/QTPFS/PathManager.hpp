@@ -113,7 +113,9 @@ namespace QTPFS {
 		void ExecQueuedNodeLayerUpdates(unsigned int layerNum, bool flushQueue);
 		#endif
 
+		void ScheduleQueuedSearches(unsigned int pathType);
 		void ExecuteQueuedSearches(unsigned int pathType);
+		void CommitQueuedSearches(unsigned int pathType);
 		void QueueDeadPathSearches(unsigned int pathType);
 
 		unsigned int QueueSearch(
@@ -126,13 +128,18 @@ namespace QTPFS {
 			const bool synced
 		);
 
-		bool ExecuteSearch(
-			PathSearchVect& searches,
-			PathSearchVectIt& searchesIt,
-			NodeLayer& nodeLayer,
-			PathCache& pathCache,
-			unsigned int pathType
-		);
+		// a queued search picked by ScheduleQueuedSearches
+		struct ScheduledSearch {
+			IPathSearch* search;
+			IPath* path;
+
+			unsigned int searchState;
+
+			bool executed;
+			bool succeeded;
+		};
+
+		void ExecuteSearch(ScheduledSearch& scheduledSearch, unsigned int pathType);
 
 		bool IsFinalized() const { return (!nodeTrees.empty()); }
 
@@ -144,12 +151,13 @@ namespace QTPFS {
 		std::vector<QTNode*> nodeTrees;
 		std::vector<PathCache> pathCaches;
 		std::vector< std::vector<IPathSearch*> > pathSearches;
+		std::vector< std::vector<ScheduledSearch> > scheduledSearches;
 
 		spring::unordered_map<unsigned int, unsigned int> pathTypes;
 		spring::unordered_map<unsigned int, PathSearchTrace::Execution*> pathTraces;
 
-		// maps "hashes" of executed searches to the found paths
-		spring::unordered_map<std::uint64_t, IPath*> sharedPaths;
+		// maps "hashes" of executed searches to the found paths, per layer
+		std::vector<SharedPathMap> sharedPaths;
 
 		std::vector<unsigned int> numCurrExecutedSearches;
 		std::vector<unsigned int> numPrevExecutedSearches;
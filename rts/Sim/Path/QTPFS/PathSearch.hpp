@@ -3,6 +3,7 @@
 #ifndef QTPFS_PATHSEARCH_HDR
 #define QTPFS_PATHSEARCH_HDR
 
+#include <array>
 #include <vector>
 
 #include "PathDefines.hpp"
@@ -10,6 +11,7 @@
 #include "NodeHeap.hpp"
 
 #include "System/float3.h"
+#include "System/Threading/ThreadPool.h"
 
 namespace QTPFS {
 	struct PathCache;
@@ -120,6 +122,7 @@ namespace QTPFS {
 	public:
 		PathSearch(unsigned int pathSearchType)
 			: IPathSearch(pathSearchType)
+			, openNodes(NULL)
 			, nodeLayer(NULL)
 			, pathCache(NULL)
 			, searchExec(NULL)
@@ -132,7 +135,7 @@ namespace QTPFS {
 			, haveFullPath(false)
 			, havePartPath(false)
 			{}
-		~PathSearch() { openNodes.reset(); }
+		~PathSearch() { if (openNodes != NULL) openNodes->reset(); }
 
 		void Initialize(
 			NodeLayer* layer,
@@ -151,8 +154,8 @@ namespace QTPFS {
 
 		const std::uint64_t GetHash(std::uint64_t N, std::uint32_t k) const;
 
-		static void InitGlobalQueue(unsigned int n) { openNodes.reserve(n); }
-		static void FreeGlobalQueue() { openNodes.clear(); }
+		static void InitGlobalQueue(unsigned int n);
+		static void FreeGlobalQueue();
 
 	private:
 		void ResetState(INode* node);
@@ -165,9 +168,14 @@ namespace QTPFS {
 		void SmoothPath(IPath* path) const;
 		bool SmoothPathIter(IPath* path) const;
 
-		// global queue: allocated once, re-used by all searches without clear()'s
+		// global queues: allocated once, re-used by all searches without clear()'s
 		// this relies on INode::operator< to sort the INode*'s by increasing f-cost
-		static binary_heap<INode*> openNodes;
+		// searches on different layers can run concurrently, each thread has its own
+		static std::array<node_heap<INode*>, ThreadPool::MAX_THREADS> openNodeQueues;
+		static unsigned int openNodeQueueSize;
+
+		// queue of the thread running Execute
+		node_heap<INode*>* openNodes;
 
 		NodeLayer* nodeLayer;
 		PathCache* pathCache;
@@ -27,6 +27,7 @@
 #include "System/StringUtil.h"
 #include "System/EventHandler.h"
 #include "System/Exceptions.h"
+#include "System/FrameArena.h"
 #include "System/Log/ILog.h"
 #include "System/creg/STL_Map.h"
 
@@ -1360,7 +1361,7 @@ bool CBuilderCAI::IsUnitBeingReclaimed(const CUnit* unit, CUnit *friendUnit)
 {
 	bool retval = false;
 
-	std::vector<int> rm;
+	FrameVector<int> rm;
 	rm.reserve(reclaimers.size());
 
 	for (auto it = reclaimers.begin(); it != reclaimers.end(); ++it) {
@@ -1395,7 +1396,7 @@ bool CBuilderCAI::IsFeatureBeingReclaimed(int featureId, CUnit *friendUnit)
 {
 	bool retval = false;
 
-	std::vector<int> rm;
+	FrameVector<int> rm;
 	rm.reserve(featureReclaimers.size());
 
 	for (auto it = featureReclaimers.begin(); it != featureReclaimers.end(); ++it) {
@@ -1430,7 +1431,7 @@ bool CBuilderCAI::IsFeatureBeingResurrected(int featureId, CUnit *friendUnit)
 {
 	bool retval = false;
 
-	std::vector<int> rm;
+	FrameVector<int> rm;
 	rm.reserve(resurrecters.size());
 
 	for (auto it = resurrecters.begin(); it != resurrecters.end(); ++it) {
@@ -16,6 +16,7 @@ CR_REG_METADATA(CCobEngine, (
 	CR_MEMBER(sleepingThreadIDs),
 	// always null/empty when saving
 	CR_IGNORED(waitingThreadIDs),
+	CR_IGNORED(wokenThreadIDs),
 
 	CR_IGNORED(curThread),
 
@@ -23,11 +24,6 @@ CR_REG_METADATA(CCobEngine, (
 	CR_MEMBER(threadCounter)
 ))
 
-CR_BIND(CCobEngine::SleepingThread, )
-CR_REG_METADATA(CCobEngine::SleepingThread, (
-	CR_MEMBER(id),
-	CR_MEMBER(wt)
-))
 
 
 int CCobEngine::AddThread(CCobThread&& thread)
@@ -54,7 +50,7 @@ void CCobEngine::ScheduleThread(const CCobThread* thread)
 			waitingThreadIDs.push_back(thread->GetID());
 		} break;
 		case CCobThread::Sleep: {
-			sleepingThreadIDs.push(SleepingThread{thread->GetID(), thread->GetWakeTime()});
+			sleepingThreadIDs.Insert({thread->GetID(), thread->GetWakeTime()});
 		} break;
 		default: {
 			LOG_L(L_ERROR, "[COBEngine::%s] unknown state %d for thread %d", __func__, thread->GetState(), thread->GetID());
@@ -90,25 +86,20 @@ void CCobEngine::TickThread(CCobThread* thread)
 
 void CCobEngine::WakeSleepingThreads()
 {
-	// check on the sleeping threads, remove any whose owner died
-	while (!sleepingThreadIDs.empty()) {
-		CCobThread* zzzThread = GetThread((sleepingThreadIDs.top()).id);
-
-		if (zzzThread == nullptr) {
-			sleepingThreadIDs.pop();
-			continue;
-		}
+	// collect every thread whose wake-up time has passed, in wake-up order
+	sleepingThreadIDs.Advance(currentTime, wokenThreadIDs);
 
-		// not yet time to execute this thread or any subsequent sleepers
-		if (zzzThread->GetWakeTime() >= currentTime)
-			break;
+	for (const CCobSleepWheel::SleepingThread& st: wokenThreadIDs) {
+		CCobThread* zzzThread = GetThread(st.id);
 
-		// remove executing thread from the queue
-		sleepingThreadIDs.pop();
+		// check on the sleeping threads, skip any whose owner died
+		if (zzzThread == nullptr)
+			continue;
 
 		// wake up the thread and tick it (if not dead)
 		// this can quite possibly re-add the thread to <sleepingThreadIDs>
 		// again, but any thread is guaranteed to sleep for at least 1 tick
+		// so it can not show up in <wokenThreadIDs> twice
 		switch (zzzThread->GetState()) {
 			case CCobThread::Sleep: {
 				zzzThread->SetState(CCobThread::Run);
@@ -122,6 +113,8 @@ void CCobEngine::WakeSleepingThreads()
 			} break;
 		}
 	}
+
+	wokenThreadIDs.clear();
 }
 
 void CCobEngine::Tick(int deltaTime)
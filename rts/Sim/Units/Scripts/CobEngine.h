@@ -10,9 +10,9 @@
 
 #include <vector>
 
+#include "CobSleepWheel.h"
 #include "CobThread.h"
 #include "System/creg/creg_cond.h"
-#include "System/creg/STL_Queue.h"
 #include "System/creg/STL_Map.h"
 
 
@@ -25,21 +25,6 @@ class CCobEngine
 {
 	CR_DECLARE_STRUCT(CCobEngine)
 
-private:
-	struct SleepingThread {
-		CR_DECLARE_STRUCT(SleepingThread)
-
-		int id;
-		int wt;
-	};
-
-	struct CCobThreadComp: public std::binary_function<const SleepingThread&, const SleepingThread&, bool> {
-	public:
-		bool operator() (const SleepingThread& a, const SleepingThread& b) const {
-			return (a.wt > b.wt);
-		}
-	};
-
 public:
 	void Init() {
 		threadInstances.reserve(2048);
@@ -47,6 +32,7 @@ public:
 
 		runningThreadIDs.reserve(512);
 		waitingThreadIDs.reserve(512);
+		wokenThreadIDs.reserve(512);
 	}
 	void Kill() {
 		// threadInstances is never explicitly iterated, so
@@ -57,10 +43,9 @@ public:
 
 		runningThreadIDs.clear();
 		waitingThreadIDs.clear();
+		wokenThreadIDs.clear();
 
-		while (!sleepingThreadIDs.empty()) {
-			sleepingThreadIDs.pop();
-		}
+		sleepingThreadIDs.Clear();
 	}
 
 	void Tick(int deltaTime);
@@ -137,7 +122,9 @@ private:
 
 	// stores <id, waketime> pairs s.t. after waking up the ID can be checked
 	// for validity; thread owner might get removed while a thread is sleeping
-	std::priority_queue<SleepingThread, std::vector<SleepingThread>, CCobThreadComp> sleepingThreadIDs;
+	CCobSleepWheel sleepingThreadIDs;
+	// sleepers whose wake-up time has passed, drained in bulk each tick
+	std::vector<CCobSleepWheel::SleepingThread> wokenThreadIDs;
 
 	CCobThread* curThread = nullptr;
 
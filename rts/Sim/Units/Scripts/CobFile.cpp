@@ -3,6 +3,7 @@
 
 #include "Sim/Misc/GlobalConstants.h"
 #include "CobFile.h"
+#include "CobOpcodes.h"
 #include "System/FileSystem/FileHandler.h"
 #include "System/Log/ILog.h"
 #include "System/Sound/ISound.h"
@@ -199,6 +200,69 @@ CCobFile::CCobFile(CFileHandler& in, const std::string& scriptName)
 			scriptIndex[it->second] = fn;
 		}
 	}
+
+	DecodeInstructions();
+}
+
+
+void CCobFile::DecodeInstructions()
+{
+	instructions.clear();
+	instructions.resize(code.size());
+
+	for (size_t pc = 0; pc < code.size(); pc++) {
+		Instruction& instr = instructions[pc];
+
+		// unknown opcodes keep their raw value for error messages
+		instr.type = COB_INSTR_UNKNOWN;
+		instr.length = 1;
+		instr.args[0] = code[pc];
+		instr.args[1] = 0;
+		instr.args[2] = 0;
+
+		switch (code[pc]) {
+			#define COB_OPCODE_CASE(name, opcode, numOperands) \
+			case opcode: { instr.type = COB_INSTR_##name; instr.length = 1 + numOperands; } break;
+			COB_OPCODE_LIST(COB_OPCODE_CASE)
+			#undef COB_OPCODE_CASE
+			default: {
+			} break;
+		}
+
+		if ((pc + instr.length) > code.size()) {
+			instr.type = COB_INSTR_UNKNOWN;
+			instr.length = 1;
+			continue;
+		}
+
+		for (int i = 1; i < instr.length; i++) {
+			instr.args[i - 1] = code[pc + i];
+		}
+
+		switch (instr.type) {
+			case COB_INSTR_CALL:
+			case COB_INSTR_REAL_CALL:
+			case COB_INSTR_START: {
+				const int functionId = instr.args[0];
+
+				if (functionId < 0 || functionId >= int(scriptNames.size())) {
+					instr.type = COB_INSTR_UNKNOWN;
+					instr.length = 1;
+					instr.args[0] = code[pc];
+					continue;
+				}
+
+				// calls to functions named lua_* are forwarded to LuaRules
+				if (instr.type == COB_INSTR_CALL)
+					instr.type = (scriptNames[functionId].find("lua_") == 0)? COB_INSTR_LUA_CALL: COB_INSTR_REAL_CALL;
+
+				// zero-length functions are neither called nor started
+				instr.args[2] = (scriptLengths[functionId] != 0)? scriptOffsets[functionId]: -1;
+			} break;
+			default: {
+			} break;
+		}
+	}
 }
 
 
@@ -14,6 +14,15 @@ class CFileHandler;
 
 class CCobFile
 {
+public:
+	// instruction starting at some offset into <code>, with its operands
+	// read and CALL's resolved; see CobOpcodes.h for <type>
+	struct Instruction {
+		int type;
+		int length;
+		int args[3];
+	};
+
 public:
 	CCobFile(CFileHandler& in, const std::string& scriptName);
 	CCobFile(CCobFile&& f) { *this = std::move(f); }
@@ -22,6 +31,7 @@ public:
 		numStaticVars = f.numStaticVars;
 
 		code = std::move(f.code);
+		instructions = std::move(f.instructions);
 		scriptNames = std::move(f.scriptNames);
 		scriptOffsets = std::move(f.scriptOffsets);
 
@@ -38,10 +48,15 @@ public:
 
 	int GetFunctionId(const std::string& name);
 
+private:
+	void DecodeInstructions();
+
 public:
 	int numStaticVars;
 
 	std::vector<int> code;
+	// one entry per code offset, s.t. a thread can jump anywhere <code> could
+	std::vector<Instruction> instructions;
 	std::vector<std::string> scriptNames;
 	std::vector<int> scriptOffsets;
 	/// Assumes that the scripts are sorted by offset in the file
@@ -0,0 +1,97 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef COB_OPCODES_H
+#define COB_OPCODES_H
+
+// Command documentation from http://visualta.tauniverse.com/Downloads/cob-commands.txt
+// And some information from basm0.8 source (basm ops.txt)
+//
+// X(name, opcode, number of inline operands)
+#define COB_OPCODE_LIST(X)                              \
+	/* Model interaction */                             \
+	X(MOVE                , 0x10001000, 2)              \
+	X(TURN                , 0x10002000, 2)              \
+	X(SPIN                , 0x10003000, 2)              \
+	X(STOP_SPIN           , 0x10004000, 2)              \
+	X(SHOW                , 0x10005000, 1)              \
+	X(HIDE                , 0x10006000, 1)              \
+	X(CACHE               , 0x10007000, 1)              \
+	X(DONT_CACHE          , 0x10008000, 1)              \
+	X(MOVE_NOW            , 0x1000B000, 2)              \
+	X(TURN_NOW            , 0x1000C000, 2)              \
+	X(SHADE               , 0x1000D000, 1)              \
+	X(DONT_SHADE          , 0x1000E000, 1)              \
+	X(EMIT_SFX            , 0x1000F000, 1)              \
+	/* Blocking operations */                           \
+	X(WAIT_TURN           , 0x10011000, 2)              \
+	X(WAIT_MOVE           , 0x10012000, 2)              \
+	X(SLEEP               , 0x10013000, 0)              \
+	/* Stack manipulation */                            \
+	X(PUSH_CONSTANT       , 0x10021001, 1)              \
+	X(PUSH_LOCAL_VAR      , 0x10021002, 1)              \
+	X(PUSH_STATIC         , 0x10021004, 1)              \
+	X(CREATE_LOCAL_VAR    , 0x10022000, 0)              \
+	X(POP_LOCAL_VAR       , 0x10023002, 1)              \
+	X(POP_STATIC          , 0x10023004, 1)              \
+	X(POP_STACK           , 0x10024000, 0) /* Not sure what this is supposed to do */ \
+	/* Arithmetic operations */                         \
+	X(ADD                 , 0x10031000, 0)              \
+	X(SUB                 , 0x10032000, 0)              \
+	X(MUL                 , 0x10033000, 0)              \
+	X(DIV                 , 0x10034000, 0)              \
+	X(MOD                 , 0x10034001, 0) /* spring specific */ \
+	X(BITWISE_AND         , 0x10035000, 0)              \
+	X(BITWISE_OR          , 0x10036000, 0)              \
+	X(BITWISE_XOR         , 0x10037000, 0)              \
+	X(BITWISE_NOT         , 0x10038000, 0)              \
+	/* Native function calls */                         \
+	X(RAND                , 0x10041000, 0)              \
+	X(GET_UNIT_VALUE      , 0x10042000, 0)              \
+	X(GET                 , 0x10043000, 0)              \
+	/* Comparison */                                    \
+	X(SET_LESS            , 0x10051000, 0)              \
+	X(SET_LESS_OR_EQUAL   , 0x10052000, 0)              \
+	X(SET_GREATER         , 0x10053000, 0)              \
+	X(SET_GREATER_OR_EQUAL, 0x10054000, 0)              \
+	X(SET_EQUAL           , 0x10055000, 0)              \
+	X(SET_NOT_EQUAL       , 0x10056000, 0)              \
+	X(LOGICAL_AND         , 0x10057000, 0)              \
+	X(LOGICAL_OR          , 0x10058000, 0)              \
+	X(LOGICAL_XOR         , 0x10059000, 0)              \
+	X(LOGICAL_NOT         , 0x1005A000, 0)              \
+	/* Flow control */                                  \
+	X(START               , 0x10061000, 2)              \
+	X(CALL                , 0x10062000, 2) /* resolved to REAL_CALL or LUA_CALL when decoded */ \
+	X(REAL_CALL           , 0x10062001, 2) /* spring custom */ \
+	X(LUA_CALL            , 0x10062002, 2) /* spring custom */ \
+	X(JUMP                , 0x10064000, 1)              \
+	X(RETURN              , 0x10065000, 0)              \
+	X(JUMP_NOT_EQUAL      , 0x10066000, 1)              \
+	X(SIGNAL              , 0x10067000, 0)              \
+	X(SET_SIGNAL_MASK     , 0x10068000, 0)              \
+	/* Piece destruction */                             \
+	X(EXPLODE             , 0x10071000, 1)              \
+	X(PLAY_SOUND          , 0x10072000, 1)              \
+	/* Special functions */                             \
+	X(SET                 , 0x10082000, 0)              \
+	X(ATTACH              , 0x10083000, 0)              \
+	X(DROP                , 0x10084000, 0)
+
+
+// raw opcodes as stored in CCobFile::code
+namespace CobOpcodes {
+	#define COB_OPCODE_VALUE(name, opcode, numOperands) constexpr int name = opcode;
+	COB_OPCODE_LIST(COB_OPCODE_VALUE)
+	#undef COB_OPCODE_VALUE
+}
+
+// dense indices used by the pre-decoded instruction stream
+enum CobInstructionType {
+	#define COB_OPCODE_INDEX(name, opcode, numOperands) COB_INSTR_##name,
+	COB_OPCODE_LIST(COB_OPCODE_INDEX)
+	#undef COB_OPCODE_INDEX
+	COB_INSTR_UNKNOWN,
+	COB_INSTR_COUNT
+};
+
+#endif // COB_OPCODES_H
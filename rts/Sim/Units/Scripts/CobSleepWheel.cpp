@@ -0,0 +1,130 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cassert>
+
+#include "CobSleepWheel.h"
+
+
+CR_BIND(CCobSleepWheel, )
+
+CR_REG_METADATA(CCobSleepWheel, (
+	CR_MEMBER(slots),
+	CR_MEMBER(overflow),
+	CR_MEMBER(pastDue),
+	// only used within Cascade
+	CR_IGNORED(cascaded),
+
+	CR_MEMBER(baseTime),
+	CR_MEMBER(numSleepers)
+))
+
+CR_BIND(CCobSleepWheel::SleepingThread, )
+CR_REG_METADATA(CCobSleepWheel::SleepingThread, (
+	CR_MEMBER(id),
+	CR_MEMBER(wt)
+))
+
+
+void CCobSleepWheel::Clear()
+{
+	// keep the inner vectors' capacity between reloads
+	slots.resize(NUM_SLOTS);
+
+	for (std::vector<SleepingThread>& slot: slots) {
+		slot.clear();
+	}
+
+	overflow.clear();
+	pastDue.clear();
+	cascaded.clear();
+
+	baseTime = 0;
+	numSleepers = 0;
+}
+
+
+void CCobSleepWheel::Insert(const SleepingThread& st)
+{
+	numSleepers += 1;
+
+	if (st.wt < baseTime) {
+		pastDue.push_back(st);
+		return;
+	}
+
+	for (int level = 0; level < NUM_LEVELS; level++) {
+		const int shift = LevelShift(level + 1);
+
+		// lowest level whose current range contains the wake-up time
+		if ((st.wt >> shift) != (baseTime >> shift))
+			continue;
+
+		slots[SlotIndex(level, st.wt)].push_back(st);
+		return;
+	}
+
+	overflow.push_back(st);
+}
+
+
+void CCobSleepWheel::Advance(int time, std::vector<SleepingThread>& woken)
+{
+	if (!pastDue.empty()) {
+		std::stable_sort(pastDue.begin(), pastDue.end(), [](const SleepingThread& a, const SleepingThread& b) { return (a.wt < b.wt); });
+		woken.insert(woken.end(), pastDue.begin(), pastDue.end());
+
+		numSleepers -= pastDue.size();
+		pastDue.clear();
+	}
+
+	while (baseTime < time && numSleepers > 0) {
+		std::vector<SleepingThread>& slot = slots[SlotIndex(0, baseTime)];
+
+		woken.insert(woken.end(), slot.begin(), slot.end());
+
+		numSleepers -= slot.size();
+		slot.clear();
+
+		if (((++baseTime) & LevelMask(0)) == 0)
+			Cascade();
+	}
+
+	// nothing left to wake, jump straight to <time>; the wheel is empty
+	// so the new base only has to be block-aligned for future inserts
+	if (baseTime < time) {
+		assert(numSleepers == 0);
+		baseTime = time;
+	}
+}
+
+
+void CCobSleepWheel::Cascade()
+{
+	// called whenever <baseTime> enters a new level-0 block; higher levels
+	// go first so their threads can trickle down in the same call
+	if ((baseTime & ((1 << LevelShift(NUM_LEVELS)) - 1)) == 0)
+		Redistribute(overflow);
+
+	for (int level = NUM_LEVELS - 1; level > 0; level--) {
+		if ((baseTime & ((1 << LevelShift(level)) - 1)) != 0)
+			continue;
+
+		Redistribute(slots[SlotIndex(level, baseTime)]);
+	}
+}
+
+void CCobSleepWheel::Redistribute(std::vector<SleepingThread>& slot)
+{
+	if (slot.empty())
+		return;
+
+	cascaded.clear();
+	cascaded.swap(slot);
+
+	numSleepers -= cascaded.size();
+
+	for (const SleepingThread& st: cascaded) {
+		Insert(st);
+	}
+}
@@ -0,0 +1,77 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef COB_SLEEP_WHEEL_H
+#define COB_SLEEP_WHEEL_H
+
+#include <vector>
+
+#include "System/creg/creg_cond.h"
+
+/*
+ * Hierarchical timing wheel holding the sleeping COB threads, keyed on
+ * their wake-up time (in milliseconds of CCobEngine time).
+ *
+ * Level 0 has one slot per millisecond of the current 256ms block, each
+ * higher level covers 64 blocks of the level below; threads sleeping
+ * beyond the top level go into an overflow list. A slot is only moved
+ * down (cascaded) once the wheel reaches its range, at which point all
+ * of its target slots are still empty, so every slot stays in insertion
+ * order. Threads are therefore woken by ascending wake-up time and, for
+ * equal times, in the order they went to sleep.
+ */
+class CCobSleepWheel
+{
+	CR_DECLARE_STRUCT(CCobSleepWheel)
+
+public:
+	struct SleepingThread {
+		CR_DECLARE_STRUCT(SleepingThread)
+
+		int id;
+		int wt;
+	};
+
+public:
+	CCobSleepWheel() { Clear(); }
+
+	void Clear();
+	void Insert(const SleepingThread& st);
+
+	// moves every thread with a wake-up time before <time> into <woken>
+	void Advance(int time, std::vector<SleepingThread>& woken);
+
+	size_t Size() const { return numSleepers; }
+	bool Empty() const { return (numSleepers == 0); }
+
+private:
+	void Cascade();
+	void Redistribute(std::vector<SleepingThread>& slot);
+
+	static constexpr int NUM_LEVELS = 4;
+	static constexpr int BASE_BITS = 8;
+	static constexpr int LEVEL_BITS = 6;
+
+	static constexpr int BASE_SLOTS = 1 << BASE_BITS;
+	static constexpr int LEVEL_SLOTS = 1 << LEVEL_BITS;
+	static constexpr int NUM_SLOTS = BASE_SLOTS + LEVEL_SLOTS * (NUM_LEVELS - 1);
+
+	// time-bit at which level <n> starts (level NUM_LEVELS is the overflow list)
+	static constexpr int LevelShift(int n) { return ((n == 0)? 0: (BASE_BITS + LEVEL_BITS * (n - 1))); }
+	static constexpr int LevelMask(int n) { return ((n == 0)? (BASE_SLOTS - 1): (LEVEL_SLOTS - 1)); }
+	static constexpr int LevelOffset(int n) { return ((n == 0)? 0: (BASE_SLOTS + LEVEL_SLOTS * (n - 1))); }
+
+	int SlotIndex(int level, int time) const { return (LevelOffset(level) + ((time >> LevelShift(level)) & LevelMask(level))); }
+
+private:
+	std::vector< std::vector<SleepingThread> > slots;
+	std::vector<SleepingThread> overflow;
+	// threads that were scheduled to wake before <baseTime> (negative sleeps)
+	std::vector<SleepingThread> pastDue;
+	std::vector<SleepingThread> cascaded;
+
+	// every thread with a wake-up time before this has been woken
+	int baseTime = 0;
+	int numSleepers = 0;
+};
+
+#endif // COB_SLEEP_WHEEL_H
@@ -5,6 +5,7 @@
 #include "CobFile.h"
 #include "CobInstance.h"
 #include "CobEngine.h"
+#include "CobOpcodes.h"
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/GlobalSynced.h"
 
@@ -185,86 +186,6 @@ void CCobThread::InitStack(unsigned int n, CCobThread* t)
 
 
 
-// Command documentation from http://visualta.tauniverse.com/Downloads/cob-commands.txt
-// And some information from basm0.8 source (basm ops.txt)
-
-// Model interaction
-constexpr int MOVE       = 0x10001000;
-constexpr int TURN       = 0x10002000;
-constexpr int SPIN       = 0x10003000;
-constexpr int STOP_SPIN  = 0x10004000;
-constexpr int SHOW       = 0x10005000;
-constexpr int HIDE       = 0x10006000;
-constexpr int CACHE      = 0x10007000;
-constexpr int DONT_CACHE = 0x10008000;
-constexpr int MOVE_NOW   = 0x1000B000;
-constexpr int TURN_NOW   = 0x1000C000;
-constexpr int SHADE      = 0x1000D000;
-constexpr int DONT_SHADE = 0x1000E000;
-constexpr int EMIT_SFX   = 0x1000F000;
-
-// Blocking operations
-constexpr int WAIT_TURN  = 0x10011000;
-constexpr int WAIT_MOVE  = 0x10012000;
-constexpr int SLEEP      = 0x10013000;
-
-// Stack manipulation
-constexpr int PUSH_CONSTANT    = 0x10021001;
-constexpr int PUSH_LOCAL_VAR   = 0x10021002;
-constexpr int PUSH_STATIC      = 0x10021004;
-constexpr int CREATE_LOCAL_VAR = 0x10022000;
-constexpr int POP_LOCAL_VAR    = 0x10023002;
-constexpr int POP_STATIC       = 0x10023004;
-constexpr int POP_STACK        = 0x10024000; ///< Not sure what this is supposed to do
-
-// Arithmetic operations
-constexpr int ADD         = 0x10031000;
-constexpr int SUB         = 0x10032000;
-constexpr int MUL         = 0x10033000;
-constexpr int DIV         = 0x10034000;
-constexpr int MOD		  = 0x10034001; ///< spring specific
-constexpr int BITWISE_AND = 0x10035000;
-constexpr int BITWISE_OR  = 0x10036000;
-constexpr int BITWISE_XOR = 0x10037000;
-constexpr int BITWISE_NOT = 0x10038000;
-
-// Native function calls
-constexpr int RAND           = 0x10041000;
-constexpr int GET_UNIT_VALUE = 0x10042000;
-constexpr int GET            = 0x10043000;
-
-// Comparison
-constexpr int SET_LESS             = 0x10051000;
-constexpr int SET_LESS_OR_EQUAL    = 0x10052000;
-constexpr int SET_GREATER          = 0x10053000;
-constexpr int SET_GREATER_OR_EQUAL = 0x10054000;
-constexpr int SET_EQUAL            = 0x10055000;
-constexpr int SET_NOT_EQUAL        = 0x10056000;
-constexpr int LOGICAL_AND          = 0x10057000;
-constexpr int LOGICAL_OR           = 0x10058000;
-constexpr int LOGICAL_XOR          = 0x10059000;
-constexpr int LOGICAL_NOT          = 0x1005A000;
-
-// Flow control
-constexpr int START           = 0x10061000;
-constexpr int CALL            = 0x10062000; ///< converted when executed
-constexpr int REAL_CALL       = 0x10062001; ///< spring custom
-constexpr int LUA_CALL        = 0x10062002; ///< spring custom
-constexpr int JUMP            = 0x10064000;
-constexpr int RETURN          = 0x10065000;
-constexpr int JUMP_NOT_EQUAL  = 0x10066000;
-constexpr int SIGNAL          = 0x10067000;
-constexpr int SET_SIGNAL_MASK = 0x10068000;
-
-// Piece destruction
-constexpr int EXPLODE    = 0x10071000;
-constexpr int PLAY_SOUND = 0x10072000;
-
-// Special functions
-constexpr int SET    = 0x10082000;
-constexpr int ATTACH = 0x10083000;
-constexpr int DROP   = 0x10084000;
-
 // Indices for SET, GET, and GET_UNIT_VALUE for LUA return values
 #define LUA0 110 // (LUA0 returns the lua call status, 0 or 1)
 #define LUA1 111
@@ -277,80 +198,77 @@ constexpr int DROP   = 0x10084000;
 #define LUA8 118
 #define LUA9 119
 
-#define GET_LONG_PC() (cobFile->code[pc++])
-
-
 #if 0
 static const char* GetOpcodeName(int opcode)
 {
 	switch (opcode) {
-		case MOVE: return "move";
-		case TURN: return "turn";
-		case SPIN: return "spin";
-		case STOP_SPIN: return "stop-spin";
-		case SHOW: return "show";
-		case HIDE: return "hide";
-		case CACHE: return "cache";
-		case DONT_CACHE: return "dont-cache";
-		case TURN_NOW: return "turn-now";
-		case MOVE_NOW: return "move-now";
-		case SHADE: return "shade";
-		case DONT_SHADE: return "dont-shade";
-		case EMIT_SFX: return "sfx";
-
-		case WAIT_TURN: return "wait-for-turn";
-		case WAIT_MOVE: return "wait-for-move";
-		case SLEEP: return "sleep";
-
-		case PUSH_CONSTANT: return "pushc";
-		case PUSH_LOCAL_VAR: return "pushl";
-		case PUSH_STATIC: return "pushs";
-		case CREATE_LOCAL_VAR: return "clv";
-		case POP_LOCAL_VAR: return "popl";
-		case POP_STATIC: return "pops";
-		case POP_STACK: return "pop-stack";
-
-		case ADD: return "add";
-		case SUB: return "sub";
-		case MUL: return "mul";
-		case DIV: return "div";
-		case MOD: return "mod";
-		case BITWISE_AND: return "and";
-		case BITWISE_OR: return "or";
-		case BITWISE_XOR: return "xor";
-		case BITWISE_NOT: return "not";
-
-		case RAND: return "rand";
-		case GET_UNIT_VALUE: return "getuv";
-		case GET: return "get";
-
-		case SET_LESS: return "setl";
-		case SET_LESS_OR_EQUAL: return "setle";
-		case SET_GREATER: return "setg";
-		case SET_GREATER_OR_EQUAL: return "setge";
-		case SET_EQUAL: return "sete";
-		case SET_NOT_EQUAL: return "setne";
-		case LOGICAL_AND: return "land";
-		case LOGICAL_OR: return "lor";
-		case LOGICAL_XOR: return "lxor";
-		case LOGICAL_NOT: return "neg";
-
-		case START: return "start";
-		case CALL: return "call";
-		case REAL_CALL: return "call";
-		case LUA_CALL: return "lua_call";
-		case JUMP: return "jmp";
-		case RETURN: return "return";
-		case JUMP_NOT_EQUAL: return "jne";
-		case SIGNAL: return "signal";
-		case SET_SIGNAL_MASK: return "mask";
-
-		case EXPLODE: return "explode";
-		case PLAY_SOUND: return "play-sound";
-
-		case SET: return "set";
-		case ATTACH: return "attach";
-		case DROP: return "drop";
+		case CobOpcodes::MOVE: return "move";
+		case CobOpcodes::TURN: return "turn";
+		case CobOpcodes::SPIN: return "spin";
+		case CobOpcodes::STOP_SPIN: return "stop-spin";
+		case CobOpcodes::SHOW: return "show";
+		case CobOpcodes::HIDE: return "hide";
+		case CobOpcodes::CACHE: return "cache";
+		case CobOpcodes::DONT_CACHE: return "dont-cache";
+		case CobOpcodes::TURN_NOW: return "turn-now";
+		case CobOpcodes::MOVE_NOW: return "move-now";
+		case CobOpcodes::SHADE: return "shade";
+		case CobOpcodes::DONT_SHADE: return "dont-shade";
+		case CobOpcodes::EMIT_SFX: return "sfx";
+
+		case CobOpcodes::WAIT_TURN: return "wait-for-turn";
+		case CobOpcodes::WAIT_MOVE: return "wait-for-move";
+		case CobOpcodes::SLEEP: return "sleep";
+
+		case CobOpcodes::PUSH_CONSTANT: return "pushc";
+		case CobOpcodes::PUSH_LOCAL_VAR: return "pushl";
+		case CobOpcodes::PUSH_STATIC: return "pushs";
+		case CobOpcodes::CREATE_LOCAL_VAR: return "clv";
+		case CobOpcodes::POP_LOCAL_VAR: return "popl";
+		case CobOpcodes::POP_STATIC: return "pops";
+		case CobOpcodes::POP_STACK: return "pop-stack";
+
+		case CobOpcodes::ADD: return "add";
+		case CobOpcodes::SUB: return "sub";
+		case CobOpcodes::MUL: return "mul";
+		case CobOpcodes::DIV: return "div";
+		case CobOpcodes::MOD: return "mod";
+		case CobOpcodes::BITWISE_AND: return "and";
+		case CobOpcodes::BITWISE_OR: return "or";
+		case CobOpcodes::BITWISE_XOR: return "xor";
+		case CobOpcodes::BITWISE_NOT: return "not";
+
+		case CobOpcodes::RAND: return "rand";
+		case CobOpcodes::GET_UNIT_VALUE: return "getuv";
+		case CobOpcodes::GET: return "get";
+
+		case CobOpcodes::SET_LESS: return "setl";
+		case CobOpcodes::SET_LESS_OR_EQUAL: return "setle";
+		case CobOpcodes::SET_GREATER: return "setg";
+		case CobOpcodes::SET_GREATER_OR_EQUAL: return "setge";
+		case CobOpcodes::SET_EQUAL: return "sete";
+		case CobOpcodes::SET_NOT_EQUAL: return "setne";
+		case CobOpcodes::LOGICAL_AND: return "land";
+		case CobOpcodes::LOGICAL_OR: return "lor";
+		case CobOpcodes::LOGICAL_XOR: return "lxor";
+		case CobOpcodes::LOGICAL_NOT: return "neg";
+
+		case CobOpcodes::START: return "start";
+		case CobOpcodes::CALL: return "call";
+		case CobOpcodes::REAL_CALL: return "call";
+		case CobOpcodes::LUA_CALL: return "lua_call";
+		case CobOpcodes::JUMP: return "jmp";
+		case CobOpcodes::RETURN: return "return";
+		case CobOpcodes::JUMP_NOT_EQUAL: return "jne";
+		case CobOpcodes::SIGNAL: return "signal";
+		case CobOpcodes::SET_SIGNAL_MASK: return "mask";
+
+		case CobOpcodes::EXPLODE: return "explode";
+		case CobOpcodes::PLAY_SOUND: return "play-sound";
+
+		case CobOpcodes::SET: return "set";
+		case CobOpcodes::ATTACH: return "attach";
+		case CobOpcodes::DROP: return "drop";
 	}
 
 	return "unknown";
@@ -379,39 +297,65 @@ bool CCobThread::Tick()
 
 	state = Run;
 
+	// <pc> keeps pointing into the raw code, so call-stack return addresses,
+	// savegames and error messages are the same as for undecoded execution;
+	// it is advanced past an instruction's operands before running it
+	const CCobFile::Instruction* instrs = cobFile->instructions.data();
+	const CCobFile::Instruction* instr = nullptr;
+
 	int r1, r2, r3, r4, r5, r6;
 
+#if defined(__GNUC__)
+	// direct-threaded dispatch: every handler jumps straight to the next one
+	static const void* handlers[COB_INSTR_COUNT] = {
+		#define COB_OPCODE_LABEL(name, opcode, numOperands) &&instr_##name,
+		COB_OPCODE_LIST(COB_OPCODE_LABEL)
+		#undef COB_OPCODE_LABEL
+		&&instr_UNKNOWN,
+	};
+
+	#define COB_INSTR(name) instr_##name:
+	#define COB_NEXT()                      \
+		if (state != Run)                   \
+			goto done;                      \
+		instr = &instrs[pc];                \
+		pc += instr->length;                \
+		goto *handlers[instr->type];
+
+	COB_NEXT()
+	for (;;) {
+		{
+#else
+	#define COB_INSTR(name) case COB_INSTR_##name:
+	#define COB_NEXT() continue;
+
 	while (state == Run) {
-		const int opcode = GET_LONG_PC();
-
-		switch (opcode) {
-			case PUSH_CONSTANT: {
-				r1 = GET_LONG_PC();
-				dataStack.push_back(r1);
-			} break;
-			case SLEEP: {
+		instr = &instrs[pc];
+		pc += instr->length;
+
+		switch (instr->type) {
+#endif
+			COB_INSTR(PUSH_CONSTANT) {
+				dataStack.push_back(instr->args[0]);
+			} COB_NEXT()
+			COB_INSTR(SLEEP) {
 				r1 = POP();
 				wakeTime = cobEngine->GetCurrentTime() + r1;
 				state = Sleep;
 
 				cobEngine->ScheduleThread(this);
 				return true;
-			} break;
-			case SPIN: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
+			}
+			COB_INSTR(SPIN) {
 				r3 = POP();         // speed
 				r4 = POP();         // accel
-				cobInst->Spin(r1, r2, r3, r4);
-			} break;
-			case STOP_SPIN: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
+				cobInst->Spin(instr->args[0], instr->args[1], r3, r4);
+			} COB_NEXT()
+			COB_INSTR(STOP_SPIN) {
 				r3 = POP();         // decel
-
-				cobInst->StopSpin(r1, r2, r3);
-			} break;
-			case RETURN: {
+				cobInst->StopSpin(instr->args[0], instr->args[1], r3);
+			} COB_NEXT()
+			COB_INSTR(RETURN) {
 				retCode = POP();
 
 				if (callStack.back().returnAddr == -1) {
@@ -430,276 +374,241 @@ bool CCobThread::Tick()
 				}
 
 				callStack.pop_back();
-			} break;
-
-
-			case SHADE: {
-				r1 = GET_LONG_PC();
-			} break;
-			case DONT_SHADE: {
-				r1 = GET_LONG_PC();
-			} break;
-			case CACHE: {
-				r1 = GET_LONG_PC();
-			} break;
-			case DONT_CACHE: {
-				r1 = GET_LONG_PC();
-			} break;
-
-
-			case CALL: {
-				r1 = GET_LONG_PC();
-				pc--;
-
-				if (cobFile->scriptNames[r1].find("lua_") == 0) {
-					cobFile->code[pc - 1] = LUA_CALL;
-					LuaCall();
-					break;
-				}
+			} COB_NEXT()
 
-				cobFile->code[pc - 1] = REAL_CALL;
 
-				// fall-through
-			}
-			case REAL_CALL: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
+			COB_INSTR(SHADE) {
+			} COB_NEXT()
+			COB_INSTR(DONT_SHADE) {
+			} COB_NEXT()
+			COB_INSTR(CACHE) {
+			} COB_NEXT()
+			COB_INSTR(DONT_CACHE) {
+			} COB_NEXT()
+
 
+			COB_INSTR(REAL_CALL) {
 				// do not call zero-length functions
-				if (cobFile->scriptLengths[r1] == 0)
-					break;
-
-				CallInfo ci;
-				ci.functionId = r1;
-				ci.returnAddr = pc;
-				ci.stackTop = dataStack.size() - r2;
-				callStack.push_back(ci);
-				paramCount = r2;
-
-				// call cobFile->scriptNames[r1]
-				pc = cobFile->scriptOffsets[r1];
-			} break;
-			case LUA_CALL: {
-				LuaCall();
-			} break;
-
-
-			case POP_STATIC: {
-				r1 = GET_LONG_PC();
+				if (instr->args[2] != -1) {
+					CallInfo ci;
+					ci.functionId = instr->args[0];
+					ci.returnAddr = pc;
+					ci.stackTop = dataStack.size() - instr->args[1];
+					callStack.push_back(ci);
+					paramCount = instr->args[1];
+
+					// call cobFile->scriptNames[functionId]
+					pc = instr->args[2];
+				}
+			} COB_NEXT()
+			COB_INSTR(LUA_CALL) {
+				LuaCall(instr->args[0], instr->args[1]);
+			} COB_NEXT()
+
+
+			COB_INSTR(POP_STATIC) {
+				r1 = instr->args[0];
 				r2 = POP();
 
 				if (static_cast<size_t>(r1) < cobInst->staticVars.size())
 					cobInst->staticVars[r1] = r2;
-			} break;
-			case POP_STACK: {
+			} COB_NEXT()
+			COB_INSTR(POP_STACK) {
 				POP();
-			} break;
+			} COB_NEXT()
 
 
-			case START: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
+			COB_INSTR(START) {
+				if (instr->args[2] != -1) {
+					CCobThread t(cobInst);
 
-				if (cobFile->scriptLengths[r1] == 0)
-					break;
+					t.SetID(cobEngine->GenThreadID());
+					t.InitStack(instr->args[1], this);
+					t.Start(instr->args[0], signalMask, {}, true);
 
+					// calling AddThread directly might move <this>, defer it
+					cobEngine->QueueAddThread(std::move(t));
+				}
+			} COB_NEXT()
 
-				CCobThread t(cobInst);
-
-				t.SetID(cobEngine->GenThreadID());
-				t.InitStack(r2, this);
-				t.Start(r1, signalMask, {}, true);
-
-				// calling AddThread directly might move <this>, defer it
-				cobEngine->QueueAddThread(std::move(t));
-			} break;
-
-			case CREATE_LOCAL_VAR: {
+			COB_INSTR(CREATE_LOCAL_VAR) {
 				if (paramCount == 0) {
 					dataStack.push_back(0);
 				} else {
 					paramCount--;
 				}
-			} break;
-			case GET_UNIT_VALUE: {
+			} COB_NEXT()
+			COB_INSTR(GET_UNIT_VALUE) {
 				r1 = POP();
+
 				if ((r1 >= LUA0) && (r1 <= LUA9)) {
 					dataStack.push_back(luaArgs[r1 - LUA0]);
-					break;
+				} else {
+					dataStack.push_back(cobInst->GetUnitVal(r1, 0, 0, 0, 0));
 				}
-				r1 = cobInst->GetUnitVal(r1, 0, 0, 0, 0);
-				dataStack.push_back(r1);
-			} break;
+			} COB_NEXT()
 
 
-			case JUMP_NOT_EQUAL: {
-				r1 = GET_LONG_PC();
+			COB_INSTR(JUMP_NOT_EQUAL) {
 				r2 = POP();
 
 				if (r2 == 0)
-					pc = r1;
+					pc = instr->args[0];
 
-			} break;
-			case JUMP: {
-				r1 = GET_LONG_PC();
+			} COB_NEXT()
+			COB_INSTR(JUMP) {
 				// this seem to be an error in the docs..
 				//r2 = cobFile->scriptOffsets[callStack.back().functionId] + r1;
-				pc = r1;
-			} break;
+				pc = instr->args[0];
+			} COB_NEXT()
 
 
-			case POP_LOCAL_VAR: {
-				r1 = GET_LONG_PC();
+			COB_INSTR(POP_LOCAL_VAR) {
 				r2 = POP();
-				dataStack[callStack.back().stackTop + r1] = r2;
-			} break;
-			case PUSH_LOCAL_VAR: {
-				r1 = GET_LONG_PC();
-				r2 = dataStack[callStack.back().stackTop + r1];
+				dataStack[callStack.back().stackTop + instr->args[0]] = r2;
+			} COB_NEXT()
+			COB_INSTR(PUSH_LOCAL_VAR) {
+				r2 = dataStack[callStack.back().stackTop + instr->args[0]];
 				dataStack.push_back(r2);
-			} break;
+			} COB_NEXT()
 
 
-			case BITWISE_AND: {
+			COB_INSTR(BITWISE_AND) {
 				r1 = POP();
 				r2 = POP();
 				dataStack.push_back(r1 & r2);
-			} break;
-			case BITWISE_OR: {
+			} COB_NEXT()
+			COB_INSTR(BITWISE_OR) {
 				r1 = POP();
 				r2 = POP();
 				dataStack.push_back(r1 | r2);
-			} break;
-			case BITWISE_XOR: {
+			} COB_NEXT()
+			COB_INSTR(BITWISE_XOR) {
 				r1 = POP();
 				r2 = POP();
 				dataStack.push_back(r1 ^ r2);
-			} break;
-			case BITWISE_NOT: {
+			} COB_NEXT()
+			COB_INSTR(BITWISE_NOT) {
 				r1 = POP();
 				dataStack.push_back(~r1);
-			} break;
+			} COB_NEXT()
 
-			case EXPLODE: {
-				r1 = GET_LONG_PC();
+			COB_INSTR(EXPLODE) {
 				r2 = POP();
-				cobInst->Explode(r1, r2);
-			} break;
+				cobInst->Explode(instr->args[0], r2);
+			} COB_NEXT()
 
-			case PLAY_SOUND: {
-				r1 = GET_LONG_PC();
+			COB_INSTR(PLAY_SOUND) {
 				r2 = POP();
-				cobInst->PlayUnitSound(r1, r2);
-			} break;
+				cobInst->PlayUnitSound(instr->args[0], r2);
+			} COB_NEXT()
 
-			case PUSH_STATIC: {
-				r1 = GET_LONG_PC();
+			COB_INSTR(PUSH_STATIC) {
+				r1 = instr->args[0];
 
 				if (static_cast<size_t>(r1) < cobInst->staticVars.size())
 					dataStack.push_back(cobInst->staticVars[r1]);
-			} break;
+			} COB_NEXT()
 
-			case SET_NOT_EQUAL: {
+			COB_INSTR(SET_NOT_EQUAL) {
 				r1 = POP();
 				r2 = POP();
 
 				dataStack.push_back(int(r1 != r2));
-			} break;
-			case SET_EQUAL: {
+			} COB_NEXT()
+			COB_INSTR(SET_EQUAL) {
 				r1 = POP();
 				r2 = POP();
 
 				dataStack.push_back(int(r1 == r2));
-			} break;
+			} COB_NEXT()
 
-			case SET_LESS: {
+			COB_INSTR(SET_LESS) {
 				r2 = POP();
 				r1 = POP();
 
 				dataStack.push_back(int(r1 < r2));
-			} break;
-			case SET_LESS_OR_EQUAL: {
+			} COB_NEXT()
+			COB_INSTR(SET_LESS_OR_EQUAL) {
 				r2 = POP();
 				r1 = POP();
 
 				dataStack.push_back(int(r1 <= r2));
-			} break;
+			} COB_NEXT()
 
-			case SET_GREATER: {
+			COB_INSTR(SET_GREATER) {
 				r2 = POP();
 				r1 = POP();
 
 				dataStack.push_back(int(r1 > r2));
-			} break;
-			case SET_GREATER_OR_EQUAL: {
+			} COB_NEXT()
+			COB_INSTR(SET_GREATER_OR_EQUAL) {
 				r2 = POP();
 				r1 = POP();
 
 				dataStack.push_back(int(r1 >= r2));
-			} break;
+			} COB_NEXT()
 
-			case RAND: {
+			COB_INSTR(RAND) {
 				r2 = POP();
 				r1 = POP();
 				r3 = gsRNG.NextInt(r2 - r1 + 1) + r1;
 				dataStack.push_back(r3);
-			} break;
-			case EMIT_SFX: {
+			} COB_NEXT()
+			COB_INSTR(EMIT_SFX) {
 				r1 = POP();
-				r2 = GET_LONG_PC();
-				cobInst->EmitSfx(r1, r2);
-			} break;
-			case MUL: {
+				cobInst->EmitSfx(r1, instr->args[0]);
+			} COB_NEXT()
+			COB_INSTR(MUL) {
 				r1 = POP();
 				r2 = POP();
 				dataStack.push_back(r1 * r2);
-			} break;
+			} COB_NEXT()
 
 
-			case SIGNAL: {
+			COB_INSTR(SIGNAL) {
 				r1 = POP();
 				cobInst->Signal(r1);
-			} break;
-			case SET_SIGNAL_MASK: {
+			} COB_NEXT()
+			COB_INSTR(SET_SIGNAL_MASK) {
 				r1 = POP();
 				signalMask = r1;
-			} break;
+			} COB_NEXT()
 
 
-			case TURN: {
+			COB_INSTR(TURN) {
 				r2 = POP();
 				r1 = POP();
-				r3 = GET_LONG_PC(); // piece
-				r4 = GET_LONG_PC(); // axis
 
-				cobInst->Turn(r3, r4, r1, r2);
-			} break;
-			case GET: {
+				cobInst->Turn(instr->args[0], instr->args[1], r1, r2);
+			} COB_NEXT()
+			COB_INSTR(GET) {
 				r5 = POP();
 				r4 = POP();
 				r3 = POP();
 				r2 = POP();
 				r1 = POP();
+
 				if ((r1 >= LUA0) && (r1 <= LUA9)) {
 					dataStack.push_back(luaArgs[r1 - LUA0]);
-					break;
+				} else {
+					r6 = cobInst->GetUnitVal(r1, r2, r3, r4, r5);
+					dataStack.push_back(r6);
 				}
-				r6 = cobInst->GetUnitVal(r1, r2, r3, r4, r5);
-				dataStack.push_back(r6);
-			} break;
-			case ADD: {
+			} COB_NEXT()
+			COB_INSTR(ADD) {
 				r2 = POP();
 				r1 = POP();
 				dataStack.push_back(r1 + r2);
-			} break;
-			case SUB: {
+			} COB_NEXT()
+			COB_INSTR(SUB) {
 				r2 = POP();
 				r1 = POP();
 				r3 = r1 - r2;
 				dataStack.push_back(r3);
-			} break;
+			} COB_NEXT()
 
-			case DIV: {
+			COB_INSTR(DIV) {
 				r2 = POP();
 				r1 = POP();
 
@@ -710,8 +619,8 @@ bool CCobThread::Tick()
 					ShowError("division by zero");
 				}
 				dataStack.push_back(r3);
-			} break;
-			case MOD: {
+			} COB_NEXT()
+			COB_INSTR(MOD) {
 				r2 = POP();
 				r1 = POP();
 
@@ -721,33 +630,27 @@ bool CCobThread::Tick()
 					dataStack.push_back(0);
 					ShowError("modulo division by zero");
 				}
-			} break;
+			} COB_NEXT()
 
 
-			case MOVE: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
+			COB_INSTR(MOVE) {
 				r4 = POP();
 				r3 = POP();
-				cobInst->Move(r1, r2, r3, r4);
-			} break;
-			case MOVE_NOW: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
+				cobInst->Move(instr->args[0], instr->args[1], r3, r4);
+			} COB_NEXT()
+			COB_INSTR(MOVE_NOW) {
 				r3 = POP();
-				cobInst->MoveNow(r1, r2, r3);
-			} break;
-			case TURN_NOW: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
+				cobInst->MoveNow(instr->args[0], instr->args[1], r3);
+			} COB_NEXT()
+			COB_INSTR(TURN_NOW) {
 				r3 = POP();
-				cobInst->TurnNow(r1, r2, r3);
-			} break;
+				cobInst->TurnNow(instr->args[0], instr->args[1], r3);
+			} COB_NEXT()
 
 
-			case WAIT_TURN: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
+			COB_INSTR(WAIT_TURN) {
+				r1 = instr->args[0];
+				r2 = instr->args[1];
 
 				if (cobInst->NeedsWait(CCobInstance::ATurn, r1, r2)) {
 					state = WaitTurn;
@@ -755,10 +658,10 @@ bool CCobThread::Tick()
 					waitAxis = r2;
 					return true;
 				}
-			} break;
-			case WAIT_MOVE: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
+			} COB_NEXT()
+			COB_INSTR(WAIT_MOVE) {
+				r1 = instr->args[0];
+				r2 = instr->args[1];
 
 				if (cobInst->NeedsWait(CCobInstance::AMove, r1, r2)) {
 					state = WaitMove;
@@ -766,62 +669,60 @@ bool CCobThread::Tick()
 					waitAxis = r2;
 					return true;
 				}
-			} break;
+			} COB_NEXT()
 
 
-			case SET: {
+			COB_INSTR(SET) {
 				r2 = POP();
 				r1 = POP();
 
 				if ((r1 >= LUA0) && (r1 <= LUA9)) {
 					luaArgs[r1 - LUA0] = r2;
-					break;
+				} else {
+					cobInst->SetUnitVal(r1, r2);
 				}
+			} COB_NEXT()
 
-				cobInst->SetUnitVal(r1, r2);
-			} break;
 
-
-			case ATTACH: {
+			COB_INSTR(ATTACH) {
 				r3 = POP();
 				r2 = POP();
 				r1 = POP();
 				cobInst->AttachUnit(r2, r1);
-			} break;
-			case DROP: {
+			} COB_NEXT()
+			COB_INSTR(DROP) {
 				r1 = POP();
 				cobInst->DropUnit(r1);
-			} break;
+			} COB_NEXT()
 
 			// like bitwise ops, but only on values 1 and 0
-			case LOGICAL_NOT: {
+			COB_INSTR(LOGICAL_NOT) {
 				r1 = POP();
 				dataStack.push_back(int(r1 == 0));
-			} break;
-			case LOGICAL_AND: {
+			} COB_NEXT()
+			COB_INSTR(LOGICAL_AND) {
 				r1 = POP();
 				r2 = POP();
 				dataStack.push_back(int(r1 && r2));
-			} break;
-			case LOGICAL_OR: {
+			} COB_NEXT()
+			COB_INSTR(LOGICAL_OR) {
 				r1 = POP();
 				r2 = POP();
 				dataStack.push_back(int(r1 || r2));
-			} break;
-			case LOGICAL_XOR: {
+			} COB_NEXT()
+			COB_INSTR(LOGICAL_XOR) {
 				r1 = POP();
 				r2 = POP();
 				dataStack.push_back(int((!!r1) ^ (!!r2)));
-			} break;
+			} COB_NEXT()
 
 
-			case HIDE: {
-				r1 = GET_LONG_PC();
-				cobInst->SetVisibility(r1, false);
-			} break;
+			COB_INSTR(HIDE) {
+				cobInst->SetVisibility(instr->args[0], false);
+			} COB_NEXT()
 
-			case SHOW: {
-				r1 = GET_LONG_PC();
+			COB_INSTR(SHOW) {
+				r1 = instr->args[0];
 
 				int i;
 				for (i = 0; i < MAX_WEAPONS_PER_UNIT; ++i)
@@ -834,13 +735,15 @@ bool CCobThread::Tick()
 				} else {
 					cobInst->SetVisibility(r1, true);
 				}
-			} break;
+			} COB_NEXT()
 
-			default: {
+			// CALL's are always resolved by CCobFile::DecodeInstructions
+			COB_INSTR(CALL)
+			COB_INSTR(UNKNOWN) {
 				const char* name = cobFile->name.c_str();
 				const char* func = cobFile->scriptNames[callStack.back().functionId].c_str();
 
-				LOG_L(L_ERROR, "[COBThread::%s] unknown opcode %x (in %s:%s at %x)", __func__, opcode, name, func, pc - 1);
+				LOG_L(L_ERROR, "[COBThread::%s] unknown opcode %x (in %s:%s at %x)", __func__, instr->args[0], name, func, pc - 1);
 
 				#if 0
 				auto ei = execTrace.begin();
@@ -852,14 +755,21 @@ bool CCobThread::Tick()
 
 				state = Dead;
 				return false;
-			} break;
+			}
 		}
 	}
 
+#if defined(__GNUC__)
+done:
+#endif
+	#undef COB_NEXT
+	#undef COB_INSTR
+
 	// can arrive here as dead, through CCobInstance::Signal()
 	return (state != Dead);
 }
 
+
 void CCobThread::ShowError(const char* msg)
 {
 	if ((errorCounter = std::max(errorCounter - 1, 0)) == 0)
@@ -877,10 +787,9 @@ void CCobThread::ShowError(const char* msg)
 }
 
 
-void CCobThread::LuaCall()
+void CCobThread::LuaCall(int r1, int r2)
 {
-	const int r1 = GET_LONG_PC(); // script id
-	const int r2 = GET_LONG_PC(); // arg count
+	// r1 is the script id, r2 the arg count
 
 	// setup the parameter array
 	const int size = (int) dataStack.size();
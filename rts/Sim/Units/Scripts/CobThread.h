@@ -98,7 +98,7 @@ public:
 	CCobFile* cobFile = nullptr;
 
 protected:
-	void LuaCall();
+	void LuaCall(int r1, int r2);
 
 	inline int POP();
 
@@ -3,6 +3,7 @@
 #include "UnitDef.h"
 #include "Unit.h"
 #include "UnitHandler.h"
+#include "UnitHotState.h"
 #include "UnitDefHandler.h"
 #include "UnitLoader.h"
 #include "UnitMemPool.h"
@@ -498,6 +499,14 @@ void CUnit::PostLoad()
 		wind.AddUnit(this);
 
 	eventHandler.RenderUnitCreated(this, isCloaked);
+
+	// CUnitHotState is not serialized
+	StoreHotState();
+}
+
+void CUnit::StoreHotState()
+{
+	unitHotState.Store(this);
 }
 
 
@@ -973,17 +982,25 @@ void CUnit::SetLosStatus(int at, unsigned short newStatus)
 
 
 unsigned short CUnit::CalcLosStatus(int at) const
+{
+	const bool inLos = losHandler->InLos(this, at);
+	const bool inRadar = !inLos && losHandler->InRadar(this, at);
+
+	return (CalcLosStatus(at, inLos, inRadar));
+}
+
+unsigned short CUnit::CalcLosStatus(int at, bool inLos, bool inRadar) const
 {
 	const unsigned short currStatus = losStatus[at];
 
 	unsigned short newStatus = currStatus;
 	unsigned short mask = ~(currStatus >> 8);
 
-	if (losHandler->InLos(this, at)) {
+	if (inLos) {
 		newStatus |= (mask & (LOS_INLOS   | LOS_INRADAR |
 		                      LOS_PREVLOS | LOS_CONTRADAR));
 	}
-	else if (losHandler->InRadar(this, at)) {
+	else if (inRadar) {
 		newStatus |=  (mask & LOS_INRADAR);
 		newStatus &= ~(mask & LOS_INLOS);
 	}
@@ -1004,6 +1021,16 @@ void CUnit::UpdateLosStatus(int at)
 	SetLosStatus(at, CalcLosStatus(at));
 }
 
+bool CUnit::UpdateLosStatus(int at, bool inLos, bool inRadar)
+{
+	const unsigned short currStatus = losStatus[at];
+	if ((currStatus & LOS_ALL_MASK_BITS) == LOS_ALL_MASK_BITS) {
+		return false;
+	}
+	SetLosStatus(at, CalcLosStatus(at, inLos, inRadar));
+	return (losStatus[at] != currStatus);
+}
+
 
 void CUnit::SetStunned(bool stun) {
 	stunned = stun;
@@ -1586,6 +1613,7 @@ bool CUnit::ChangeTeam(int newteam, ChangeType type)
 	team = newteam;
 	allyteam = teamHandler->AllyTeam(newteam);
 	neutral = false;
+	StoreHotState();
 
 	unitHandler.ChangeUnitTeam(this, oldteam, newteam);
 
@@ -1617,18 +1645,19 @@ void CUnit::ChangeTeamReset()
 {
 	// stop friendly units shooting at us
 	std::vector<CUnit*> alliedunits;
+	TSyncSafeSet objs;
 
-	for (const auto& objs: GetAllListeners()) {
-		for (CObject* obj: objs) {
-			CUnit* u = dynamic_cast<CUnit*>(obj);
+	GetListeners(objs);
 
-			if (u == nullptr)
-				continue;
-			if (!teamHandler->AlliedTeams(team, u->team))
-				continue;
+	for (CObject* obj: objs) {
+		CUnit* u = dynamic_cast<CUnit*>(obj);
 
-			alliedunits.push_back(u);
-		}
+		if (u == nullptr)
+			continue;
+		if (!teamHandler->AlliedTeams(team, u->team))
+			continue;
+
+		alliedunits.push_back(u);
 	}
 	for (auto ui = alliedunits.cbegin(); ui != alliedunits.cend(); ++ui) {
 		(*ui)->StopAttackingAllyTeam(allyteam);
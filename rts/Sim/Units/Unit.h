@@ -69,6 +69,15 @@ public:
 	void ApplyDamage(CUnit* attacker, const DamageArray& damages, float& baseDamage, float& experienceMod);
 	void ApplyImpulse(const float3& impulse);
 
+	// SetVelocityAndSpeed and SetRadiusAndHeight(model) call these
+	void SetVelocity(const float3& v) override { CSolidObject::SetVelocity(v); StoreHotState(); }
+	float SetSpeed(const float3& v) override { const float s = CSolidObject::SetSpeed(v); StoreHotState(); return s; }
+
+	using CSolidObject::SetRadiusAndHeight;
+	void SetRadiusAndHeight(float r, float h) override { CSolidObject::SetRadiusAndHeight(r, h); StoreHotState(); }
+
+	void StoreHotState() override;
+
 	bool AttackUnit(CUnit* unit, bool isUserTarget, bool wantManualFire, bool fpsMode = false);
 	bool AttackGround(const float3& pos, bool isUserTarget, bool wantManualFire, bool fpsMode = false);
 	void DropCurrentAttackTarget();
@@ -154,7 +163,9 @@ public:
 
 	void SetLosStatus(int allyTeam, unsigned short newStatus);
 	void UpdateLosStatus(int allyTeam);
+	bool UpdateLosStatus(int allyTeam, bool inLos, bool inRadar);
 	unsigned short CalcLosStatus(int allyTeam) const;
+	unsigned short CalcLosStatus(int allyTeam, bool inLos, bool inRadar) const;
 
 	void SlowUpdateCloak(bool);
 	bool ScriptCloak();
@@ -1,10 +1,13 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 
 #include "UnitHandler.h"
 #include "Unit.h"
 #include "UnitDefHandler.h"
+#include "UnitHotState.h"
 #include "UnitMemPool.h"
 #include "UnitTypes/Builder.h"
 #include "UnitTypes/ExtractorBuilding.h"
@@ -12,6 +15,8 @@
 
 #include "CommandAI/BuilderCAI.h"
 #include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/LosHandler.h"
+#include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/MoveTypes/MoveType.h"
 #include "Sim/Weapons/Weapon.h"
@@ -20,6 +25,7 @@
 #include "System/myMath.h"
 #include "System/TimeProfiler.h"
 #include "System/Sync/SyncTracer.h"
+#include "System/Threading/ThreadPool.h"
 #include "System/creg/STL_Deque.h"
 #include "System/creg/STL_Set.h"
 
@@ -48,6 +54,11 @@ CR_REG_METADATA(CUnitHandler, (
 
 UnitMemPool unitMemPool;
 
+// units with per-piece collision volumes near those searching for targets
+static std::array<std::vector<const CUnit*>, ThreadPool::MAX_THREADS> preTargetPieceUnits;
+// LOS- and radar-visibility of every active unit, see UpdateUnitLosStates
+static std::vector<CLosHandler::SUnitVisibility> unitVisibilities;
+
 CUnitHandler unitHandler;
 
 
@@ -124,6 +135,7 @@ void CUnitHandler::Init() {
 		activeUnits.reserve(maxUnits);
 
 		unitMemPool.reserve(128);
+		unitHotState.Init(maxUnits);
 
 		// id's are used as indices, so they must lie in [0, units.size() - 1]
 		// (furthermore all id's are treated equally, none have special status)
@@ -147,6 +159,7 @@ void CUnitHandler::Kill()
 
 	// do not clear in ctor because creg-loaded objects would be wiped out
 	unitMemPool.clear();
+	unitHotState.Kill();
 
 	units.clear();
 
@@ -208,6 +221,7 @@ void CUnitHandler::InsertActiveUnit(CUnit* unit)
 	#endif
 
 	units[unit->id] = unit;
+	unitHotState.Store(unit);
 }
 
 
@@ -317,6 +331,9 @@ void CUnitHandler::UpdateUnitMoveTypes()
 {
 	SCOPED_TIMER("Sim::Unit::MoveType");
 
+	// broadphase for the unit-unit collisions handled below
+	quadField.BuildCollisionGrid(activeUnits);
+
 	for (activeUpdateUnit = 0; activeUpdateUnit < activeUnits.size(); ++activeUpdateUnit) {
 		CUnit* unit = activeUnits[activeUpdateUnit];
 		AMoveType* moveType = unit->moveType;
@@ -326,6 +343,10 @@ void CUnitHandler::UpdateUnitMoveTypes()
 		if (moveType->Update())
 			eventHandler.UnitMoved(unit);
 
+		// move-types also write owner->speed etc. directly
+		unitHotState.Store(unit);
+		quadField.MovedCollider(unit);
+
 		// this unit is not coming back, kill it now without any death
 		// sequence (so deathScriptFinished becomes true immediately)
 		if (!unit->pos.IsInBounds() && (unit->speed.w > MAX_UNIT_SPEED))
@@ -340,9 +361,34 @@ void CUnitHandler::UpdateUnitLosStates()
 {
 	SCOPED_TIMER("Sim::Unit::UpdateLosStatus");
 
-	for (CUnit* unit: activeUnits) {
+	CLosHandler::SAllyTeamMask globalLosMask;
+
+	losHandler->GetGlobalLosMask(globalLosMask);
+	losHandler->GetUnitVisibility(activeUnits, globalLosMask, unitVisibilities);
+
+	// synced Unit{Entered,Left}{Los,Radar} callins can change any unit (or
+	// globalLOS); once one has run, the remaining visibilities are refreshed
+	// just before use so they are the same as if computed one at a time
+	const bool syncedCallins = eventHandler.HasSyncedUnitLosClients();
+	bool refresh = false;
+
+	for (size_t i = 0; i < activeUnits.size(); ++i) {
+		CUnit* unit = activeUnits[i];
+		CLosHandler::SUnitVisibility& visibility = unitVisibilities[i];
+
+		if (refresh)
+			losHandler->GetUnitVisibility(unit, globalLosMask, visibility);
+
 		for (int at = 0; at < teamHandler->ActiveAllyTeams(); ++at) {
-			unit->UpdateLosStatus(at);
+			if (!unit->UpdateLosStatus(at, visibility.inLos.Test(at), visibility.inRadar.Test(at)))
+				continue;
+			if (!syncedCallins)
+				continue;
+
+			// refresh what the remaining allyteams see of this unit, too
+			losHandler->GetGlobalLosMask(globalLosMask);
+			losHandler->GetUnitVisibility(unit, globalLosMask, visibility);
+			refresh = true;
 		}
 	}
 }
@@ -357,8 +403,12 @@ void CUnitHandler::SlowUpdateUnits()
 	if ((gs->frameNum % UNIT_SLOWUPDATE_RATE) == 0)
 		activeSlowUpdateUnit = 0;
 
+	const size_t numSlowUpdates = (activeUnits.size() / UNIT_SLOWUPDATE_RATE) + 1;
+
+	UpdatePreTargets(activeSlowUpdateUnit, std::min(activeSlowUpdateUnit + numSlowUpdates, activeUnits.size()));
+
 	// stagger the SlowUpdate's
-	for (size_t n = (activeUnits.size() / UNIT_SLOWUPDATE_RATE) + 1; (activeSlowUpdateUnit < activeUnits.size() && n != 0); ++activeSlowUpdateUnit) {
+	for (size_t n = numSlowUpdates; (activeSlowUpdateUnit < activeUnits.size() && n != 0); ++activeSlowUpdateUnit) {
 		CUnit* unit = activeUnits[activeSlowUpdateUnit];
 
 		SanityCheckUnit(unit);
@@ -371,6 +421,100 @@ void CUnitHandler::SlowUpdateUnits()
 	}
 }
 
+void CUnitHandler::UpdatePreTargets(size_t begin, size_t end)
+{
+	// compute-phase of CWeapon::AutoTarget for the units about to be
+	// SlowUpdate'd; weapons pick their targets against the state of
+	// this point and CWeapon::SlowUpdate commits them (or redoes the
+	// search if anything relevant changed) in activeUnits order
+	#ifndef TRACE_SYNC
+	if (begin >= end)
+		return;
+	// Lua can reprioritize or veto targets, run everything serially
+	if (eventHandler.HasAllowWeaponTargetClients())
+		return;
+
+	SCOPED_TIMER("Sim::Unit::SlowUpdate::PreTargets");
+
+	// piece matrices are updated lazily on first access, which must not
+	// happen concurrently; weapons read those of their owner and traces
+	// those of units with per-piece collision volumes (feature pieces do
+	// not move and are updated when the feature is created)
+	const auto UpdatePieceMatrices = [](const CUnit* unit) {
+		const LocalModel& lm = unit->localModel;
+
+		for (unsigned int i = 0; i < lm.pieces.size(); i++) {
+			lm.GetRawPieceMatrix(i);
+		}
+	};
+
+	for (size_t i = begin; i < end; i++) {
+		UpdatePieceMatrices(activeUnits[i]);
+	}
+
+	for (auto& units: preTargetPieceUnits) {
+		units.clear();
+	}
+
+	// a trace only visits quads between the weapon and its (in-range)
+	// target, so units outside the search radius can not be reached;
+	// the extra quad covers muzzle offsets and lead positions
+	for_mt(begin, end, [&](const int i) {
+		const CUnit* unit = activeUnits[i];
+
+		if (!unit->CanUpdateWeapons())
+			return;
+
+		float searchRadius = 0.0f;
+
+		for (CWeapon* w: unit->weapons) {
+			searchRadius = std::max(searchRadius, w->PrepPreTarget());
+		}
+
+		if (searchRadius <= 0.0f)
+			return;
+
+		std::vector<const CUnit*>& pieceUnits = preTargetPieceUnits[ThreadPool::GetThreadNum()];
+
+		QuadFieldQuery qfQuery;
+		quadField.GetQuads(qfQuery, unit->pos, searchRadius + unit->radius + quadField.GetQuadSizeX());
+
+		for (const int qi: *qfQuery.quads) {
+			for (const CUnit* u: quadField.GetQuad(qi).units) {
+				if (u->collisionVolume.DefaultToPieceTree())
+					pieceUnits.push_back(u);
+			}
+		}
+	});
+
+	{
+		std::vector<const CUnit*>& pieceUnits = preTargetPieceUnits[0];
+
+		for (size_t n = 1; n < preTargetPieceUnits.size(); n++) {
+			pieceUnits.insert(pieceUnits.end(), preTargetPieceUnits[n].begin(), preTargetPieceUnits[n].end());
+		}
+
+		std::sort(pieceUnits.begin(), pieceUnits.end(), [](const CUnit* a, const CUnit* b) { return (a->id < b->id); });
+		pieceUnits.erase(std::unique(pieceUnits.begin(), pieceUnits.end()), pieceUnits.end());
+
+		for (const CUnit* unit: pieceUnits) {
+			UpdatePieceMatrices(unit);
+		}
+	}
+
+	for_mt(begin, end, [&](const int i) {
+		const CUnit* unit = activeUnits[i];
+
+		if (!unit->CanUpdateWeapons())
+			return;
+
+		for (CWeapon* w: unit->weapons) {
+			w->UpdatePreTarget();
+		}
+	});
+	#endif
+}
+
 void CUnitHandler::UpdateUnits()
 {
 	SCOPED_TIMER("Sim::Unit::Update");
@@ -379,6 +523,7 @@ void CUnitHandler::UpdateUnits()
 		CUnit* unit = activeUnits[activeUpdateUnit];
 		SanityCheckUnit(unit);
 		unit->Update();
+		unitHotState.Store(unit);
 		// unsynced; done on-demand when drawing unit
 		// unit->UpdateLocalModel();
 		SanityCheckUnit(unit);
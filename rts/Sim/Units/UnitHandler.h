@@ -80,6 +80,7 @@ private:
 	void DeleteUnit(CUnit* unit);
 	void DeleteUnits();
 	void SlowUpdateUnits();
+	void UpdatePreTargets(size_t begin, size_t end);
 	void UpdateUnitMoveTypes();
 	void UpdateUnitLosStates();
 	void UpdateUnits();
@@ -0,0 +1,42 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "UnitHotState.h"
+#include "Unit.h"
+
+CUnitHotState unitHotState;
+
+
+void CUnitHotState::Init(unsigned int maxUnits)
+{
+	posRadii.resize(maxUnits);
+	speeds.resize(maxUnits);
+
+	allyTeams.resize(maxUnits);
+	physicalStates.resize(maxUnits);
+}
+
+void CUnitHotState::Kill()
+{
+	posRadii.clear();
+	speeds.clear();
+
+	allyTeams.clear();
+	physicalStates.clear();
+}
+
+
+void CUnitHotState::Store(const CUnit* unit)
+{
+	const int id = unit->id;
+
+	// not yet (or no longer) holding a valid ID, e.g. during PreInit
+	if (static_cast<size_t>(id) >= posRadii.size())
+		return;
+
+	posRadii[id] = float4(unit->pos, unit->radius);
+	speeds[id] = unit->speed;
+
+	allyTeams[id] = unit->allyteam;
+	physicalStates[id] = unit->physicalState;
+}
+
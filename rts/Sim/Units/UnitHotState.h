@@ -0,0 +1,50 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef UNIT_HOT_STATE_H
+#define UNIT_HOT_STATE_H
+
+#include <vector>
+
+#include "System/float4.h"
+
+class CUnit;
+
+/**
+ * Structure-of-arrays copy of the CUnit fields read by per-frame loops over
+ * (nearly) all units, indexed by unit ID. Such loops can then filter on a
+ * few contiguous arrays and only dereference the units that pass, instead
+ * of pulling a cache-line or more of every (large) CUnit.
+ *
+ * CUnit keeps its slot coherent: the accessors that write the mirrored
+ * fields (Move, SetVelocity, SetSpeed, SetRadiusAndHeight, the physical-state
+ * setters, ChangeTeam) call CUnit::StoreHotState, and CUnitHandler stores every
+ * unit again after its move-type and unit Update so that direct writes in
+ * those (e.g. owner->speed.y) are picked up too. Slots of unused IDs hold
+ * stale data, callers must only index live units.
+ */
+class CUnitHotState {
+public:
+	void Init(unsigned int maxUnits);
+	void Kill();
+
+	void Store(const CUnit* unit);
+
+	const float4& GetPosRadius(int id) const { return posRadii[id]; }
+	const float4& GetSpeed(int id) const { return speeds[id]; }
+
+	int GetAllyTeam(int id) const { return allyTeams[id]; }
+	unsigned int GetPhysicalState(int id) const { return physicalStates[id]; }
+
+private:
+	// xyz is CUnit::pos, w is CUnit::radius
+	std::vector<float4> posRadii;
+	std::vector<float4> speeds;
+
+	std::vector<int> allyTeams;
+	std::vector<unsigned int> physicalStates;
+};
+
+extern CUnitHotState unitHotState;
+
+#endif
+
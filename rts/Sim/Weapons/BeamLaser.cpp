@@ -276,7 +276,7 @@ void CBeamLaser::FireInternal(float3 curDir)
 	CUnit* hitUnit = nullptr;
 	CFeature* hitFeature = nullptr;
 	CPlasmaRepulser* hitShield = nullptr;
-	static std::vector<TraceRay::SShieldDist> hitShields;
+	FrameVector<TraceRay::SShieldDist> hitShields;
 	CollisionQuery hitColQuery;
 
 	if (!sweepFireState.IsSweepFiring()) {
@@ -53,8 +53,7 @@ void CLightningCannon::FireImpl(const bool scriptCall)
 		}
 	}
 
-	static std::vector<TraceRay::SShieldDist> hitShields;
-	hitShields.clear();
+	FrameVector<TraceRay::SShieldDist> hitShields;
 	TraceRay::TraceRayShields(this, curPos, curDir, range, hitShields);
 	for (const TraceRay::SShieldDist& sd: hitShields) {
 		if (sd.dist < boltLength && sd.rep->IncomingBeam(this, curPos, curPos + (curDir * sd.dist), 1.0f)) {
@@ -8,6 +8,7 @@
 #include "Game/Players/Player.h"
 #include "Lua/LuaConfig.h"
 #include "Map/Ground.h"
+#include "Map/ReadMap.h"
 #include "Sim/Misc/CollisionHandler.h"
 #include "Sim/Misc/CollisionVolume.h"
 #include "Sim/Misc/GlobalSynced.h"
@@ -101,7 +102,8 @@ CR_REG_METADATA(CWeapon, (
 	CR_MEMBER(currentTarget),
 	CR_MEMBER(currentTargetPos),
 
-	CR_MEMBER(incomingProjectileIDs)
+	CR_MEMBER(incomingProjectileIDs),
+	CR_IGNORED(preTargetCache)
 ))
 
 
@@ -571,6 +573,11 @@ bool CWeapon::AllowWeaponAutoTarget() const
 		return checkAllowed;
 	}
 
+	return (WantWeaponAutoTarget());
+}
+
+bool CWeapon::WantWeaponAutoTarget() const
+{
 	//FIXME these need to be merged
 	if (weaponDef->noAutoTarget || noAutoTarget) { return false; }
 	if (owner->fireState < FIRESTATE_FIREATWILL) { return false; }
@@ -625,17 +632,132 @@ bool CWeapon::AutoTarget()
 
 	const CUnit* avoidUnit = (avoidTarget && currentTarget.type == Target_Unit) ? currentTarget.unit : nullptr;
 
+	CUnit* targetUnit = nullptr;
+
+	if (UsePreTarget(avoidUnit)) {
+		targetUnit = preTargetCache.targetUnit;
+	} else {
+		FrameVector<std::pair<float, CUnit*>> targets;
+
+		targets.reserve(16);
+
+		CGameHelper::GenerateWeaponTargets(this, avoidUnit, targets);
+
+		targetUnit = PickAutoTarget(targets);
+	}
+
+	preTargetCache.frameNum = -1;
+
+	if (targetUnit != nullptr) {
+		// pick our new target
+		SetAttackTarget(SWeaponTarget(targetUnit));
+		return true;
+	}
+	return false;
+}
+
+float CWeapon::PrepPreTarget()
+{
+	PreTargetCache& ptc = preTargetCache;
+
+	ptc.frameNum = -1;
+	ptc.searchRadius = 0.0f;
+
+	// TargetWeight is a script call-in
+	if (hasTargetWeight)
+		return 0.0f;
+
+	UpdateWeaponVectors();
+
+	if (!WantWeaponAutoTarget())
+		return 0.0f;
+
+	return (ptc.searchRadius = GetAutoTargetRadius());
+}
+
+void CWeapon::UpdatePreTarget()
+{
 	// NOTE:
-	//   GenerateWeaponTargets sorts by INCREASING order of priority, so lower equals better
-	//   <targets> is normally sorted such that all bad TargetCategory units are at the end,
-	//   but Lua can mess with the ordering arbitrarily
-	static std::vector<std::pair<float, CUnit*>> targets;
+	//   runs concurrently for all weapons of the units that are due for
+	//   SlowUpdate this frame, touch nothing outside *this; the caller
+	//   makes sure GenerateWeaponTargets can not reach any Lua call-ins
+	PreTargetCache& ptc = preTargetCache;
+
+	if (ptc.searchRadius <= 0.0f)
+		return;
+
+	FrameVector<std::pair<float, CUnit*>> targets;
 
-	targets.clear();
 	targets.reserve(16);
 
-	CGameHelper::GenerateWeaponTargets(this, avoidUnit, targets);
+	// search with the lead factor SlowUpdate is about to draw, but leave the
+	// current one in place until it actually does
+	const float curSpeedMod = predictSpeedMod;
+
+	predictSpeedMod = NextPredictSpeedMod();
+	ptc.predictSpeedMod = predictSpeedMod;
+	ptc.avoidUnit = (avoidTarget && currentTarget.type == Target_Unit) ? currentTarget.unit : nullptr;
+
+	CGameHelper::GenerateWeaponTargets(this, ptc.avoidUnit, targets);
 
+	ptc.targetUnit = PickAutoTarget(targets);
+
+	predictSpeedMod = curSpeedMod;
+
+	ptc.ownerPos = owner->pos;
+	ptc.aimFromPos = aimFromPos;
+	ptc.muzzlePos = weaponMuzzlePos;
+	ptc.fireState = owner->fireState;
+	ptc.frameNum = gs->frameNum;
+}
+
+bool CWeapon::UsePreTarget(const CUnit* avoidUnit) const
+{
+	const PreTargetCache& ptc = preTargetCache;
+
+	if (ptc.frameNum != gs->frameNum)
+		return false;
+	if (ptc.avoidUnit != avoidUnit)
+		return false;
+	if (ptc.fireState != owner->fireState)
+		return false;
+	// differs if the owner gained experience in between
+	if (ptc.predictSpeedMod != predictSpeedMod)
+		return false;
+
+	// script may have switched pieces or started weighting targets in between
+	if (hasTargetWeight)
+		return false;
+	if (!ptc.ownerPos.same(owner->pos) || !ptc.aimFromPos.same(aimFromPos) || !ptc.muzzlePos.same(weaponMuzzlePos))
+		return false;
+
+	// the picked unit may have died (or been given away) since
+	return (ptc.targetUnit == nullptr || TestTarget(float3(), SWeaponTarget(ptc.targetUnit)));
+}
+
+float CWeapon::GetAutoTargetRadius() const
+{
+	return (range + (aimFromPos.y - std::max(0.0f, readMap->GetInitMinHeight())) * weaponDef->heightmod);
+}
+
+CGlobalSyncedRNG CWeapon::GetFrameRNG(unsigned int stream) const
+{
+	CGlobalSyncedRNG rng;
+	rng.SetSeed(gsRNG.GetInitSeed() + ((uint64_t(gs->frameNum) << 32) | (uint64_t(stream) << 24) | (owner->id << 5) | weaponNum));
+	return rng;
+}
+
+float CWeapon::NextPredictSpeedMod() const
+{
+	return (1.0f + (GetFrameRNG(1).NextFloat() - 0.5f) * 2 * (1.0f - owner->limExperience));
+}
+
+CUnit* CWeapon::PickAutoTarget(const FrameVector<std::pair<float, CUnit*>>& targets) const
+{
+	// NOTE:
+	//   GenerateWeaponTargets sorts by INCREASING order of priority, so lower equals better
+	//   <targets> is normally sorted such that all bad TargetCategory units are at the end,
+	//   but Lua can mess with the ordering arbitrarily
 	CUnit* goodTargetUnit = nullptr;
 	CUnit* badTargetUnit = nullptr;
 
@@ -665,19 +787,14 @@ bool CWeapon::AutoTarget()
 	if (goodTargetUnit == nullptr)
 		goodTargetUnit = badTargetUnit;
 
-	if (goodTargetUnit) {
-		// pick our new target
-		SetAttackTarget(SWeaponTarget(goodTargetUnit));
-		return true;
-	}
-	return false;
+	return goodTargetUnit;
 }
 
 
 void CWeapon::SlowUpdate()
 {
 	errorVectorAdd = (gsRNG.NextVector() - errorVector) * (1.0f / UNIT_SLOWUPDATE_RATE);
-	predictSpeedMod = 1.0f + (gsRNG.NextFloat() - 0.5f) * 2 * (1.0f - owner->limExperience);
+	predictSpeedMod = NextPredictSpeedMod();
 
 #ifdef TRACE_SYNC
 	tracefile << "Weapon slow update: ";
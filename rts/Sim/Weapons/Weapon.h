@@ -5,6 +5,8 @@
 
 #include <vector>
 
+#include "System/FrameArena.h"
+#include "System/GlobalRNG.h"
 #include "System/Object.h"
 #include "Sim/Misc/DamageArray.h"
 #include "Sim/Projectiles/ProjectileParams.h"
@@ -78,6 +80,15 @@ public:
 	virtual void UpdateRange(const float val) { range = val; }
 
 	bool AutoTarget();
+	// two-stage compute-phase of AutoTarget, see CUnitHandler::UpdatePreTargets;
+	// the first returns the radius the search can reach (0 if it will not run)
+	float PrepPreTarget();
+	void UpdatePreTarget();
+	float GetAutoTargetRadius() const;
+
+	// synced RNG private to this weapon and the current sim-frame; unlike
+	// gsRNG its draws do not depend on the order weapons are processed in
+	CGlobalSyncedRNG GetFrameRNG(unsigned int stream) const;
 	void AimReady(const int value);
 	void Fire(const bool scriptCall);
 
@@ -110,6 +121,10 @@ private:
 
 	void UpdateInterceptTarget();
 	bool AllowWeaponAutoTarget() const;
+	bool WantWeaponAutoTarget() const;
+	bool UsePreTarget(const CUnit* avoidUnit) const;
+	float NextPredictSpeedMod() const;
+	CUnit* PickAutoTarget(const FrameVector<std::pair<float, CUnit*>>& targets) const;
 	bool CobBlockShot() const;
 	bool CheckAimingAngle() const;
 	bool CanCallAimingScript(bool validAngle) const;
@@ -199,6 +214,27 @@ protected:
 	// projectiles that are on the way to our interception zone
 	// (eg. nuke toward a repulsor, or missile toward a shield)
 	std::vector<int> incomingProjectileIDs;
+
+private:
+	// target picked by UpdatePreTarget; only used by AutoTarget if
+	// the inputs below are still bit-identical at that point (other
+	// units are taken as they were when UpdatePreTarget ran)
+	struct PreTargetCache {
+		float3 ownerPos;
+		float3 aimFromPos;
+		float3 muzzlePos;
+
+		float predictSpeedMod = 1.0f;
+		float searchRadius = 0.0f;
+
+		const CUnit* avoidUnit = nullptr;
+		CUnit* targetUnit = nullptr;
+
+		int frameNum = -1;
+		int fireState = 0;
+	};
+
+	PreTargetCache preTargetCache;
 };
 
 #endif /* WEAPON_H */
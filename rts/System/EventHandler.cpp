@@ -240,6 +240,19 @@ template<typename T, typename F, typename... A> bool ControlIterateDefFalse(T& l
 
 
 
+bool CEventHandler::HasSyncedUnitLosClients() const
+{
+	for (const EventClientList* list: {&listUnitEnteredRadar, &listUnitEnteredLos, &listUnitLeftRadar, &listUnitLeftLos}) {
+		for (const CEventClient* ec: *list) {
+			if (ec->GetSynced())
+				return true;
+		}
+	}
+
+	return false;
+}
+
+
 bool CEventHandler::CommandFallback(const CUnit* unit, const Command& cmd)
 {
 	return ControlIterateDefTrue(listCommandFallback, &CEventClient::CommandFallback, unit, cmd);
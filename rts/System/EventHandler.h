@@ -98,6 +98,9 @@ class CEventHandler
 		void UnitEnteredLos(const CUnit* unit, int allyTeam);
 		void UnitLeftRadar(const CUnit* unit, int allyTeam);
 		void UnitLeftLos(const CUnit* unit, int allyTeam);
+		// false iff no synced client (i.e. nothing that can change sim-state)
+		// receives any of the four LOS- and radar-callins above
+		bool HasSyncedUnitLosClients() const;
 
 		void UnitEnteredWater(const CUnit* unit);
 		void UnitEnteredAir(const CUnit* unit);
@@ -161,6 +164,8 @@ class CEventHandler
 			unsigned int attackerWeaponDefID,
 			float* targetPriority
 		);
+		// false iff AllowWeaponTarget would not call into Lua
+		bool HasAllowWeaponTargetClients() const { return (!listAllowWeaponTarget.empty()); }
 		bool AllowWeaponInterceptTarget(const CUnit* interceptorUnit, const CWeapon* interceptorWeapon, const CProjectile* interceptorTarget);
 
 		bool UnitPreDamaged(
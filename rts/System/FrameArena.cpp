@@ -0,0 +1,139 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+
+#include "System/FrameArena.h"
+#include "System/Log/ILog.h"
+#include "System/Threading/ThreadPool.h"
+
+static std::array<CFrameArena, ThreadPool::MAX_THREADS> threadArenas;
+
+
+
+void* CFrameArena::Allocate(size_t size, size_t align)
+{
+	assert(align != 0 && (align & (align - 1)) == 0);
+
+	size = std::max(size, size_t(1));
+
+	while (true) {
+		if (blockIndex == blocks.size())
+			AddBlock(size + align);
+
+		const Block& block = blocks[blockIndex];
+
+		const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(block.mem.get());
+		const std::uintptr_t addr = (base + blockOffset + (align - 1)) & ~std::uintptr_t(align - 1);
+
+		if ((addr + size) <= (base + block.size)) {
+			blockOffset = (addr + size) - base;
+			numLiveAllocs += 1;
+			peakSize = std::max(peakSize, GetUsedSize());
+
+			return (reinterpret_cast<void*>(addr));
+		}
+
+		// continue in the next block, the tail of this one stays unused until rewound
+		blockBase += block.size;
+		blockIndex += 1;
+		blockOffset = 0;
+	}
+
+	return nullptr;
+}
+
+void CFrameArena::Deallocate(void* p, size_t size)
+{
+	if (p == nullptr)
+		return;
+
+	assert(numLiveAllocs > 0);
+
+	if ((numLiveAllocs -= 1) == 0) {
+		Rewind();
+		return;
+	}
+
+	const uint8_t* top = blocks[blockIndex].mem.get() + blockOffset;
+
+	// only the most recent allocation can be popped; this
+	// covers the common case of a growing vector at the top
+	if ((static_cast<const uint8_t*>(p) + std::max(size, size_t(1))) == top)
+		blockOffset -= std::max(size, size_t(1));
+}
+
+
+void CFrameArena::Reset()
+{
+	// containers using the arena must not outlive the frame
+	assert(numLiveAllocs == 0);
+
+	#ifdef DEBUG
+	if (peakSize > reportedPeakSize) {
+		LOG_L(L_DEBUG, "[FrameArena::%s] new high-water mark of %lu bytes (%lu blocks)", __func__, (unsigned long) peakSize, (unsigned long) blocks.size());
+		reportedPeakSize = peakSize;
+	}
+	#endif
+
+	Rewind();
+
+	numLiveAllocs = 0;
+
+	if (blocks.size() <= 1)
+		return;
+
+	// merge the chain so that next frame's peak fits in one block
+	const size_t capacity = GetCapacity();
+
+	blocks.clear();
+	AddBlock(capacity);
+}
+
+void CFrameArena::Rewind()
+{
+	#ifdef DEBUG
+	for (size_t i = 0; i < std::min(blockIndex + 1, blocks.size()); i++) {
+		std::memset(blocks[i].mem.get(), 0xCD, (i == blockIndex)? blockOffset: blocks[i].size);
+	}
+	#endif
+
+	blockIndex = 0;
+	blockBase = 0;
+	blockOffset = 0;
+}
+
+
+void CFrameArena::AddBlock(size_t minSize)
+{
+	// at least double the capacity with each new block
+	const size_t size = std::max(std::max(minSize, MIN_BLOCK_SIZE), GetCapacity());
+
+	blocks.emplace_back();
+	blocks.back().mem.reset(new uint8_t[size]);
+	blocks.back().size = size;
+}
+
+size_t CFrameArena::GetCapacity() const
+{
+	size_t capacity = 0;
+
+	for (const Block& block: blocks) {
+		capacity += block.size;
+	}
+
+	return capacity;
+}
+
+
+
+CFrameArena& CFrameArena::GetThreadArena() { return threadArenas[ThreadPool::GetThreadNum()]; }
+
+void CFrameArena::ResetThreadArenas()
+{
+	for (CFrameArena& arena: threadArenas) {
+		arena.Reset();
+	}
+}
@@ -0,0 +1,94 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Bump allocator for short-lived simulation temporaries (target lists, ray
+ * hit lists, ...). Memory is handed out linearly from a chain of blocks and
+ * only reclaimed as a whole: when the last live allocation is released, and
+ * by Reset at the end of every sim-frame, which also merges the chain into a
+ * single block large enough for the frame's high-water mark.
+ *
+ * There is one arena per thread-pool thread (see GetThreadArena), so sim
+ * code running inside for_mt may use them freely; they must not be touched
+ * from other (non-pool) threads, which would share arena 0 with the sim.
+ * Containers using an arena must not outlive the sim-frame.
+ */
+class CFrameArena {
+public:
+	CFrameArena() = default;
+	CFrameArena(const CFrameArena&) = delete;
+	CFrameArena& operator = (const CFrameArena&) = delete;
+
+	void* Allocate(size_t size, size_t align);
+	// releasing the most recent allocation gives its memory back right away
+	void Deallocate(void* p, size_t size);
+
+	// rewinds to the start; DEBUG builds poison the released memory
+	void Reset();
+
+	size_t GetUsedSize() const { return (blockBase + blockOffset); }
+	size_t GetPeakSize() const { return peakSize; }
+	size_t GetCapacity() const;
+	size_t GetNumLiveAllocs() const { return numLiveAllocs; }
+
+	static CFrameArena& GetThreadArena();
+	static void ResetThreadArenas();
+
+private:
+	void Rewind();
+	void AddBlock(size_t minSize);
+
+private:
+	struct Block {
+		std::unique_ptr<uint8_t[]> mem;
+		size_t size;
+	};
+
+	static constexpr size_t MIN_BLOCK_SIZE = 64 * 1024;
+
+	std::vector<Block> blocks;
+
+	size_t blockIndex = 0;
+	size_t blockBase = 0; // summed size of blocks[0, blockIndex)
+	size_t blockOffset = 0;
+
+	size_t peakSize = 0;
+	size_t numLiveAllocs = 0;
+
+	#ifdef DEBUG
+	size_t reportedPeakSize = 0;
+	#endif
+};
+
+
+
+/// STL allocator on top of a CFrameArena, by default the calling thread's
+template<typename T> struct FrameAllocator {
+public:
+	typedef T value_type;
+
+	FrameAllocator(): arena(&CFrameArena::GetThreadArena()) {}
+	explicit FrameAllocator(CFrameArena* a): arena(a) {}
+
+	template<typename U> FrameAllocator(const FrameAllocator<U>& a): arena(a.arena) {}
+
+	T* allocate(size_t n) { return (static_cast<T*>(arena->Allocate(n * sizeof(T), alignof(T)))); }
+	void deallocate(T* p, size_t n) { arena->Deallocate(p, n * sizeof(T)); }
+
+	template<typename U> bool operator == (const FrameAllocator<U>& a) const { return (arena == a.arena); }
+	template<typename U> bool operator != (const FrameAllocator<U>& a) const { return (arena != a.arena); }
+
+public:
+	CFrameArena* arena;
+};
+
+template<typename T> using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+#endif
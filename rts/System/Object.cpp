@@ -1,8 +1,9 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 
+#include <algorithm>
+
 #include "System/Object.h"
-#include "System/ContainerUtil.h"
 #include "System/creg/STL_Map.h"
 #include "System/Log/ILog.h"
 #include "System/Platform/CrashHandler.h"
@@ -14,24 +15,27 @@ CR_REG_METADATA(CObject, (
 
 	CR_MEMBER(detached),
 
-	CR_MEMBER(listening),
 	CR_MEMBER(listeners),
-	CR_MEMBER(listenersDepTbl),
-	CR_MEMBER(listeningDepTbl)
+	CR_MEMBER(listening),
+	CR_MEMBER(listeningSlots)
+))
+
+CR_BIND(CObject::SDependence, )
+CR_REG_METADATA_SUB(CObject, SDependence, (
+	CR_MEMBER(obj),
+	CR_MEMBER(type),
+	CR_MEMBER(slot)
 ))
 
 std::atomic<std::int64_t> CObject::cur_sync_id(0);
 
 
 
-static bool VectorInsertSorted(std::vector<CObject*>& v, CObject* o)
-{
-	return (spring::VectorInsertUniqueSorted(v, o, [](const CObject* a, const CObject* b) { return (a->GetSyncID() < b->GetSyncID()); }));
-}
+static bool SyncIDCmp(const CObject* a, const CObject* b) { return (a->GetSyncID() < b->GetSyncID()); }
 
-static bool VectorEraseSorted(std::vector<CObject*>& v, CObject* o)
+static void SortSyncSafe(std::vector<CObject*>& objs)
 {
-	return (spring::VectorEraseUniqueSorted(v, o, [](const CObject* a, const CObject* b) { return (a->GetSyncID() < b->GetSyncID()); }));
+	std::sort(objs.begin(), objs.end(), SyncIDCmp);
 }
 
 
@@ -54,35 +58,117 @@ CObject::~CObject()
 	assert(!detached);
 	detached = true;
 
-	for (const auto& p: listenersDepTbl) {
-		assert(p.first >= DEPENDENCE_ATTACKER && p.first < DEPENDENCE_COUNT);
-		assert(p.second < listeners.size());
+	// listeners are notified by dependence-type and then by sync-ID, since
+	// the order of <listeners> itself depends on unsynced (de)registrations
+	// too; this only reorders indices, DependentDied callbacks can not add
+	// or remove our entries (we are detached) but may move their partners
+	std::vector<int> order(listeners.size());
+
+	for (size_t i = 0; i < order.size(); i++) {
+		order[i] = i;
+	}
+
+	std::sort(order.begin(), order.end(), [&](int i, int j) {
+		const SDependence& a = listeners[i];
+		const SDependence& b = listeners[j];
+
+		if (a.type != b.type)
+			return (a.type < b.type);
+
+		return (SyncIDCmp(a.obj, b.obj));
+	});
+
+	for (const int i: order) {
+		CObject* obj = listeners[i].obj;
+
+		obj->DependentDied(this);
+		obj->EraseListening(listeners[i].slot);
+	}
+
+	for (const SDependence& d: listening) {
+		d.obj->EraseListener(d.slot);
+	}
+
+	listeners.clear();
+	listening.clear();
+	listeningSlots.clear();
+}
+
+
+void CObject::EraseListener(int slot)
+{
+	const int last = listeners.size() - 1;
+
+	assert(slot >= 0 && slot <= last);
+
+	if (slot != last) {
+		listeners[slot] = listeners.back();
+
+		const SDependence& moved = listeners[slot];
+		moved.obj->listening[moved.slot].slot = slot;
+	}
+
+	listeners.pop_back();
+}
+
+void CObject::EraseListening(int slot)
+{
+	const int last = listening.size() - 1;
+
+	assert(slot >= 0 && slot <= last);
+
+	listeningSlots.erase(GetDependenceKey(listening[slot].obj, listening[slot].type));
+
+	if (slot != last) {
+		listening[slot] = listening.back();
+
+		const SDependence& moved = listening[slot];
+		moved.obj->listeners[moved.slot].slot = slot;
+		listeningSlots[GetDependenceKey(moved.obj, moved.type)] = slot;
+	}
 
-		for (CObject* obj: listeners[p.second]) {
-			obj->DependentDied(this);
+	listening.pop_back();
+}
 
-			const auto jt = obj->listeningDepTbl.find(p.first);
 
-			if (jt == obj->listeningDepTbl.end())
-				continue;
+void CObject::GetListeners(TSyncSafeSet& objs) const
+{
+	objs.clear();
+	objs.reserve(listeners.size());
 
-			VectorEraseSorted(obj->listening[ jt->second ], this);
-		}
+	for (const SDependence& d: listeners) {
+		objs.push_back(d.obj);
 	}
 
-	for (const auto& p: listeningDepTbl) {
-		assert(p.first >= DEPENDENCE_ATTACKER && p.first < DEPENDENCE_COUNT);
-		assert(p.second < listening.size());
+	SortSyncSafe(objs);
+}
 
-		for (CObject* obj: listening[p.second]) {
-			const auto jt = obj->listenersDepTbl.find(p.first);
+void CObject::GetListeners(TSyncSafeSet& objs, DependenceType dep) const
+{
+	objs.clear();
 
-			if (jt == obj->listenersDepTbl.end())
-				continue;
+	for (const SDependence& d: listeners) {
+		if (d.type != dep)
+			continue;
 
-			VectorEraseSorted(obj->listeners[ jt->second ], this);
-		}
+		objs.push_back(d.obj);
 	}
+
+	SortSyncSafe(objs);
+}
+
+void CObject::GetListening(TSyncSafeSet& objs, DependenceType dep) const
+{
+	objs.clear();
+
+	for (const SDependence& d: listening) {
+		if (d.type != dep)
+			continue;
+
+		objs.push_back(d.obj);
+	}
+
+	SortSyncSafe(objs);
 }
 
 
@@ -99,8 +185,15 @@ void CObject::AddDeathDependence(CObject* obj, DependenceType dep)
 	if (detached || obj->detached)
 		return;
 
-	VectorInsertSorted(const_cast<TSyncSafeSet&>(     GetListening(dep)),  obj);
-	VectorInsertSorted(const_cast<TSyncSafeSet&>(obj->GetListeners(dep)), this);
+	const std::int64_t key = GetDependenceKey(obj, dep);
+
+	if (listeningSlots.find(key) != listeningSlots.end())
+		return;
+
+	listeningSlots[key] = listening.size();
+
+	listening.push_back({obj, dep, static_cast<int>(obj->listeners.size())});
+	obj->listeners.push_back({this, dep, static_cast<int>(listening.size() - 1)});
 }
 
 
@@ -111,10 +204,15 @@ void CObject::DeleteDeathDependence(CObject* obj, DependenceType dep)
 	if (detached || obj->detached)
 		return;
 
-	const auto it =      listeningDepTbl.find(dep);
-	const auto jt = obj->listenersDepTbl.find(dep);
+	const auto it = listeningSlots.find(GetDependenceKey(obj, dep));
+
+	if (it == listeningSlots.end())
+		return;
+
+	const int slot = it->second;
 
-	if (it !=      listeningDepTbl.end()) VectorEraseSorted(     listening[ it->second ],  obj);
-	if (jt != obj->listenersDepTbl.end()) VectorEraseSorted(obj->listeners[ jt->second ], this);
+	assert(listening[slot].obj == obj);
+	obj->EraseListener(listening[slot].slot);
+	EraseListening(slot);
 }
 
@@ -14,6 +14,7 @@ class CObject
 {
 public:
 	CR_DECLARE(CObject)
+	CR_DECLARE_SUB(SDependence)
 
 	CObject();
 	virtual ~CObject();
@@ -74,43 +75,47 @@ private:
 
 public:
 	typedef std::vector<CObject*> TSyncSafeSet;
-	typedef std::vector<TSyncSafeSet> TDependenceMap;
 
-	bool detached;
+	/**
+	 * One end of a death-dependence: obj is the other object, slot the index
+	 * of the matching entry in obj's listening (if this is in listeners) or
+	 * listeners (if this is in listening) vector. Both ends are removed by
+	 * swap-and-pop and the moved entry's partner is re-pointed, so neither
+	 * insertion nor removal has to search.
+	 */
+	struct SDependence {
+		CR_DECLARE_STRUCT(SDependence)
 
-protected:
-	const TSyncSafeSet& GetListeners(const DependenceType dep) {
-		const auto it = listenersDepTbl.find(dep);
+		CObject* obj;
 
-		if (it == listenersDepTbl.end()) {
-			listeners.emplace_back();
-			listenersDepTbl[dep] = listeners.size() - 1;
-			return (listeners.back());
-		}
+		int type;
+		int slot;
+	};
 
-		return (listeners[it->second]);
-	}
-	const TSyncSafeSet& GetListening(const DependenceType dep) {
-		const auto it = listeningDepTbl.find(dep);
+	bool detached;
 
-		if (it == listeningDepTbl.end()) {
-			listening.emplace_back();
-			listeningDepTbl[dep] = listening.size() - 1;
-			return (listening.back());
-		}
+protected:
+	// these are sorted by sync-ID (per type for the latter) since the raw
+	// vectors are not in any sync-safe order
+	void GetListeners(TSyncSafeSet& objs) const;
+	void GetListeners(TSyncSafeSet& objs, DependenceType dep) const;
+	void GetListening(TSyncSafeSet& objs, DependenceType dep) const;
 
-		return (listening[it->second]);
+private:
+	static std::int64_t GetDependenceKey(const CObject* obj, int dep) {
+		static_assert(DEPENDENCE_COUNT <= 32, "");
+		return ((obj->GetSyncID() << 5) | dep);
 	}
 
-	const TDependenceMap& GetAllListeners() const { return listeners; }
-	const TDependenceMap& GetAllListening() const { return listening; }
+	void EraseListener(int slot);
+	void EraseListening(int slot);
 
 protected:
-	spring::unordered_map<int, size_t> listenersDepTbl; // maps dependence-type to index into listeners
-	spring::unordered_map<int, size_t> listeningDepTbl; // maps dependence-type to index into listening
+	std::vector<SDependence> listeners; // objects that are informed when this dies
+	std::vector<SDependence> listening; // objects whose death this is informed of
 
-	TDependenceMap listeners;
-	TDependenceMap listening;
+	// maps (sync-ID, dependence-type) of an object we listen to, to its index in listening
+	spring::unordered_map<std::int64_t, int> listeningSlots;
 };
 
 #endif /* OBJECT_H */
@@ -0,0 +1,97 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifdef _WIN32
+	#include "System/Platform/Win/win32.h"
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#include "MappedFile.h"
+
+
+bool CMappedFile::Open(const std::string& filePath)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	LARGE_INTEGER fileSize;
+
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0 || std::uint64_t(fileSize.QuadPart) > SIZE_MAX) {
+		CloseHandle(file);
+		return false;
+	}
+
+	// PAGE_WRITECOPY + FILE_MAP_COPY is the equivalent of MAP_PRIVATE
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+
+	if (mapping == nullptr) {
+		CloseHandle(file);
+		return false;
+	}
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+
+	if (view == nullptr) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	fileHandle = file;
+	mapHandle = mapping;
+
+	data = reinterpret_cast<std::uint8_t*>(view);
+	size = fileSize.QuadPart;
+#else
+	const int fd = open(filePath.c_str(), O_RDONLY);
+	struct stat fileInfo;
+
+	if (fd == -1)
+		return false;
+
+	if (fstat(fd, &fileInfo) != 0 || fileInfo.st_size <= 0) {
+		close(fd);
+		return false;
+	}
+
+	void* view = mmap(nullptr, fileInfo.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+	// the mapping stays valid after the descriptor is closed
+	close(fd);
+
+	if (view == MAP_FAILED)
+		return false;
+
+	data = reinterpret_cast<std::uint8_t*>(view);
+	size = fileInfo.st_size;
+#endif
+
+	return true;
+}
+
+void CMappedFile::Close()
+{
+	if (data == nullptr)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(data);
+	CloseHandle(mapHandle);
+	CloseHandle(fileHandle);
+
+	fileHandle = nullptr;
+	mapHandle = nullptr;
+#else
+	munmap(data, size);
+#endif
+
+	data = nullptr;
+	size = 0;
+}
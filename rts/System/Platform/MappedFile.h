@@ -0,0 +1,45 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief maps a whole file into memory
+ *
+ * The mapping is private and copy-on-write: pages that are only read stay
+ * shared with the OS page-cache (and every other process that maps the
+ * same file), writing to a page gives this process its own copy of it and
+ * never modifies the file on disk.
+ */
+class CMappedFile
+{
+public:
+	CMappedFile() = default;
+	CMappedFile(const CMappedFile&) = delete;
+	~CMappedFile() { Close(); }
+
+	CMappedFile& operator = (const CMappedFile&) = delete;
+
+	bool Open(const std::string& filePath);
+	void Close();
+
+	bool IsOpen() const { return (data != nullptr); }
+
+	std::uint8_t* GetData() const { return data; }
+	size_t GetSize() const { return size; }
+
+private:
+	std::uint8_t* data = nullptr;
+	size_t size = 0;
+
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mapHandle = nullptr;
+#endif
+};
+
+#endif // MAPPED_FILE_H
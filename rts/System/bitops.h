@@ -77,6 +77,23 @@ static inline unsigned count_leading_ones(unsigned int x)
 }
 
 
+/**
+ * @brief Significant bits
+ * @return one plus the index of the most significant 1-bit of x, or 0 if x is zero
+ */
+static inline unsigned int count_significant_bits(unsigned int x)
+{
+	if (x == 0) return 0;
+#ifdef _MSC_VER
+	unsigned long r;
+	_BitScanReverse(&r, (unsigned long)x);
+	return r + 1;
+#else
+	return (sizeof(unsigned int) * 8 - __builtin_clz(x));
+#endif
+}
+
+
 /**
  * quote from GCC doc "Returns one plus the index of the least significant 1-bit of x, or if x is zero, returns zero."
  */
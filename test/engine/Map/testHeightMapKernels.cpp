@@ -0,0 +1,237 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "Map/HeightMapKernels.h"
+#include "Sim/Misc/GlobalConstants.h"
+#include "System/Rectangle.h"
+#include "System/TimeProfiler.h"
+#include "System/Misc/SpringTime.h"
+
+#define BOOST_TEST_MODULE HeightMapKernels
+#include <boost/test/unit_test.hpp>
+BOOST_GLOBAL_FIXTURE(InitSpringTime);
+
+
+static constexpr int NUM_MIPMAPS = 7;
+
+static inline float randf() {
+	return rand() / float(RAND_MAX);
+}
+
+template<typename T>
+static bool Equal(const std::vector<T>& a, const std::vector<T>& b) {
+	return (a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+
+// the synced heightmap-derived maps of CReadMap, updated the same way as
+// by CReadMap::UpdateHeightMapSynced but serially and with either kernel
+struct HeightMapSetup {
+	HeightMapSetup(int mapx_, int mapy_): mapx(mapx_), mapy(mapy_) {
+		cornerHeights.resize((mapx + 1) * (mapy + 1));
+		faceNormals.resize(mapx * mapy * 2);
+		centerNormals.resize(mapx * mapy);
+		centerNormals2D.resize(mapx * mapy);
+		slopes.resize((mapx / 2) * (mapy / 2));
+
+		for (int i = 0; i < NUM_MIPMAPS; i++) {
+			mipHeights[i].resize((mapx >> i) * (mapy >> i));
+		}
+
+		// rolling hills with some flat (zero-gradient) patches
+		for (int z = 0; z <= mapy; z++) {
+			for (int x = 0; x <= mapx; x++) {
+				cornerHeights[z * (mapx + 1) + x] = ((x / 16 + z / 16) % 5 == 0)? 0.0f: (randf() * 40.0f + ((x * 7 + z * 3) % 61));
+			}
+		}
+	}
+
+	// lowers the terrain in a bowl around the rectangle's center
+	void Deform(const SRectangle& rect) {
+		const float cx = (rect.x1 + rect.x2) * 0.5f;
+		const float cz = (rect.z1 + rect.z2) * 0.5f;
+		const float radius = std::max(1.0f, (rect.x2 - rect.x1) * 0.5f);
+		const float depth = randf() * 30.0f - 10.0f;
+
+		for (int z = rect.z1; z <= rect.z2; z++) {
+			for (int x = rect.x1; x <= rect.x2; x++) {
+				const float dx = x - cx;
+				const float dz = z - cz;
+
+				cornerHeights[z * (mapx + 1) + x] -= depth * std::max(0.0f, 1.0f - (dx * dx + dz * dz) / (radius * radius));
+			}
+		}
+	}
+
+	void Update(SRectangle rect, bool useSSE) {
+		rect.x1 = std::max(       0, rect.x1 - 1);
+		rect.z1 = std::max(       0, rect.z1 - 1);
+		rect.x2 = std::min(mapx - 1, rect.x2 + 1);
+		rect.z2 = std::min(mapy - 1, rect.z2 + 1);
+
+		for (int y = rect.z1; y <= rect.z2; y++) {
+			const float* hmTop = &cornerHeights[(y    ) * (mapx + 1)];
+			const float* hmBot = &cornerHeights[(y + 1) * (mapx + 1)];
+
+			if (useSSE) {
+				HeightMapKernels::CenterHeightsSSE(hmTop, hmBot, &mipHeights[0][y * mapx], rect.x1, rect.x2);
+			} else {
+				HeightMapKernels::CenterHeightsScalar(hmTop, hmBot, &mipHeights[0][y * mapx], rect.x1, rect.x2);
+			}
+		}
+
+		for (int i = 0; i < NUM_MIPMAPS - 1; i++) {
+			const int hmapx = mapx >> i;
+
+			const int sx = (rect.x1 >> i) & (~1);
+			const int ex = (rect.x2 >> i);
+			const int sy = (rect.z1 >> i) & (~1);
+			const int ey = (rect.z2 >> i);
+
+			for (int y = sy; y < ey; y += 2) {
+				const float* topRow0 = &mipHeights[i][(y    ) * hmapx];
+				const float* topRow1 = &mipHeights[i][(y + 1) * hmapx];
+
+				if (useSSE) {
+					HeightMapKernels::MipHeightsSSE(topRow0, topRow1, &mipHeights[i + 1][(y / 2) * hmapx / 2], sx, ex);
+				} else {
+					HeightMapKernels::MipHeightsScalar(topRow0, topRow1, &mipHeights[i + 1][(y / 2) * hmapx / 2], sx, ex);
+				}
+			}
+		}
+
+		{
+			const int z1 = std::max(       0, rect.z1 - 1);
+			const int x1 = std::max(       0, rect.x1 - 1);
+			const int z2 = std::min(mapy - 1, rect.z2 + 1);
+			const int x2 = std::min(mapx - 1, rect.x2 + 1);
+
+			for (int y = z1; y <= z2; y++) {
+				const float* hmTop = &cornerHeights[(y    ) * (mapx + 1)];
+				const float* hmBot = &cornerHeights[(y + 1) * (mapx + 1)];
+
+				if (useSSE) {
+					HeightMapKernels::FaceNormalsSSE(hmTop, hmBot, &faceNormals[y * mapx * 2], &centerNormals[y * mapx], &centerNormals2D[y * mapx], x1, x2);
+				} else {
+					HeightMapKernels::FaceNormalsScalar(hmTop, hmBot, &faceNormals[y * mapx * 2], &centerNormals[y * mapx], &centerNormals2D[y * mapx], x1, x2);
+				}
+			}
+		}
+
+		{
+			const int sx = std::max(0,              (rect.x1 / 2) - 1);
+			const int ex = std::min(mapx / 2 - 1,   (rect.x2 / 2) + 1);
+			const int sy = std::max(0,              (rect.z1 / 2) - 1);
+			const int ey = std::min(mapy / 2 - 1,   (rect.z2 / 2) + 1);
+
+			for (int y = sy; y <= ey; y++) {
+				const float3* faceNormalRow0 = &faceNormals[(y * 2    ) * mapx * 2];
+				const float3* faceNormalRow1 = &faceNormals[(y * 2 + 1) * mapx * 2];
+
+				if (useSSE) {
+					HeightMapKernels::SlopesSSE(faceNormalRow0, faceNormalRow1, &slopes[y * (mapx / 2)], sx, ex);
+				} else {
+					HeightMapKernels::SlopesScalar(faceNormalRow0, faceNormalRow1, &slopes[y * (mapx / 2)], sx, ex);
+				}
+			}
+		}
+	}
+
+	// a crater-sized rectangle anywhere on the map, clipped at its edges
+	SRectangle RandomRect() const {
+		const int size = 2 + rand() % 48;
+		const int x1 = rand() % mapx - size / 2;
+		const int z1 = rand() % mapy - size / 2;
+
+		return {std::max(0, x1), std::max(0, z1), std::min(mapx, x1 + size), std::min(mapy, z1 + size)};
+	}
+
+	bool operator == (const HeightMapSetup& s) const {
+		for (int i = 0; i < NUM_MIPMAPS; i++) {
+			if (!Equal(mipHeights[i], s.mipHeights[i]))
+				return false;
+		}
+
+		return (Equal(cornerHeights, s.cornerHeights) && Equal(faceNormals, s.faceNormals) && Equal(centerNormals, s.centerNormals) && Equal(centerNormals2D, s.centerNormals2D) && Equal(slopes, s.slopes));
+	}
+
+	int mapx;
+	int mapy;
+
+	std::vector<float> cornerHeights;
+	// mip 0 is the center heightmap
+	std::vector<float> mipHeights[NUM_MIPMAPS];
+	std::vector<float3> faceNormals;
+	std::vector<float3> centerNormals;
+	std::vector<float3> centerNormals2D;
+	std::vector<float> slopes;
+};
+
+
+static void RunDeformations(HeightMapSetup& setup, int numUpdates, bool useSSE, unsigned int seed)
+{
+	srand(seed);
+
+	for (int n = 0; n < numUpdates; n++) {
+		const SRectangle rect = setup.RandomRect();
+
+		setup.Deform(rect);
+		setup.Update(rect, useSSE);
+	}
+}
+
+
+
+BOOST_AUTO_TEST_CASE( HeightMapKernelsIdentity )
+{
+	// 4x4 SMU; the rectangles start and end at arbitrary columns, so every
+	// kernel also runs its scalar tail
+	srand(0); HeightMapSetup scalarSetup(4 * 64, 4 * 64);
+	srand(0); HeightMapSetup vectorSetup(4 * 64, 4 * 64);
+
+	BOOST_CHECK(scalarSetup == vectorSetup);
+
+	scalarSetup.Update({0, 0, scalarSetup.mapx - 1, scalarSetup.mapy - 1}, false);
+	vectorSetup.Update({0, 0, vectorSetup.mapx - 1, vectorSetup.mapy - 1}, true);
+
+	BOOST_CHECK(scalarSetup == vectorSetup);
+
+	for (int n = 0; n < 20; n++) {
+		RunDeformations(scalarSetup, 100, false, n);
+		RunDeformations(vectorSetup, 100, true, n);
+
+		BOOST_CHECK(scalarSetup == vectorSetup);
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE( HeightMapKernelsBenchmark )
+{
+	// 32x32 SMU
+	HeightMapSetup setup(32 * 64, 32 * 64);
+
+	const int numUpdates = 20000;
+	const char* names[] = {"scalar", "SSE"};
+
+	setup.Update({0, 0, setup.mapx - 1, setup.mapy - 1}, false);
+
+	for (int k = 0; k < 2; k++) {
+		const spring_time t0 = spring_gettime();
+
+		{
+			ScopedOnceTimer timer(k? "HeightMapKernels::SSE": "HeightMapKernels::Scalar");
+			RunDeformations(setup, numUpdates, k != 0, k);
+		}
+
+		const float secs = std::max(1e-3f, (spring_gettime() - t0).toSecsf());
+
+		printf("[%s] %s: %d rect-updates in %.3fs (%.0f rect-updates/s)\n", __FUNCTION__, names[k], numUpdates, secs, numUpdates / secs);
+	}
+
+	BOOST_CHECK(true);
+}
@@ -0,0 +1,252 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "Sim/Misc/LosRaycast.h"
+#include "System/TimeProfiler.h"
+#include "System/Misc/SpringTime.h"
+
+#define BOOST_TEST_MODULE LosRaycast
+#include <boost/test/unit_test.hpp>
+BOOST_GLOBAL_FIXTURE(InitSpringTime);
+
+
+static inline float randf() {
+	return rand() / float(RAND_MAX);
+}
+
+
+// verbatim copy of the ray loops CLosMap::{Unsafe,Safe}LosAdd ran before the
+// LosRaycast kernels existed (modulo table access), the ground truth for both
+namespace LegacyLosMap {
+	inline static constexpr size_t ToAngleMapIdx(const int2 p, const int radius)
+	{
+		// [-radius, +radius]^2 -> [0, +2*radius]^2 -> idx
+		return (p.y + radius) * (2 * radius + 1) + (p.x + radius);
+	}
+
+	inline void CastLos(
+		float* prvAngle,
+		float* maxAngle,
+		const int2& off,
+		char* losRaySquares,
+		const float* raycastAngles,
+		const float* invRadii,
+		int losRadius
+	) {
+		const size_t oidx = ToAngleMapIdx(off, losRadius);
+
+		// angle to square is smaller than current max-angle, so not visible
+		if (raycastAngles[oidx] < *maxAngle) {
+			losRaySquares[oidx] = false;
+			return;
+		}
+
+		if (raycastAngles[oidx] < *prvAngle) {
+			const float invR = invRadii[off.x * off.x + off.y * off.y];
+			const float angle = *prvAngle - LOS_BONUS_HEIGHT * invR;
+
+			if (raycastAngles[oidx] < (*maxAngle = angle)) {
+				losRaySquares[oidx] = false;
+				return;
+			}
+		}
+
+		*prvAngle = raycastAngles[oidx];
+	}
+
+	void CastRotatedRay(
+		const int2* squares,
+		size_t numSquares,
+		const float* invRadii,
+		const float* raycastAngles,
+		char* losRaySquares,
+		int radius,
+		int2 pos,
+		const SRectangle& safeRect,
+		int clipMode
+	) {
+		float maxAngles[4] = {-1e7, -1e7, -1e7, -1e7};
+		float prvAngles[4] = {-1e7, -1e7, -1e7, -1e7};
+
+		switch (clipMode) {
+			case LosRaycast::CLIP_NONE: {
+				for (size_t n = 0; n < numSquares; n++) {
+					const int2 square = squares[n];
+
+					CastLos(&prvAngles[0], &maxAngles[0],       square              , losRaySquares, raycastAngles, invRadii, radius);
+					CastLos(&prvAngles[1], &maxAngles[1],      -square              , losRaySquares, raycastAngles, invRadii, radius);
+					CastLos(&prvAngles[2], &maxAngles[2], int2( square.y, -square.x), losRaySquares, raycastAngles, invRadii, radius);
+					CastLos(&prvAngles[3], &maxAngles[3], int2(-square.y,  square.x), losRaySquares, raycastAngles, invRadii, radius);
+				}
+			} break;
+
+			case LosRaycast::CLIP_BREAK: {
+				for (size_t n = 0; n < numSquares; n++) {
+					const int2 square = squares[n];
+
+					if (!safeRect.Inside(pos + square))
+						break;
+
+					CastLos(&prvAngles[0], &maxAngles[0],  square,                   losRaySquares, raycastAngles, invRadii, radius);
+				}
+				for (size_t n = 0; n < numSquares; n++) {
+					const int2 square = squares[n];
+
+					if (!safeRect.Inside(pos - square))
+						break;
+
+					CastLos(&prvAngles[1], &maxAngles[1], -square,                   losRaySquares, raycastAngles, invRadii, radius);
+				}
+				for (size_t n = 0; n < numSquares; n++) {
+					const int2 square = squares[n];
+
+					if (!safeRect.Inside(pos + int2(square.y, -square.x)))
+						break;
+
+					CastLos(&prvAngles[2], &maxAngles[2], int2(square.y, -square.x), losRaySquares, raycastAngles, invRadii, radius);
+				}
+				for (size_t n = 0; n < numSquares; n++) {
+					const int2 square = squares[n];
+
+					if (!safeRect.Inside(pos + int2(-square.y, square.x)))
+						break;
+
+					CastLos(&prvAngles[3], &maxAngles[3], int2(-square.y, square.x), losRaySquares, raycastAngles, invRadii, radius);
+				}
+			} break;
+
+			case LosRaycast::CLIP_SKIP: {
+				for (size_t n = 0; n < numSquares; n++) {
+					const int2 square = squares[n];
+
+					if (safeRect.Inside(pos + square))
+						CastLos(&prvAngles[0], &maxAngles[0],  square,                   losRaySquares, raycastAngles, invRadii, radius);
+
+					if (safeRect.Inside(pos - square))
+						CastLos(&prvAngles[1], &maxAngles[1], -square,                   losRaySquares, raycastAngles, invRadii, radius);
+
+					if (safeRect.Inside(pos + int2(square.y, -square.x)))
+						CastLos(&prvAngles[2], &maxAngles[2], int2(square.y, -square.x), losRaySquares, raycastAngles, invRadii, radius);
+
+					if (safeRect.Inside(pos + int2(-square.y, square.x)))
+						CastLos(&prvAngles[3], &maxAngles[3], int2(-square.y, square.x), losRaySquares, raycastAngles, invRadii, radius);
+				}
+			} break;
+		}
+	}
+}
+
+
+struct LosTestSetup {
+	LosTestSetup(int radius_, int2 pos_, const SRectangle& mapRect_): radius(radius_), pos(pos_), mapRect(mapRect_) {
+		const int size = 2 * radius + 1;
+
+		angles.resize(size * size);
+		invRadii.resize((radius + 1) * (radius + 1) * 2 + 1);
+
+		for (size_t r = 0; r < invRadii.size(); r++) {
+			invRadii[r] = 1.0f / std::sqrt(std::max(r, size_t(1)) * 1.0f);
+		}
+
+		// rough terrain, so rays both climb and get occluded
+		for (int y = -radius; y <= radius; y++) {
+			for (int x = -radius; x <= radius; x++) {
+				const float dh = (randf() - 0.5f) * 200.0f;
+				const float invR = invRadii[x * x + y * y];
+
+				angles[(y + radius) * size + (x + radius)] = (dh + LOS_BONUS_HEIGHT) * invR;
+			}
+		}
+
+		// upper-right sector rays towards the circle's surface (DDA)
+		for (int i = 0; i <= 2 * radius; i++) {
+			const int2 end = (i <= radius)? int2(i, radius): int2(radius, 2 * radius - i);
+			const int steps = std::max(end.x, end.y);
+
+			rays.emplace_back();
+
+			for (int s = 1; s <= steps; s++) {
+				const int2 sq(std::lround(end.x * s / float(steps)), std::lround(end.y * s / float(steps)));
+
+				if ((sq.x * sq.x + sq.y * sq.y) > (radius * radius))
+					break;
+
+				rays.back().push_back(sq);
+			}
+		}
+	}
+
+	template<typename F>
+	std::vector<char> Cast(F&& castFunc, int clipMode) const {
+		std::vector<char> visible(angles.size(), true);
+
+		for (const std::vector<int2>& ray: rays) {
+			castFunc(ray.data(), ray.size(), invRadii.data(), angles.data(), visible.data(), radius, pos, mapRect, clipMode);
+		}
+
+		return visible;
+	}
+
+	int radius;
+	int2 pos;
+	SRectangle mapRect;
+
+	std::vector<float> angles;
+	std::vector<float> invRadii;
+	std::vector< std::vector<int2> > rays;
+};
+
+
+
+BOOST_AUTO_TEST_CASE( LosRaycastBitIdentical )
+{
+	srand(0);
+
+	const SRectangle mapRect(0, 0, 256, 256);
+	const int2 positions[] = {int2(128, 128), int2(10, 20), int2(250, 5), int2(-20, 100), int2(300, 300)};
+	const int clipModes[] = {LosRaycast::CLIP_NONE, LosRaycast::CLIP_BREAK, LosRaycast::CLIP_SKIP, LosRaycast::CLIP_SKIP, LosRaycast::CLIP_SKIP};
+
+	for (int radius = 1; radius <= 64; radius += 7) {
+		for (size_t i = 0; i < (sizeof(positions) / sizeof(positions[0])); i++) {
+			const LosTestSetup setup(radius, positions[i], mapRect);
+
+			const std::vector<char> legacySquares = setup.Cast(LegacyLosMap::CastRotatedRay, clipModes[i]);
+			const std::vector<char> scalarSquares = setup.Cast(LosRaycast::CastRotatedRayScalar, clipModes[i]);
+			const std::vector<char> simdSquares = setup.Cast(LosRaycast::CastRotatedRaySSE, clipModes[i]);
+
+			BOOST_CHECK_MESSAGE(legacySquares == scalarSquares, "scalar radius=" << radius << " clipMode=" << clipModes[i]);
+			BOOST_CHECK_MESSAGE(legacySquares == simdSquares, "SSE radius=" << radius << " clipMode=" << clipModes[i]);
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE( LosRaycastBenchmark )
+{
+	srand(0);
+
+	const int iterations = 200;
+	const LosTestSetup setup(96, int2(512, 512), SRectangle(0, 0, 1024, 1024));
+
+	size_t hash[2] = {0, 0};
+
+	{
+		ScopedOnceTimer timer("LosRaycast::CastRotatedRayScalar");
+		for (int n = 0; n < iterations; n++) {
+			const std::vector<char> squares = setup.Cast(LosRaycast::CastRotatedRayScalar, LosRaycast::CLIP_NONE);
+			hash[0] += std::count(squares.begin(), squares.end(), true);
+		}
+	}
+	{
+		ScopedOnceTimer timer("LosRaycast::CastRotatedRaySSE");
+		for (int n = 0; n < iterations; n++) {
+			const std::vector<char> squares = setup.Cast(LosRaycast::CastRotatedRaySSE, LosRaycast::CLIP_NONE);
+			hash[1] += std::count(squares.begin(), squares.end(), true);
+		}
+	}
+
+	BOOST_CHECK(hash[0] == hash[1]);
+}
@@ -98,3 +98,37 @@ BOOST_AUTO_TEST_CASE( QuadField )
 
 	BOOST_CHECK_MESSAGE(!fail, "Too less quads returned!");
 }
+
+
+BOOST_AUTO_TEST_CASE( QuadFieldOccupancy )
+{
+	// 64x64 squares = 512x512 elmos = 4x4 base quads
+	quadField.Init(int2(64, 64), CQuadField::BASE_QUAD_SIZE);
+
+	BOOST_CHECK(quadField.IsValidQuadSize(CQuadField::MIN_QUAD_SIZE));
+	BOOST_CHECK(quadField.IsValidQuadSize(CQuadField::BASE_QUAD_SIZE));
+	BOOST_CHECK(quadField.IsValidQuadSize(CQuadField::MAX_QUAD_SIZE));
+	BOOST_CHECK(!quadField.IsValidQuadSize(CQuadField::MIN_QUAD_SIZE / 2));
+	BOOST_CHECK(!quadField.IsValidQuadSize(CQuadField::MAX_QUAD_SIZE * 2));
+	BOOST_CHECK(!quadField.IsValidQuadSize(CQuadField::BASE_QUAD_SIZE + SQUARE_SIZE));
+
+	BOOST_CHECK(quadField.RequestResize(CQuadField::BASE_QUAD_SIZE * 2));
+	BOOST_CHECK(!quadField.RequestResize(CQuadField::BASE_QUAD_SIZE * 3));
+
+	CQuadField::OccupancyStats stats;
+	quadField.GetOccupancyStats(stats);
+
+	const unsigned int numQuads = quadField.GetNumQuadsX() * quadField.GetNumQuadsZ();
+
+	BOOST_CHECK(numQuads == 16);
+	BOOST_CHECK(stats.numOccupiedQuads == 0);
+	BOOST_CHECK(quadField.GetLoadFactor() == 0.0f);
+
+	for (unsigned int i = 0; i < CQuadField::QUAD_OBJECT_TYPES; i++) {
+		BOOST_CHECK(stats.histograms[i][0] == numQuads);
+		BOOST_CHECK(stats.maxCounts[i] == 0);
+		BOOST_CHECK(stats.sumCounts[i] == 0);
+	}
+
+	quadField.Kill();
+}
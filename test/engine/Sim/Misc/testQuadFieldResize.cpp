@@ -0,0 +1,297 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+// CQuadField::Resize only exists in non-UNIT_TEST builds, where the field
+// stores real sim-objects; this test compiles QuadField.cpp in that mode but
+// substitutes minimal stand-ins for the object types and the globals it uses
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "System/float3.h"
+#include "System/float4.h"
+#include "System/myMath.h"
+
+// keep the real headers out, everything QuadField.cpp needs of them follows
+#define MOD_INFO_H
+#define _FEATURE_H
+#define PROJECTILE_H
+#define UNIT_H
+#define UNITHANDLER_H
+#define PLASMAREPULSER_H
+#define COLLISION_VOLUME_H
+#define _GLOBAL_SYNCED_H
+#define TEAMHANDLER_H
+
+class CSolidObject;
+
+class CCollisionVolume {
+public:
+	float GetBoundingRadius() const { return boundingRadius; }
+	float3 GetWorldSpacePos(const CSolidObject* o, const float3& extOffsets = ZeroVector) const;
+
+	float boundingRadius = 0.0f;
+};
+
+class CSolidObject {
+public:
+	bool HasPhysicalStateBit(unsigned int bit) const { return ((physicalState & bit) != 0); }
+	bool HasCollidableStateBit(unsigned int bit) const { return ((collidableState & bit) != 0); }
+
+	int id = -1;
+	int tempNum = 0;
+
+	float3 pos;
+	float radius = 0.0f;
+
+	unsigned int physicalState = 1;
+	unsigned int collidableState = 1;
+
+	CCollisionVolume collisionVolume;
+};
+
+float3 CCollisionVolume::GetWorldSpacePos(const CSolidObject* o, const float3& extOffsets) const { return (o->pos + extOffsets); }
+
+class CUnit: public CSolidObject {
+public:
+	int allyteam = 0;
+	std::vector<int> quads;
+};
+
+class CFeature: public CSolidObject {
+};
+
+class CProjectile {
+public:
+	int id = -1;
+
+	float3 pos;
+	float3 dir;
+	float4 speed;
+	float radius = 0.0f;
+
+	bool synced = true;
+	bool hitscan = false;
+
+	std::vector<int> quads;
+};
+
+class CPlasmaRepulser {
+public:
+	float GetRadius() const { return radius; }
+
+	const std::vector<int>& GetQuads() const { return quads; }
+	void SetQuads(std::vector<int>&& q) { quads = std::move(q); }
+	void ClearQuads() { quads.clear(); }
+
+	float3 weaponMuzzlePos;
+	float radius = 0.0f;
+
+	CCollisionVolume collisionVolume;
+	std::vector<int> quads;
+};
+
+static struct {
+	int ActiveAllyTeams() const { return 2; }
+} teamHandlerStub, *teamHandler = &teamHandlerStub;
+
+static struct {
+	int GetTempNum() { return tempNum++; }
+
+	int frameNum = 0;
+	int tempNum = 1;
+} gsStub, *gs = &gsStub;
+
+static struct {
+	float quadFieldMaxLoadFactor = 0.0f;
+} modInfo;
+
+static struct {
+	CUnit* GetUnit(int id) const { return nullptr; }
+} unitHandler;
+
+#include "Sim/Units/UnitHotState.h"
+CUnitHotState unitHotState;
+
+#undef UNIT_TEST
+#include "Sim/Misc/QuadField.cpp"
+
+// read by Resize, normally owned by the map
+MapDimensions mapDims;
+
+#define BOOST_TEST_MODULE QuadFieldResize
+#include <boost/test/unit_test.hpp>
+
+
+static constexpr int MAP_SQUARES = 64;
+
+static float randf() { return (rand() / float(RAND_MAX)); }
+static float3 randpos() { return {randf() * MAP_SQUARES * SQUARE_SIZE, randf() * 100.0f, randf() * MAP_SQUARES * SQUARE_SIZE}; }
+
+template<typename T>
+static std::vector<int> GetIDs(const std::vector<T*>* objects)
+{
+	std::vector<int> ids;
+
+	for (const T* o: *objects) {
+		ids.push_back(o->id);
+	}
+
+	std::sort(ids.begin(), ids.end());
+	return ids;
+}
+
+// the (sorted) IDs returned by every kind of query around a fixed set of points
+static std::vector< std::vector<int> > RunQueries()
+{
+	std::vector< std::vector<int> > results;
+
+	srand(1);
+
+	for (int n = 0; n < 50; n++) {
+		const float3 pos = randpos();
+		const float radius = randf() * 200.0f;
+		const float3 mins = {pos.x - radius, 0.0f, pos.z - radius * 0.5f};
+		const float3 maxs = {pos.x + radius, 0.0f, pos.z + radius * 0.5f};
+
+		{
+			QuadFieldQuery qfQuery;
+			quadField.GetUnitsExact(qfQuery, pos, radius, n & 1);
+			results.push_back(GetIDs(qfQuery.units));
+		}
+		{
+			QuadFieldQuery qfQuery;
+			quadField.GetUnitsExact(qfQuery, mins, maxs);
+			results.push_back(GetIDs(qfQuery.units));
+		}
+		{
+			QuadFieldQuery qfQuery;
+			quadField.GetFeaturesExact(qfQuery, pos, radius, n & 1);
+			results.push_back(GetIDs(qfQuery.features));
+		}
+		{
+			QuadFieldQuery qfQuery;
+			quadField.GetProjectilesExact(qfQuery, pos, radius);
+			results.push_back(GetIDs(qfQuery.projectiles));
+		}
+		{
+			QuadFieldQuery qfQuery;
+			quadField.GetSolidsExact(qfQuery, pos, radius);
+			results.push_back(GetIDs(qfQuery.solids));
+		}
+		{
+			std::vector<CUnit*> units;
+			std::vector<CFeature*> features;
+			std::vector<CPlasmaRepulser*> repulsers;
+
+			quadField.GetUnitsAndFeaturesColVol(pos, radius, units, features, &repulsers);
+			results.push_back(GetIDs(&units));
+			results.push_back(GetIDs(&features));
+			results.push_back({int(repulsers.size())});
+		}
+	}
+
+	return results;
+}
+
+// every object must be listed by exactly the quads it remembers
+static bool QuadsConsistent(const std::vector<CUnit>& units, const std::vector<CProjectile>& projectiles)
+{
+	const int numQuads = quadField.GetNumQuadsX() * quadField.GetNumQuadsZ();
+
+	for (int qi = 0; qi < numQuads; qi++) {
+		const CQuadField::Quad& quad = quadField.GetQuad(qi);
+
+		for (const CUnit& u: units) {
+			const bool inQuad = (std::find(quad.units.begin(), quad.units.end(), &u) != quad.units.end());
+			const bool inList = (std::find(u.quads.begin(), u.quads.end(), qi) != u.quads.end());
+
+			if (inQuad != inList)
+				return false;
+		}
+		for (const CProjectile& p: projectiles) {
+			const bool inQuad = (std::find(quad.projectiles.begin(), quad.projectiles.end(), &p) != quad.projectiles.end());
+			const bool inList = (std::find(p.quads.begin(), p.quads.end(), qi) != p.quads.end());
+
+			if (inQuad != inList)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+
+BOOST_AUTO_TEST_CASE( QuadFieldResize )
+{
+	mapDims.mapx = MAP_SQUARES;
+	mapDims.mapy = MAP_SQUARES;
+
+	float3::maxxpos = MAP_SQUARES * SQUARE_SIZE - 1;
+	float3::maxzpos = MAP_SQUARES * SQUARE_SIZE - 1;
+
+	// 64x64 squares = 512x512 elmos = 4x4 base quads
+	quadField.Init(int2(MAP_SQUARES, MAP_SQUARES), CQuadField::BASE_QUAD_SIZE);
+
+	std::vector<CUnit> units(60);
+	std::vector<CFeature> features(30);
+	std::vector<CProjectile> projectiles(30);
+	std::vector<CPlasmaRepulser> repulsers(3);
+
+	srand(0);
+
+	for (size_t i = 0; i < units.size(); i++) {
+		units[i].id = i;
+		units[i].pos = randpos();
+		units[i].radius = 4.0f + randf() * 60.0f;
+		units[i].allyteam = i & 1;
+		units[i].collisionVolume.boundingRadius = units[i].radius;
+		quadField.MovedUnit(&units[i]);
+	}
+	for (size_t i = 0; i < features.size(); i++) {
+		// IDs shared with units, as for real sim-objects
+		features[i].id = i;
+		features[i].pos = randpos();
+		features[i].radius = 4.0f + randf() * 60.0f;
+		features[i].collisionVolume.boundingRadius = features[i].radius;
+		quadField.AddFeature(&features[i]);
+	}
+	for (size_t i = 0; i < projectiles.size(); i++) {
+		projectiles[i].id = i;
+		projectiles[i].pos = randpos();
+		projectiles[i].radius = 1.0f + randf() * 4.0f;
+		quadField.AddProjectile(&projectiles[i]);
+	}
+	for (size_t i = 0; i < repulsers.size(); i++) {
+		repulsers[i].weaponMuzzlePos = randpos();
+		repulsers[i].radius = 100.0f + randf() * 100.0f;
+		repulsers[i].collisionVolume.boundingRadius = repulsers[i].radius;
+		quadField.MovedRepulser(&repulsers[i]);
+	}
+
+	const std::vector< std::vector<int> > baseResults = RunQueries();
+
+	BOOST_CHECK(QuadsConsistent(units, projectiles));
+	BOOST_CHECK(quadField.GetLoadFactor() > 0.0f);
+
+	// finer and coarser than the base size; Update applies the request
+	for (const unsigned int quadSize: {CQuadField::MIN_QUAD_SIZE, CQuadField::MAX_QUAD_SIZE, CQuadField::BASE_QUAD_SIZE}) {
+		BOOST_CHECK(quadField.RequestResize(quadSize));
+		quadField.Update();
+
+		const unsigned int numQuads = (MAP_SQUARES * SQUARE_SIZE) / quadSize;
+
+		BOOST_CHECK(quadField.GetQuadSizeX() == int(quadSize));
+		BOOST_CHECK(quadField.GetNumQuadsX() == int(numQuads));
+		BOOST_CHECK(quadField.GetNumQuadsZ() == int(numQuads));
+
+		BOOST_CHECK(QuadsConsistent(units, projectiles));
+		BOOST_CHECK(RunQueries() == baseResults);
+
+		for (const CPlasmaRepulser& r: repulsers) {
+			BOOST_CHECK(!r.quads.empty());
+		}
+	}
+
+	quadField.Kill();
+}
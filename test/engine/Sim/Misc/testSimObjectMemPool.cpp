@@ -0,0 +1,87 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "Sim/Misc/SimObjectMemPool.h"
+#include "System/TimeProfiler.h"
+#include "System/Misc/SpringTime.h"
+
+#define BOOST_TEST_MODULE SimObjectMemPool
+#include <boost/test/unit_test.hpp>
+BOOST_GLOBAL_FIXTURE(InitSpringTime);
+
+
+struct TestObject {
+	TestObject(int v): value(v) {}
+
+	int value;
+	int zeroed; // never initialized, must come out of the pool as 0
+	char payload[200];
+};
+
+// objects are churned in random order, as projectiles would be
+template<typename Pool>
+static void CheckPool(Pool& pool, int numObjects, int numOps)
+{
+	std::vector<TestObject*> objs(numObjects, nullptr);
+
+	srand(0);
+
+	for (int n = 0; n < numOps; n++) {
+		TestObject*& obj = objs[rand() % numObjects];
+
+		if (obj != nullptr) {
+			BOOST_CHECK(pool.mapped(obj));
+			obj->zeroed = 1;
+			pool.free(obj);
+			continue;
+		}
+
+		obj = pool.template alloc<TestObject>(n);
+
+		BOOST_CHECK(pool.alloced(obj));
+		BOOST_CHECK(obj->value == n && obj->zeroed == 0);
+	}
+
+	size_t numLive = 0;
+
+	for (const TestObject* obj: objs) {
+		numLive += (obj != nullptr);
+	}
+
+	BOOST_CHECK(pool.live_count() == numLive);
+	BOOST_CHECK(pool.peak_count() <= size_t(numObjects));
+	BOOST_CHECK(pool.peak_count() >= numLive);
+	BOOST_CHECK(pool.alloc_size() == (pool.live_count() * pool.page_size() + pool.freed_size()));
+
+	for (TestObject*& obj: objs) {
+		if (obj != nullptr) {
+			pool.free(obj);
+		}
+	}
+
+	BOOST_CHECK(pool.live_count() == 0);
+	BOOST_CHECK(pool.frag_ratio() == 1.0f);
+}
+
+
+
+BOOST_AUTO_TEST_CASE( DynMemPoolChurn )
+{
+	DynMemPool<sizeof(TestObject) + 16> pool;
+	pool.reserve(1024);
+
+	ScopedOnceTimer timer("SimObjectMemPool::DynMemPool");
+	CheckPool(pool, 4096, 2000000);
+}
+
+BOOST_AUTO_TEST_CASE( StaticMemPoolChurn )
+{
+	std::unique_ptr< StaticMemPool<4096, sizeof(TestObject) + 16> > pool(new StaticMemPool<4096, sizeof(TestObject) + 16>());
+
+	ScopedOnceTimer timer("SimObjectMemPool::StaticMemPool");
+	CheckPool(*pool, 4096, 2000000);
+}
@@ -0,0 +1,155 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "Sim/Path/Default/PathFlatCache.h"
+#include "System/Misc/SpringTime.h"
+
+#define BOOST_TEST_MODULE PathFlatCache
+#include <boost/test/unit_test.hpp>
+BOOST_GLOBAL_FIXTURE(InitSpringTime);
+
+
+static const std::string CACHE_FILE = "testPathFlatCache.bin";
+
+struct CacheData {
+	CacheData() {
+		srand(0);
+
+		layout.hashCode = 0x12345678;
+		layout.blockSize = 16;
+		layout.numPathTypes = 3;
+		layout.numBlocks = 32 * 32;
+		// enough to span a few pages, see FLAT_CACHE_ALIGNMENT
+		layout.numVertexCosts = layout.numBlocks * 8 * layout.numPathTypes;
+
+		offsets.resize(layout.numPathTypes, std::vector<short2>(layout.numBlocks));
+		vertexCosts.resize(layout.numVertexCosts);
+
+		for (std::vector<short2>& pathTypeOffsets: offsets) {
+			for (short2& offset: pathTypeOffsets) {
+				offset = short2(rand() % 16, rand() % 16);
+			}
+		}
+		for (float& cost: vertexCosts) {
+			cost = rand() / float(RAND_MAX) * 100.0f;
+		}
+
+		std::vector<short2> flatOffsets;
+
+		for (const std::vector<short2>& pathTypeOffsets: offsets) {
+			flatOffsets.insert(flatOffsets.end(), pathTypeOffsets.begin(), pathTypeOffsets.end());
+		}
+
+		checksum = CPathFlatCache::CalcChecksum(layout, flatOffsets.data(), vertexCosts.data());
+	}
+
+	bool Write() const { return CPathFlatCache::Write(CACHE_FILE, layout, checksum, offsets, vertexCosts.data()); }
+
+	CPathFlatCache::Layout layout;
+
+	std::vector< std::vector<short2> > offsets;
+	std::vector<float> vertexCosts;
+
+	std::uint32_t checksum;
+};
+
+// flips one byte of the cache-file at <pos> (from the end if negative)
+static void CorruptFile(long pos)
+{
+	FILE* file = fopen(CACHE_FILE.c_str(), "r+b");
+	BOOST_REQUIRE(file != nullptr);
+
+	fseek(file, pos, (pos < 0)? SEEK_END: SEEK_SET);
+	const int c = fgetc(file);
+	fseek(file, -1, SEEK_CUR);
+	fputc(c ^ 0xFF, file);
+	fclose(file);
+}
+
+
+
+BOOST_AUTO_TEST_CASE( RoundTrip )
+{
+	const CacheData data;
+	BOOST_REQUIRE(data.Write());
+
+	CPathFlatCache cache;
+	BOOST_REQUIRE(cache.Map(CACHE_FILE, data.layout));
+	BOOST_CHECK(cache.IsMapped());
+	BOOST_CHECK(cache.GetChecksum() == data.checksum);
+
+	for (unsigned int pathType = 0; pathType < data.layout.numPathTypes; pathType++) {
+		BOOST_CHECK(std::memcmp(cache.GetOffsets(pathType), data.offsets[pathType].data(), data.layout.numBlocks * sizeof(short2)) == 0);
+	}
+
+	float* costs = cache.GetVertexCosts();
+
+	BOOST_CHECK((reinterpret_cast<std::uintptr_t>(costs) % 4096) == 0);
+	BOOST_CHECK(std::memcmp(costs, data.vertexCosts.data(), data.layout.numVertexCosts * sizeof(float)) == 0);
+
+	// the mapping is private, changes must not reach the file
+	costs[0] += 1.0f;
+	cache.Close();
+
+	BOOST_CHECK(cache.Map(CACHE_FILE, data.layout));
+	BOOST_CHECK(cache.GetVertexCosts()[0] == data.vertexCosts[0]);
+	cache.Close();
+
+	std::remove(CACHE_FILE.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( ChecksumMismatch )
+{
+	const CacheData data;
+	CPathFlatCache cache;
+
+	// last vertex-cost
+	BOOST_REQUIRE(data.Write());
+	CorruptFile(-1);
+	BOOST_CHECK(!cache.Map(CACHE_FILE, data.layout));
+	BOOST_CHECK(!cache.IsMapped());
+
+	// first offset, right after the header
+	BOOST_REQUIRE(data.Write());
+	BOOST_REQUIRE(cache.Map(CACHE_FILE, data.layout));
+	cache.Close();
+	CorruptFile(64);
+	BOOST_CHECK(!cache.Map(CACHE_FILE, data.layout));
+
+	std::remove(CACHE_FILE.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( LayoutMismatch )
+{
+	const CacheData data;
+	CPathFlatCache cache;
+
+	BOOST_REQUIRE(data.Write());
+
+	CPathFlatCache::Layout layouts[4] = {data.layout, data.layout, data.layout, data.layout};
+	layouts[0].hashCode += 1;
+	layouts[1].blockSize *= 2;
+	layouts[2].numPathTypes -= 1;
+	layouts[3].numVertexCosts -= 1;
+
+	for (const CPathFlatCache::Layout& layout: layouts) {
+		BOOST_CHECK(!cache.Map(CACHE_FILE, layout));
+	}
+
+	// truncated file
+	BOOST_CHECK(cache.Map(CACHE_FILE, data.layout));
+	cache.Close();
+
+	FILE* file = fopen(CACHE_FILE.c_str(), "wb");
+	BOOST_REQUIRE(file != nullptr);
+	fclose(file);
+
+	BOOST_CHECK(!cache.Map(CACHE_FILE, data.layout));
+
+	std::remove(CACHE_FILE.c_str());
+}
@@ -0,0 +1,349 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "Sim/Path/Default/PathDataTypes.h"
+#include "Sim/Path/QTPFS/NodeHeap.hpp"
+#include "System/TimeProfiler.h"
+#include "System/Misc/SpringTime.h"
+
+#define BOOST_TEST_MODULE PathQueues
+#include <boost/test/unit_test.hpp>
+BOOST_GLOBAL_FIXTURE(InitSpringTime);
+
+
+// synthetic stand-in for a real map: a grid of integer move-costs (so that
+// path-costs are exact and independent of expansion order) with impassable
+// ridges, plus a fixed list of path requests replayed against it
+struct PathWorkload {
+	PathWorkload(int size_, int numRequests): size(size_) {
+		srand(0);
+
+		costs.resize(size * size);
+
+		for (int z = 0; z < size; z++) {
+			for (int x = 0; x < size; x++) {
+				const bool ridge = ((x % 37) == 11 && (z % 53) > 4) || ((z % 29) == 7 && (x % 41) > 3);
+				costs[z * size + x] = ridge? 0: (1 + (rand() % 4));
+			}
+		}
+
+		for (int n = 0; n < numRequests; n++) {
+			requests.emplace_back(rand() % (size * size), rand() % (size * size));
+		}
+	}
+
+	bool Passable(int idx) const { return (costs[idx] != 0); }
+
+	// octile distance with minimum move-cost, consistent with MoveCost
+	float Heuristic(int idx, int goal) const {
+		const int dx = std::abs((idx % size) - (goal % size));
+		const int dz = std::abs((idx / size) - (goal / size));
+		return (14.0f * std::min(dx, dz) + 10.0f * (std::max(dx, dz) - std::min(dx, dz)));
+	}
+
+	float MoveCost(int idx, int dir) const { return (((dir & 1) != 0)? 14.0f: 10.0f) * costs[idx]; }
+
+	// neighbor in one of the 8 directions, or -1
+	int Neighbor(int idx, int dir) const {
+		static const int dirs[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+
+		const int x = (idx % size) + dirs[dir][0];
+		const int z = (idx / size) + dirs[dir][1];
+
+		if (x < 0 || z < 0 || x >= size || z >= size)
+			return -1;
+
+		return (z * size + x);
+	}
+
+	int size;
+
+	std::vector<int> costs;
+	std::vector< std::pair<int, int> > requests;
+};
+
+struct SearchStats {
+	float costSum = 0.0f;
+	size_t numExpanded = 0;
+	size_t numFound = 0;
+};
+
+
+
+// A* in the style of CPathFinder: every push allocates a fresh node and
+// outdated queue entries are skipped when popped
+template<typename Queue>
+static SearchStats RunDefaultSearches(const PathWorkload& wl, Queue& queue)
+{
+	SearchStats stats;
+
+	std::vector<float> gCosts(wl.size * wl.size);
+	std::vector<PathNode> nodes;
+	nodes.reserve(MAX_SEARCHED_NODES);
+
+	for (const auto& req: wl.requests) {
+		if (!wl.Passable(req.first) || !wl.Passable(req.second))
+			continue;
+
+		std::fill(gCosts.begin(), gCosts.end(), PATHCOST_INFINITY);
+		nodes.clear();
+		queue.Clear();
+
+		nodes.emplace_back();
+		nodes.back().fCost = wl.Heuristic(req.first, req.second);
+		nodes.back().nodeNum = req.first;
+
+		gCosts[req.first] = 0.0f;
+		queue.push(&nodes.back());
+
+		// PathPriorityQueue holds at most MAX_SEARCHED_NODES entries
+		while (!queue.empty() && nodes.size() < (MAX_SEARCHED_NODES - 8)) {
+			const PathNode* n = queue.top();
+			queue.pop();
+
+			if (n->gCost != gCosts[n->nodeNum])
+				continue;
+
+			stats.numExpanded += 1;
+
+			if (n->nodeNum == req.second) {
+				stats.costSum += n->gCost;
+				stats.numFound += 1;
+				break;
+			}
+
+			for (int dir = 0; dir < 8; dir++) {
+				const int ngb = wl.Neighbor(n->nodeNum, dir);
+
+				if (ngb < 0 || !wl.Passable(ngb))
+					continue;
+
+				const float g = n->gCost + wl.MoveCost(ngb, dir);
+
+				if (g >= gCosts[ngb])
+					continue;
+
+				gCosts[ngb] = g;
+
+				nodes.emplace_back();
+				nodes.back().fCost = g + wl.Heuristic(ngb, req.second);
+				nodes.back().gCost = g;
+				nodes.back().nodeNum = ngb;
+
+				queue.push(&nodes.back());
+			}
+		}
+	}
+
+	return stats;
+}
+
+
+struct HeapNode {
+	void SetHeapIndex(unsigned int n) { heapIndex = n; }
+	unsigned int GetHeapIndex() const { return heapIndex; }
+	float GetHeapPriority() const { return fCost; }
+
+	bool operator <  (const HeapNode* n) const { return (fCost <  n->fCost); }
+	bool operator >  (const HeapNode* n) const { return (fCost >  n->fCost); }
+	bool operator == (const HeapNode* n) const { return (fCost == n->fCost); }
+	bool operator <= (const HeapNode* n) const { return (fCost <= n->fCost); }
+	bool operator >= (const HeapNode* n) const { return (fCost >= n->fCost); }
+
+	float fCost;
+	float gCost;
+
+	unsigned int heapIndex;
+	unsigned int state;
+};
+
+// A* in the style of QTPFS::PathSearch: one node per square, open nodes
+// whose cost drops are resorted in place
+template<typename Heap>
+static SearchStats RunQTPFSSearches(const PathWorkload& wl, Heap& heap)
+{
+	SearchStats stats;
+
+	std::vector<HeapNode> nodes(wl.size * wl.size);
+
+	enum { STATE_NEW = 0, STATE_OPEN = 1, STATE_CLOSED = 2 };
+
+	heap.reserve(nodes.size());
+
+	for (const auto& req: wl.requests) {
+		if (!wl.Passable(req.first) || !wl.Passable(req.second))
+			continue;
+
+		for (HeapNode& n: nodes) {
+			n.state = STATE_NEW;
+		}
+
+		heap.reset();
+
+		nodes[req.first].gCost = 0.0f;
+		nodes[req.first].fCost = wl.Heuristic(req.first, req.second);
+		nodes[req.first].state = STATE_OPEN;
+
+		heap.push(&nodes[req.first]);
+
+		while (!heap.empty()) {
+			HeapNode* n = heap.top();
+			heap.pop();
+
+			const int idx = n - &nodes[0];
+
+			n->state = STATE_CLOSED;
+			stats.numExpanded += 1;
+
+			if (idx == req.second) {
+				stats.costSum += n->gCost;
+				stats.numFound += 1;
+				break;
+			}
+
+			for (int dir = 0; dir < 8; dir++) {
+				const int ngb = wl.Neighbor(idx, dir);
+
+				if (ngb < 0 || !wl.Passable(ngb))
+					continue;
+
+				HeapNode& nn = nodes[ngb];
+
+				const float g = n->gCost + wl.MoveCost(ngb, dir);
+
+				if (nn.state == STATE_NEW) {
+					nn.gCost = g;
+					nn.fCost = g + wl.Heuristic(ngb, req.second);
+					nn.state = STATE_OPEN;
+
+					heap.push(&nn);
+					continue;
+				}
+
+				if (g >= nn.gCost)
+					continue;
+
+				if (nn.state == STATE_CLOSED)
+					heap.push(&nn);
+
+				nn.gCost = g;
+				nn.fCost = g + wl.Heuristic(ngb, req.second);
+				nn.state = STATE_OPEN;
+
+				heap.resort(&nn);
+				heap.check_heap_property(0);
+			}
+		}
+	}
+
+	return stats;
+}
+
+
+
+BOOST_AUTO_TEST_CASE( PathRadixQueueOrder )
+{
+	std::vector<PathNode> nodes(8);
+	PathRadixQueue queue;
+
+	// equal f-costs come out by decreasing g-cost, a node cheaper than
+	// the last popped one (inconsistent heuristic) is still popped next
+	const float costs[][2] = {{50.0f, 10.0f}, {20.0f, 5.0f}, {20.0f, 15.0f}, {1000.0f, 0.0f}, {35.0f, 35.0f}};
+
+	for (size_t i = 0; i < 5; i++) {
+		nodes[i].fCost = costs[i][0];
+		nodes[i].gCost = costs[i][1];
+		nodes[i].nodeNum = i;
+		queue.push(&nodes[i]);
+	}
+
+	BOOST_CHECK(queue.top()->nodeNum == 2); queue.pop();
+	BOOST_CHECK(queue.top()->nodeNum == 1); queue.pop();
+	BOOST_CHECK(queue.top()->nodeNum == 4); queue.pop();
+
+	nodes[5].fCost = 30.0f;
+	nodes[5].nodeNum = 5;
+	queue.push(&nodes[5]);
+
+	BOOST_CHECK(queue.top()->nodeNum == 5); queue.pop();
+	BOOST_CHECK(queue.top()->nodeNum == 0); queue.pop();
+	BOOST_CHECK(queue.top()->nodeNum == 3); queue.pop();
+	BOOST_CHECK(queue.empty());
+}
+
+
+BOOST_AUTO_TEST_CASE( QTPFSRadixHeapOrder )
+{
+	std::vector<HeapNode> nodes(64);
+	QTPFS::radix_heap<HeapNode*> heap;
+
+	heap.reserve(nodes.size());
+
+	for (size_t i = 0; i < nodes.size(); i++) {
+		nodes[i].fCost = 10.0f + ((i * 37) % 64) * 3.0f;
+		heap.push(&nodes[i]);
+	}
+
+	// decrease some keys, including below the current minimum
+	heap.pop();
+	nodes[5].fCost =  1.0f; heap.resort(&nodes[5]);
+	nodes[9].fCost = 70.5f; heap.resort(&nodes[9]);
+	heap.check_heap_property(0);
+
+	std::vector<float> popped;
+
+	while (!heap.empty()) {
+		popped.push_back(heap.top()->fCost);
+		BOOST_CHECK(heap.top()->GetHeapIndex() != -1u);
+		heap.pop();
+	}
+
+	BOOST_CHECK(popped.size() == (nodes.size() - 1));
+	BOOST_CHECK(std::is_sorted(popped.begin(), popped.end()));
+}
+
+
+BOOST_AUTO_TEST_CASE( PathQueuesBenchmark )
+{
+	const PathWorkload wl(128, 2000);
+
+	SearchStats stats[4];
+
+	{
+		std::unique_ptr<PathPriorityQueue> queue(new PathPriorityQueue());
+		ScopedOnceTimer timer("PathQueues::PathPriorityQueue");
+		stats[0] = RunDefaultSearches(wl, *queue);
+	}
+	{
+		std::unique_ptr<PathRadixQueue> queue(new PathRadixQueue());
+		ScopedOnceTimer timer("PathQueues::PathRadixQueue");
+		stats[1] = RunDefaultSearches(wl, *queue);
+	}
+	{
+		QTPFS::binary_heap<HeapNode*> heap;
+		ScopedOnceTimer timer("PathQueues::QTPFS::binary_heap");
+		stats[2] = RunQTPFSSearches(wl, heap);
+	}
+	{
+		QTPFS::radix_heap<HeapNode*> heap;
+		ScopedOnceTimer timer("PathQueues::QTPFS::radix_heap");
+		stats[3] = RunQTPFSSearches(wl, heap);
+	}
+
+	for (const SearchStats& s: stats) {
+		printf("[%s] expanded=%lu found=%lu costSum=%.0f\n", __FUNCTION__, (unsigned long) s.numExpanded, (unsigned long) s.numFound, s.costSum);
+	}
+
+	// tie-breaking may differ, the optimal path-costs may not
+	BOOST_CHECK(stats[0].numFound > 0);
+	BOOST_CHECK(stats[0].numFound == stats[1].numFound);
+	BOOST_CHECK(stats[0].costSum == stats[1].costSum);
+	BOOST_CHECK(stats[2].numFound == stats[3].numFound);
+	BOOST_CHECK(stats[2].costSum == stats[3].costSum);
+	BOOST_CHECK(stats[0].costSum == stats[2].costSum);
+}
@@ -0,0 +1,817 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+// runs a hand-assembled COB file through CCobFile's decoder and CCobThread's
+// dispatch loop, and through a copy of the switch-based interpreter that ran
+// the raw code before; CobFile.cpp and CobThread.cpp are compiled with small
+// stand-ins for the engine parts a script interacts with, which record every
+// such interaction
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "System/creg/creg_cond.h"
+#include "Sim/Units/Scripts/CobOpcodes.h"
+
+// keep the real headers out, everything the interpreter needs of them follows
+#define _FILE_HANDLER_H
+#define _I_SOUND_H_
+#define LUA_HASH_STRING_H
+#define LUA_RULES_H
+#define COB_INSTANCE_H
+#define COB_ENGINE_H
+#define _GLOBAL_SYNCED_H
+
+typedef std::vector< std::vector<int> > CallTrace;
+
+// interactions of the thread currently being run
+static CallTrace* callTrace = nullptr;
+
+static void Record(std::initializer_list<int> call) { callTrace->emplace_back(call); }
+
+
+class CFileHandler {
+public:
+	CFileHandler(const std::vector<char>& data): buffer(data) {}
+
+	int FileSize() const { return buffer.size(); }
+	int Read(void* buf, int length) { std::memcpy(buf, buffer.data(), length); return length; }
+
+private:
+	const std::vector<char>& buffer;
+};
+
+static struct {
+	bool HasSoundItem(const std::string& name) const { return false; }
+	int GetSoundId(const std::string& name) const { return 0; }
+} soundStub, *sound = &soundStub;
+
+struct LuaHashString {
+	LuaHashString(const std::string& s): str(s) {}
+	std::string str;
+};
+
+class CUnit;
+class CCobFile;
+class CCobThread;
+
+#define MAX_LUA_COB_ARGS 10
+
+class CLuaRules {
+public:
+	void Cob2Lua(const LuaHashString& name, const CUnit* unit, int& argsCount, int args[MAX_LUA_COB_ARGS]) {}
+};
+
+static CLuaRules* luaRules = nullptr;
+
+class CUnitScript {
+public:
+	enum AnimType {ANone = -1, ATurn = 0, ASpin = 1, AMove = 2};
+};
+
+class CCobInstance: public CUnitScript {
+public:
+	enum ThreadCallbackType { CBNone, CBKilled, CBAimWeapon, CBAimShield };
+
+	CUnit* GetUnit() { return nullptr; }
+
+	void ThreadCallback(ThreadCallbackType type, int retCode, int cbParam) {}
+	void RemoveThreadID(int threadID) {}
+
+	void Spin(int piece, int axis, int speed, int accel) { Record({CobOpcodes::SPIN, piece, axis, speed, accel}); }
+	void StopSpin(int piece, int axis, int decel) { Record({CobOpcodes::STOP_SPIN, piece, axis, decel}); }
+	void Turn(int piece, int axis, int speed, int destination) { Record({CobOpcodes::TURN, piece, axis, speed, destination}); }
+	void Move(int piece, int axis, int speed, int destination) { Record({CobOpcodes::MOVE, piece, axis, speed, destination}); }
+	void MoveNow(int piece, int axis, int destination) { Record({CobOpcodes::MOVE_NOW, piece, axis, destination}); }
+	void TurnNow(int piece, int axis, int destination) { Record({CobOpcodes::TURN_NOW, piece, axis, destination}); }
+
+	bool NeedsWait(AnimType type, int piece, int axis) {
+		Record({(type == ATurn)? CobOpcodes::WAIT_TURN: CobOpcodes::WAIT_MOVE, piece, axis});
+		return false;
+	}
+
+	int GetUnitVal(int val, int p1, int p2, int p3, int p4) {
+		Record({CobOpcodes::GET, val, p1, p2, p3, p4});
+		return (1000 * val + p1 + p2 + p3 + p4);
+	}
+	void SetUnitVal(int val, int param) { Record({CobOpcodes::SET, val, param}); }
+
+	void SetVisibility(int piece, bool visible) { Record({visible? CobOpcodes::SHOW: CobOpcodes::HIDE, piece}); }
+	void ShowFlare(int piece) { Record({CobOpcodes::SHOW, piece, 1}); }
+	void EmitSfx(int sfxType, int sfxPiece) { Record({CobOpcodes::EMIT_SFX, sfxType, sfxPiece}); }
+	void Explode(int piece, int flags) { Record({CobOpcodes::EXPLODE, piece, flags}); }
+	void PlayUnitSound(int snr, int attr) { Record({CobOpcodes::PLAY_SOUND, snr, attr}); }
+	void Signal(int signal) { Record({CobOpcodes::SIGNAL, signal}); }
+	void AttachUnit(int piece, int unit) { Record({CobOpcodes::ATTACH, piece, unit}); }
+	void DropUnit(int unit) { Record({CobOpcodes::DROP, unit}); }
+
+	CCobFile* cobFile = nullptr;
+	std::vector<int> staticVars;
+};
+
+// stands in for CGlobalSynced::rng; reseeded before every run
+static struct {
+	int NextInt(int n) { return ((state = state * 1103515245 + 12345) >> 16) % n; }
+	unsigned int state = 0;
+} gsRNG;
+
+#include "Sim/Units/Scripts/CobThread.h"
+
+class CCobEngine {
+public:
+	int GenThreadID() { return 0; }
+	int GetCurrentTime() const { return 0; }
+
+	void ScheduleThread(const CCobThread* thread) {}
+	void QueueAddThread(CCobThread&& thread);
+};
+
+static CCobEngine cobEngineStub;
+static CCobEngine* cobEngine = &cobEngineStub;
+
+#include "Sim/Units/Scripts/CobFile.cpp"
+#include "Sim/Units/Scripts/CobThread.cpp"
+
+void CCobEngine::QueueAddThread(CCobThread&& thread)
+{
+	std::vector<int> call = {CobOpcodes::START, thread.cobFile->GetFunctionId(thread.GetName()), thread.GetSignalMask()};
+
+	for (int i = 0, n = thread.CheckStack(INT_MAX, false); i < n; i++) {
+		call.push_back(thread.GetStackVal(i));
+	}
+
+	callTrace->push_back(call);
+}
+
+#define BOOST_TEST_MODULE CobInterpreter
+#include <boost/test/unit_test.hpp>
+
+
+
+// writes a COB file around code emitted one instruction at a time, and keeps
+// what the decoder should make of every instruction
+class CCobAssembler {
+public:
+	struct Emitted {
+		int pc;
+		int type;
+		int target; // expected Instruction::args[2] of calls and starts
+		std::vector<int> operands;
+	};
+
+	int Declare(const std::string& name) {
+		names.push_back(name);
+		offsets.push_back(0);
+		return (names.size() - 1);
+	}
+	// functions have to be defined in declaration order
+	void Define(int id) { offsets[id] = code.size(); }
+	int Label() const { return code.size(); }
+
+	int Op(int opcode, int type, std::initializer_list<int> operands, int target = 0) {
+		emitted.push_back({Label(), type, target, operands});
+
+		code.push_back(opcode);
+		code.insert(code.end(), operands.begin(), operands.end());
+		return (emitted.size() - 1);
+	}
+
+	void Patch(int op, int target) {
+		emitted[op].operands[0] = target;
+		code[emitted[op].pc + 1] = target;
+	}
+
+	std::vector<char> Build(int numStaticVars) const {
+		const int numScripts = names.size();
+
+		// header, code-offsets, name-offsets, (no) piece-names, names, code
+		const int codeIndexPos = 13 * 4;
+		const int namesIndexPos = codeIndexPos + numScripts * 4;
+		const int piecesIndexPos = namesIndexPos + numScripts * 4;
+
+		std::vector<char> data(piecesIndexPos);
+
+		const int header[13] = {4, numScripts, 0, int(code.size()), numStaticVars, 0, codeIndexPos, namesIndexPos, piecesIndexPos, 0, 0, 0, 0};
+
+		std::memcpy(&data[0], header, sizeof(header));
+
+		for (int i = 0; i < numScripts; i++) {
+			const int namePos = data.size();
+
+			std::memcpy(&data[codeIndexPos + i * 4], &offsets[i], 4);
+			std::memcpy(&data[namesIndexPos + i * 4], &namePos, 4);
+
+			data.insert(data.end(), names[i].begin(), names[i].end());
+			data.push_back(0);
+		}
+
+		data.resize((data.size() + 3) & ~3);
+
+		const int codePos = data.size();
+
+		std::memcpy(&data[9 * 4], &codePos, 4);
+
+		data.resize(codePos + code.size() * 4);
+		std::memcpy(&data[codePos], code.data(), code.size() * 4);
+		return data;
+	}
+
+	std::vector<std::string> names;
+	std::vector<int> offsets;
+	std::vector<int> code;
+	std::vector<Emitted> emitted;
+};
+
+#define OP(name, ...) cas.Op(CobOpcodes::name, COB_INSTR_##name, {__VA_ARGS__})
+
+
+// the interpreter CCobThread::Tick replaced, reduced to a single call (no
+// SLEEP) and otherwise unchanged; runs on its own copy of the code since CALL
+// rewrites it
+class CSwitchInterpreter {
+public:
+	CSwitchInterpreter(CCobInstance* inst): cobInst(inst), cobFile(inst->cobFile), code(inst->cobFile->code) {}
+
+	void Run(int functionId) {
+		pc = cobFile->scriptOffsets[functionId];
+		callStack.push_back({functionId, -1, 0});
+
+		while (state == CCobThread::Run) {
+			const int opcode = code[pc++];
+
+			switch (opcode) {
+				case CobOpcodes::PUSH_CONSTANT: { dataStack.push_back(code[pc++]); } break;
+				case CobOpcodes::SPIN: {
+					r1 = code[pc++];
+					r2 = code[pc++];
+					r3 = POP();
+					r4 = POP();
+					cobInst->Spin(r1, r2, r3, r4);
+				} break;
+				case CobOpcodes::STOP_SPIN: {
+					r1 = code[pc++];
+					r2 = code[pc++];
+					cobInst->StopSpin(r1, r2, POP());
+				} break;
+				case CobOpcodes::RETURN: {
+					retCode = POP();
+
+					if (callStack.back().returnAddr == -1) {
+						state = CCobThread::Dead;
+						break;
+					}
+
+					pc = callStack.back().returnAddr;
+
+					while (int(dataStack.size()) > callStack.back().stackTop) {
+						dataStack.pop_back();
+					}
+
+					callStack.pop_back();
+				} break;
+				case CobOpcodes::SHADE:
+				case CobOpcodes::DONT_SHADE:
+				case CobOpcodes::CACHE:
+				case CobOpcodes::DONT_CACHE: { pc++; } break;
+				case CobOpcodes::CALL: {
+					r1 = code[pc++];
+					pc--;
+
+					if (cobFile->scriptNames[r1].find("lua_") == 0) {
+						code[pc - 1] = CobOpcodes::LUA_CALL;
+						LuaCall();
+						break;
+					}
+
+					code[pc - 1] = CobOpcodes::REAL_CALL;
+				} // fall-through
+				case CobOpcodes::REAL_CALL: {
+					r1 = code[pc++];
+					r2 = code[pc++];
+
+					if (cobFile->scriptLengths[r1] == 0)
+						break;
+
+					callStack.push_back({r1, pc, int(dataStack.size()) - r2});
+					paramCount = r2;
+					pc = cobFile->scriptOffsets[r1];
+				} break;
+				case CobOpcodes::LUA_CALL: { LuaCall(); } break;
+				case CobOpcodes::POP_STATIC: {
+					r1 = code[pc++];
+					r2 = POP();
+
+					if (static_cast<size_t>(r1) < cobInst->staticVars.size())
+						cobInst->staticVars[r1] = r2;
+				} break;
+				case CobOpcodes::POP_STACK: { POP(); } break;
+				case CobOpcodes::START: {
+					r1 = code[pc++];
+					r2 = code[pc++];
+
+					if (cobFile->scriptLengths[r1] == 0)
+						break;
+
+					std::vector<int> call = {CobOpcodes::START, r1, signalMask};
+
+					for (int i = 0; i < r2; i++) {
+						call.push_back(POP());
+					}
+
+					callTrace->push_back(call);
+				} break;
+				case CobOpcodes::CREATE_LOCAL_VAR: {
+					if (paramCount == 0) {
+						dataStack.push_back(0);
+					} else {
+						paramCount--;
+					}
+				} break;
+				case CobOpcodes::GET_UNIT_VALUE: {
+					r1 = POP();
+
+					if ((r1 >= LUA0) && (r1 <= LUA9)) {
+						dataStack.push_back(luaArgs[r1 - LUA0]);
+						break;
+					}
+
+					dataStack.push_back(cobInst->GetUnitVal(r1, 0, 0, 0, 0));
+				} break;
+				case CobOpcodes::JUMP_NOT_EQUAL: {
+					r1 = code[pc++];
+
+					if (POP() == 0)
+						pc = r1;
+				} break;
+				case CobOpcodes::JUMP: { pc = code[pc]; } break;
+				case CobOpcodes::POP_LOCAL_VAR: {
+					r1 = code[pc++];
+					r2 = POP();
+					dataStack[callStack.back().stackTop + r1] = r2;
+				} break;
+				case CobOpcodes::PUSH_LOCAL_VAR: {
+					r1 = code[pc++];
+					dataStack.push_back(dataStack[callStack.back().stackTop + r1]);
+				} break;
+				case CobOpcodes::BITWISE_AND: { r1 = POP(); r2 = POP(); dataStack.push_back(r1 & r2); } break;
+				case CobOpcodes::BITWISE_OR : { r1 = POP(); r2 = POP(); dataStack.push_back(r1 | r2); } break;
+				case CobOpcodes::BITWISE_XOR: { r1 = POP(); r2 = POP(); dataStack.push_back(r1 ^ r2); } break;
+				case CobOpcodes::BITWISE_NOT: { r1 = POP(); dataStack.push_back(~r1); } break;
+				case CobOpcodes::EXPLODE: {
+					r1 = code[pc++];
+					cobInst->Explode(r1, POP());
+				} break;
+				case CobOpcodes::PLAY_SOUND: {
+					r1 = code[pc++];
+					cobInst->PlayUnitSound(r1, POP());
+				} break;
+				case CobOpcodes::PUSH_STATIC: {
+					r1 = code[pc++];
+
+					if (static_cast<size_t>(r1) < cobInst->staticVars.size())
+						dataStack.push_back(cobInst->staticVars[r1]);
+				} break;
+				case CobOpcodes::SET_NOT_EQUAL       : { r1 = POP(); r2 = POP(); dataStack.push_back(int(r1 != r2)); } break;
+				case CobOpcodes::SET_EQUAL           : { r1 = POP(); r2 = POP(); dataStack.push_back(int(r1 == r2)); } break;
+				case CobOpcodes::SET_LESS            : { r2 = POP(); r1 = POP(); dataStack.push_back(int(r1 <  r2)); } break;
+				case CobOpcodes::SET_LESS_OR_EQUAL   : { r2 = POP(); r1 = POP(); dataStack.push_back(int(r1 <= r2)); } break;
+				case CobOpcodes::SET_GREATER         : { r2 = POP(); r1 = POP(); dataStack.push_back(int(r1 >  r2)); } break;
+				case CobOpcodes::SET_GREATER_OR_EQUAL: { r2 = POP(); r1 = POP(); dataStack.push_back(int(r1 >= r2)); } break;
+				case CobOpcodes::RAND: {
+					r2 = POP();
+					r1 = POP();
+					dataStack.push_back(gsRNG.NextInt(r2 - r1 + 1) + r1);
+				} break;
+				case CobOpcodes::EMIT_SFX: {
+					r1 = POP();
+					r2 = code[pc++];
+					cobInst->EmitSfx(r1, r2);
+				} break;
+				case CobOpcodes::MUL: { r1 = POP(); r2 = POP(); dataStack.push_back(r1 * r2); } break;
+				case CobOpcodes::SIGNAL: { cobInst->Signal(POP()); } break;
+				case CobOpcodes::SET_SIGNAL_MASK: { signalMask = POP(); } break;
+				case CobOpcodes::TURN: {
+					r2 = POP();
+					r1 = POP();
+					r3 = code[pc++];
+					r4 = code[pc++];
+					cobInst->Turn(r3, r4, r1, r2);
+				} break;
+				case CobOpcodes::GET: {
+					r5 = POP();
+					r4 = POP();
+					r3 = POP();
+					r2 = POP();
+					r1 = POP();
+
+					if ((r1 >= LUA0) && (r1 <= LUA9)) {
+						dataStack.push_back(luaArgs[r1 - LUA0]);
+						break;
+					}
+
+					dataStack.push_back(cobInst->GetUnitVal(r1, r2, r3, r4, r5));
+				} break;
+				case CobOpcodes::ADD: { r2 = POP(); r1 = POP(); dataStack.push_back(r1 + r2); } break;
+				case CobOpcodes::SUB: { r2 = POP(); r1 = POP(); dataStack.push_back(r1 - r2); } break;
+				case CobOpcodes::DIV: {
+					r2 = POP();
+					r1 = POP();
+					dataStack.push_back((r2 != 0)? (r1 / r2): 1000);
+				} break;
+				case CobOpcodes::MOD: {
+					r2 = POP();
+					r1 = POP();
+					dataStack.push_back((r2 != 0)? (r1 % r2): 0);
+				} break;
+				case CobOpcodes::MOVE: {
+					r1 = code[pc++];
+					r2 = code[pc++];
+					r4 = POP();
+					r3 = POP();
+					cobInst->Move(r1, r2, r3, r4);
+				} break;
+				case CobOpcodes::MOVE_NOW: {
+					r1 = code[pc++];
+					r2 = code[pc++];
+					cobInst->MoveNow(r1, r2, POP());
+				} break;
+				case CobOpcodes::TURN_NOW: {
+					r1 = code[pc++];
+					r2 = code[pc++];
+					cobInst->TurnNow(r1, r2, POP());
+				} break;
+				case CobOpcodes::WAIT_TURN: {
+					r1 = code[pc++];
+					r2 = code[pc++];
+					cobInst->NeedsWait(CCobInstance::ATurn, r1, r2);
+				} break;
+				case CobOpcodes::WAIT_MOVE: {
+					r1 = code[pc++];
+					r2 = code[pc++];
+					cobInst->NeedsWait(CCobInstance::AMove, r1, r2);
+				} break;
+				case CobOpcodes::SET: {
+					r2 = POP();
+					r1 = POP();
+
+					if ((r1 >= LUA0) && (r1 <= LUA9)) {
+						luaArgs[r1 - LUA0] = r2;
+						break;
+					}
+
+					cobInst->SetUnitVal(r1, r2);
+				} break;
+				case CobOpcodes::ATTACH: {
+					r3 = POP();
+					r2 = POP();
+					r1 = POP();
+					cobInst->AttachUnit(r2, r1);
+				} break;
+				case CobOpcodes::DROP: { cobInst->DropUnit(POP()); } break;
+				case CobOpcodes::LOGICAL_NOT: { r1 = POP(); dataStack.push_back(int(r1 == 0)); } break;
+				case CobOpcodes::LOGICAL_AND: { r1 = POP(); r2 = POP(); dataStack.push_back(int(r1 && r2)); } break;
+				case CobOpcodes::LOGICAL_OR : { r1 = POP(); r2 = POP(); dataStack.push_back(int(r1 || r2)); } break;
+				case CobOpcodes::LOGICAL_XOR: { r1 = POP(); r2 = POP(); dataStack.push_back(int((!!r1) ^ (!!r2))); } break;
+				case CobOpcodes::HIDE: { cobInst->SetVisibility(code[pc++], false); } break;
+				case CobOpcodes::SHOW: {
+					r1 = code[pc++];
+
+					int i;
+					for (i = 0; i < MAX_WEAPONS_PER_UNIT; ++i)
+						if (callStack.back().functionId == cobFile->scriptIndex[COBFN_FirePrimary + COBFN_Weapon_Funcs * i])
+							break;
+
+					if (i < MAX_WEAPONS_PER_UNIT) {
+						cobInst->ShowFlare(r1);
+					} else {
+						cobInst->SetVisibility(r1, true);
+					}
+				} break;
+				default: {
+					state = CCobThread::Dead;
+				} break;
+			}
+		}
+	}
+
+	int POP() {
+		if (dataStack.empty())
+			return 0;
+
+		const int r = dataStack.back();
+		dataStack.pop_back();
+		return r;
+	}
+
+	void LuaCall() {
+		r1 = code[pc++];
+		r2 = code[pc++];
+
+		// no LuaRules, only the arguments are passed on
+		const int size = dataStack.size();
+		const int argCount = std::min(r2, MAX_LUA_COB_ARGS);
+		const int start = std::max(0, size - r2);
+		const int end = std::min(size, start + argCount);
+
+		for (int a = 0, i = start; i < end; i++) {
+			luaArgs[a++] = dataStack[i];
+		}
+
+		dataStack.resize(std::max(0, size - r2));
+		luaArgs[0] = 0;
+	}
+
+	struct CallInfo {
+		int functionId;
+		int returnAddr;
+		int stackTop;
+	};
+
+	CCobInstance* cobInst;
+	CCobFile* cobFile;
+
+	std::vector<int> code;
+	std::vector<int> dataStack;
+	std::vector<CallInfo> callStack;
+
+	CCobThread::State state = CCobThread::Run;
+
+	int pc = 0;
+	int r1, r2, r3, r4, r5;
+
+	int retCode = -1;
+	int paramCount = 0;
+	int signalMask = 0;
+
+	int luaArgs[MAX_LUA_COB_ARGS] = {0};
+};
+
+
+// a script touching every opcode but SLEEP: sums up the squares of 0..9
+// through calls, then drives the model and does some arithmetic on the stack
+static CCobAssembler AssembleScript()
+{
+	CCobAssembler cas;
+
+	const int create = cas.Declare("Create");
+	const int square = cas.Declare("Square");
+	const int empty = cas.Declare("Empty");
+	const int luaFoo = cas.Declare("lua_Foo");
+
+	cas.Define(create);
+	OP(CREATE_LOCAL_VAR); // sum
+	OP(CREATE_LOCAL_VAR); // i
+
+	const int loop = cas.Label();
+	OP(PUSH_LOCAL_VAR, 1); OP(PUSH_CONSTANT, 10); OP(SET_LESS);
+	const int exitLoop = OP(JUMP_NOT_EQUAL, 0);
+	OP(PUSH_LOCAL_VAR, 1);
+	cas.Op(CobOpcodes::CALL, COB_INSTR_REAL_CALL, {square, 1}, -2);
+	OP(PUSH_LOCAL_VAR, 0); OP(PUSH_STATIC, 1); OP(ADD); OP(POP_LOCAL_VAR, 0);
+	OP(PUSH_LOCAL_VAR, 1); OP(PUSH_CONSTANT, 1); OP(ADD); OP(POP_LOCAL_VAR, 1);
+	OP(JUMP, loop);
+	cas.Patch(exitLoop, cas.Label());
+
+	OP(PUSH_LOCAL_VAR, 0); OP(POP_STATIC, 0);
+
+	OP(PUSH_LOCAL_VAR, 0); OP(PUSH_CONSTANT, 5); OP(MOVE, 1, 0);
+	OP(PUSH_CONSTANT, 100); OP(PUSH_CONSTANT, 3); OP(TURN, 2, 1);
+	OP(PUSH_CONSTANT, 7); OP(PUSH_CONSTANT, 2); OP(SPIN, 3, 2);
+	OP(PUSH_CONSTANT, 4); OP(STOP_SPIN, 3, 2);
+	OP(PUSH_CONSTANT, 9); OP(MOVE_NOW, 1, 2);
+	OP(PUSH_CONSTANT, 11); OP(TURN_NOW, 2, 0);
+	OP(WAIT_TURN, 2, 1); OP(WAIT_MOVE, 1, 0);
+	OP(SHOW, 4); OP(HIDE, 5); OP(CACHE, 1); OP(DONT_CACHE, 1); OP(SHADE, 1); OP(DONT_SHADE, 1);
+	OP(PUSH_CONSTANT, 3); OP(EMIT_SFX, 6);
+	OP(PUSH_CONSTANT, 2); OP(EXPLODE, 4);
+	OP(PUSH_CONSTANT, 1); OP(PLAY_SOUND, 0);
+	OP(PUSH_CONSTANT, 8); OP(SIGNAL);
+	OP(PUSH_CONSTANT, 6); OP(SET_SIGNAL_MASK);
+	OP(PUSH_CONSTANT, 12); cas.Op(CobOpcodes::START, COB_INSTR_START, {square, 1}, -2);
+	cas.Op(CobOpcodes::CALL, COB_INSTR_REAL_CALL, {empty, 0}, -1);
+	cas.Op(CobOpcodes::START, COB_INSTR_START, {empty, 0}, -1);
+
+	// LUA0..LUA9 read and write the arguments of the last lua-call
+	OP(PUSH_CONSTANT, 21); OP(PUSH_LOCAL_VAR, 0); OP(PUSH_CONSTANT, 5);
+	cas.Op(CobOpcodes::CALL, COB_INSTR_LUA_CALL, {luaFoo, 3}, -1);
+	OP(PUSH_CONSTANT, 111); OP(GET_UNIT_VALUE);
+	OP(PUSH_CONSTANT, 112); OP(PUSH_CONSTANT, 0); OP(PUSH_CONSTANT, 0); OP(PUSH_CONSTANT, 0); OP(PUSH_CONSTANT, 0); OP(GET);
+	OP(PUSH_CONSTANT, 113); OP(PUSH_CONSTANT, 77); OP(SET);
+	OP(PUSH_CONSTANT, 113); OP(GET_UNIT_VALUE);
+	OP(PUSH_CONSTANT, 4); OP(GET_UNIT_VALUE);
+	OP(PUSH_CONSTANT, 20); OP(PUSH_CONSTANT, 1); OP(PUSH_CONSTANT, 2); OP(PUSH_CONSTANT, 3); OP(PUSH_CONSTANT, 4); OP(GET);
+	OP(PUSH_CONSTANT, 30); OP(PUSH_CONSTANT, 40); OP(SET);
+	OP(PUSH_CONSTANT, 1); OP(PUSH_CONSTANT, 2); OP(PUSH_CONSTANT, 3); OP(ATTACH);
+	OP(PUSH_CONSTANT, 5); OP(DROP);
+
+	OP(PUSH_CONSTANT, 17); OP(PUSH_CONSTANT, 5); OP(SUB);
+	OP(PUSH_CONSTANT, 17); OP(PUSH_CONSTANT, 5); OP(MUL);
+	OP(PUSH_CONSTANT, 17); OP(PUSH_CONSTANT, 5); OP(DIV);
+	OP(PUSH_CONSTANT, 17); OP(PUSH_CONSTANT, 0); OP(DIV);
+	OP(PUSH_CONSTANT, -17); OP(PUSH_CONSTANT, 5); OP(MOD);
+	OP(PUSH_CONSTANT, 17); OP(PUSH_CONSTANT, 0); OP(MOD);
+	OP(PUSH_CONSTANT, 12); OP(PUSH_CONSTANT, 10); OP(BITWISE_AND);
+	OP(PUSH_CONSTANT, 12); OP(PUSH_CONSTANT, 10); OP(BITWISE_OR);
+	OP(PUSH_CONSTANT, 12); OP(PUSH_CONSTANT, 10); OP(BITWISE_XOR);
+	OP(PUSH_CONSTANT, 12); OP(BITWISE_NOT);
+
+	for (const int b: {3, 4, 5}) {
+		OP(PUSH_CONSTANT, 4); OP(PUSH_CONSTANT, b); OP(SET_LESS);
+		OP(PUSH_CONSTANT, 4); OP(PUSH_CONSTANT, b); OP(SET_LESS_OR_EQUAL);
+		OP(PUSH_CONSTANT, 4); OP(PUSH_CONSTANT, b); OP(SET_GREATER);
+		OP(PUSH_CONSTANT, 4); OP(PUSH_CONSTANT, b); OP(SET_GREATER_OR_EQUAL);
+		OP(PUSH_CONSTANT, 4); OP(PUSH_CONSTANT, b); OP(SET_EQUAL);
+		OP(PUSH_CONSTANT, 4); OP(PUSH_CONSTANT, b); OP(SET_NOT_EQUAL);
+	}
+	for (const int b: {0, 2}) {
+		OP(PUSH_CONSTANT, 2); OP(PUSH_CONSTANT, b); OP(LOGICAL_AND);
+		OP(PUSH_CONSTANT, 0); OP(PUSH_CONSTANT, b); OP(LOGICAL_OR);
+		OP(PUSH_CONSTANT, 2); OP(PUSH_CONSTANT, b); OP(LOGICAL_XOR);
+		OP(PUSH_CONSTANT, b); OP(LOGICAL_NOT);
+	}
+
+	OP(PUSH_CONSTANT, 1); OP(PUSH_CONSTANT, 6); OP(RAND);
+	OP(PUSH_CONSTANT, 99); OP(POP_STACK);
+	OP(PUSH_STATIC, 0); OP(PUSH_STATIC, 5);
+	OP(PUSH_CONSTANT, 1); OP(POP_STATIC, 7);
+	OP(PUSH_LOCAL_VAR, 0); OP(RETURN);
+
+	// writes the square of its argument to static 1, returns nothing useful
+	cas.Define(square);
+	OP(CREATE_LOCAL_VAR);
+	OP(PUSH_LOCAL_VAR, 0); OP(PUSH_LOCAL_VAR, 0); OP(MUL); OP(POP_STATIC, 1);
+	OP(PUSH_CONSTANT, 0); OP(RETURN);
+
+	// zero-length, lua_Foo as well
+	cas.Define(empty);
+	cas.Define(luaFoo);
+
+	// targets of calls and starts, now that offsets are known
+	for (CCobAssembler::Emitted& e: cas.emitted) {
+		if (e.target == -2)
+			e.target = cas.offsets[e.operands[0]];
+	}
+
+	return cas;
+}
+
+
+struct RunResult {
+	int retCode;
+	int signalMask;
+
+	std::vector<int> dataStack;
+	std::vector<int> staticVars;
+
+	CallTrace calls;
+};
+
+static RunResult RunThread(CCobFile& cobFile, int functionId)
+{
+	RunResult result;
+	CCobInstance cobInst;
+
+	cobInst.cobFile = &cobFile;
+	cobInst.staticVars.resize(cobFile.numStaticVars, 0);
+
+	callTrace = &result.calls;
+	gsRNG.state = 0;
+
+	{
+		CCobThread thread(&cobInst);
+
+		thread.Start(functionId, 0, {}, false);
+
+		BOOST_CHECK(!thread.Tick());
+		BOOST_CHECK(thread.IsDead());
+
+		result.retCode = thread.GetRetCode();
+		result.signalMask = thread.GetSignalMask();
+
+		for (int i = 0, n = thread.CheckStack(INT_MAX, false); i < n; i++) {
+			result.dataStack.push_back(thread.GetStackVal(i));
+		}
+	}
+
+	result.staticVars = cobInst.staticVars;
+	return result;
+}
+
+static RunResult RunSwitchInterpreter(CCobFile& cobFile, int functionId)
+{
+	RunResult result;
+	CCobInstance cobInst;
+
+	cobInst.cobFile = &cobFile;
+	cobInst.staticVars.resize(cobFile.numStaticVars, 0);
+
+	callTrace = &result.calls;
+	gsRNG.state = 0;
+
+	CSwitchInterpreter interpreter(&cobInst);
+	interpreter.Run(functionId);
+
+	result.retCode = interpreter.retCode;
+	result.signalMask = interpreter.signalMask;
+	result.dataStack = interpreter.dataStack;
+	result.staticVars = cobInst.staticVars;
+	return result;
+}
+
+
+
+BOOST_AUTO_TEST_CASE( DecodeInstructions )
+{
+	const CCobAssembler cas = AssembleScript();
+	const std::vector<char> data = cas.Build(8);
+
+	CFileHandler fh(data);
+	CCobFile cobFile(fh, "test.cob");
+
+	BOOST_REQUIRE(cobFile.scriptNames == cas.names);
+	BOOST_REQUIRE(cobFile.scriptOffsets == cas.offsets);
+	BOOST_REQUIRE(cobFile.instructions.size() == cobFile.code.size());
+	BOOST_REQUIRE(std::equal(cas.code.begin(), cas.code.end(), cobFile.code.begin()));
+
+	for (const CCobAssembler::Emitted& e: cas.emitted) {
+		const CCobFile::Instruction& instr = cobFile.instructions[e.pc];
+
+		BOOST_CHECK_EQUAL(instr.type, e.type);
+		BOOST_CHECK_EQUAL(instr.length, int(1 + e.operands.size()));
+
+		for (size_t i = 0; i < e.operands.size(); i++) {
+			BOOST_CHECK_EQUAL(instr.args[i], e.operands[i]);
+		}
+
+		if (e.type == COB_INSTR_REAL_CALL || e.type == COB_INSTR_LUA_CALL || e.type == COB_INSTR_START)
+			BOOST_CHECK_EQUAL(instr.args[2], e.target);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( DecodeInvalidInstructions )
+{
+	CCobAssembler cas;
+	cas.Define(cas.Declare("Create"));
+
+	const int badOpcode = cas.Op(0x10099000, COB_INSTR_UNKNOWN, {});
+	const int badCall = cas.Op(CobOpcodes::CALL, COB_INSTR_UNKNOWN, {5, 0});
+	const int badStart = cas.Op(CobOpcodes::START, COB_INSTR_UNKNOWN, {-1, 0});
+
+	const std::vector<char> data = cas.Build(0);
+
+	CFileHandler fh(data);
+	CCobFile cobFile(fh, "test.cob");
+
+	// decoded as single unknown words, whose raw value is kept
+	for (const int op: {badOpcode, badCall, badStart}) {
+		const CCobFile::Instruction& instr = cobFile.instructions[cas.emitted[op].pc];
+
+		BOOST_CHECK_EQUAL(instr.type, COB_INSTR_UNKNOWN);
+		BOOST_CHECK_EQUAL(instr.length, 1);
+		BOOST_CHECK_EQUAL(instr.args[0], cas.code[cas.emitted[op].pc]);
+	}
+
+	// the thread dies on the first one, as it did when interpreting the raw code
+	CCobInstance cobInst;
+	CallTrace calls;
+
+	cobInst.cobFile = &cobFile;
+	callTrace = &calls;
+
+	CCobThread thread(&cobInst);
+	thread.Start(0, 0, {}, false);
+
+	BOOST_CHECK(!thread.Tick());
+	BOOST_CHECK(thread.IsDead());
+}
+
+BOOST_AUTO_TEST_CASE( DispatchMatchesSwitchInterpreter )
+{
+	const CCobAssembler cas = AssembleScript();
+	const std::vector<char> data = cas.Build(8);
+
+	CFileHandler fh(data);
+	CCobFile cobFile(fh, "test.cob");
+
+	const std::vector<int> code = cobFile.code;
+
+	const RunResult expected = RunSwitchInterpreter(cobFile, 0);
+	const RunResult result = RunThread(cobFile, 0);
+
+	// sum of the squares of 0..9, to be sure the reference ran the script
+	BOOST_CHECK_EQUAL(expected.retCode, 285);
+	BOOST_CHECK_EQUAL(expected.staticVars[0], 285);
+	BOOST_CHECK_EQUAL(expected.calls.size(), 20u);
+
+	BOOST_CHECK_EQUAL(result.retCode, expected.retCode);
+	BOOST_CHECK_EQUAL(result.signalMask, expected.signalMask);
+	BOOST_CHECK(result.dataStack == expected.dataStack);
+	BOOST_CHECK(result.staticVars == expected.staticVars);
+	BOOST_CHECK(result.calls == expected.calls);
+
+	// CALL's are resolved when decoding, running never rewrites the code
+	BOOST_CHECK(cobFile.code == code);
+	BOOST_CHECK(RunThread(cobFile, 0).calls == expected.calls);
+}
@@ -0,0 +1,160 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <cstdlib>
+#include <queue>
+#include <vector>
+
+#include "Sim/Units/Scripts/CobSleepWheel.h"
+#include "System/TimeProfiler.h"
+#include "System/Misc/SpringTime.h"
+
+#define BOOST_TEST_MODULE CobSleepWheel
+#include <boost/test/unit_test.hpp>
+BOOST_GLOBAL_FIXTURE(InitSpringTime);
+
+
+typedef CCobSleepWheel::SleepingThread SleepingThread;
+
+// CCobEngine ticks with the unit-script engine's delta
+static constexpr int TICK_TIME = 33;
+
+
+// the old CCobEngine scheduler, extended with a sequence number s.t. equal
+// wake-up times are popped in insertion order (which the wheel guarantees)
+struct SleepHeap {
+	struct Entry {
+		SleepingThread st;
+		int seq;
+	};
+	struct EntryComp {
+		bool operator() (const Entry& a, const Entry& b) const {
+			return ((a.st.wt > b.st.wt) || (a.st.wt == b.st.wt && a.seq > b.seq));
+		}
+	};
+
+	void Insert(const SleepingThread& st) { heap.push({st, seq++}); }
+	void Advance(int time, std::vector<SleepingThread>& woken) {
+		while (!heap.empty() && heap.top().st.wt < time) {
+			woken.push_back(heap.top().st);
+			heap.pop();
+		}
+	}
+
+	std::priority_queue<Entry, std::vector<Entry>, EntryComp> heap;
+	int seq = 0;
+};
+
+
+// replays a synthetic COB workload: <numThreads> animation threads that each
+// go back to sleep for a short (mostly frame-multiple) delay after waking up,
+// plus the occasional long-sleeping thread
+template<typename Scheduler>
+static size_t RunWorkload(Scheduler& scheduler, int numThreads, int numTicks, std::vector<int>* wakeOrder)
+{
+	std::vector<SleepingThread> woken;
+
+	size_t hash = 0;
+	int currentTime = 0;
+
+	srand(0);
+
+	for (int i = 0; i < numThreads; i++) {
+		scheduler.Insert({i, rand() % 1000});
+	}
+
+	for (int n = 0; n < numTicks; n++) {
+		currentTime += TICK_TIME;
+
+		scheduler.Advance(currentTime, woken);
+
+		for (const SleepingThread& st: woken) {
+			const int r = rand() % 100;
+			const int sleepTime = (r < 70)? TICK_TIME: ((r < 95)? (rand() % 500): (rand() % 100000));
+
+			hash = hash * 31 + st.id;
+
+			if (wakeOrder != nullptr)
+				wakeOrder->push_back(st.id);
+
+			scheduler.Insert({st.id, currentTime + sleepTime});
+		}
+
+		woken.clear();
+	}
+
+	return hash;
+}
+
+
+
+BOOST_AUTO_TEST_CASE( CobSleepWheelOrder )
+{
+	CCobSleepWheel wheel;
+	std::vector<SleepingThread> woken;
+
+	// equal wake-up times must come out in insertion order, across cascades
+	wheel.Insert({0, 70000});
+	wheel.Insert({1, 300});
+	wheel.Insert({2, 70000});
+	wheel.Insert({3, 5});
+	wheel.Insert({4, 300});
+
+	wheel.Advance(1000, woken);
+	wheel.Insert({5, 70000});
+	wheel.Advance(80000, woken);
+
+	BOOST_CHECK(wheel.Empty());
+	BOOST_CHECK(woken.size() == 6);
+
+	const int expectedIDs[] = {3, 1, 4, 0, 2, 5};
+
+	for (size_t i = 0; i < woken.size(); i++) {
+		BOOST_CHECK(woken[i].id == expectedIDs[i]);
+	}
+
+	// sleepers scheduled before the current time wake up on the next advance
+	woken.clear();
+	wheel.Insert({6, 79000});
+	wheel.Insert({7, 80000});
+	wheel.Advance(80000, woken);
+
+	BOOST_CHECK(woken.size() == 1 && woken[0].id == 6);
+	BOOST_CHECK(wheel.Size() == 1);
+}
+
+
+BOOST_AUTO_TEST_CASE( CobSleepWheelWorkload )
+{
+	std::vector<int> heapOrder;
+	std::vector<int> wheelOrder;
+
+	SleepHeap heap;
+	CCobSleepWheel wheel;
+
+	RunWorkload(heap, 2000, 30 * 60 * 5, &heapOrder);
+	RunWorkload(wheel, 2000, 30 * 60 * 5, &wheelOrder);
+
+	BOOST_CHECK(heapOrder == wheelOrder);
+}
+
+
+BOOST_AUTO_TEST_CASE( CobSleepWheelBenchmark )
+{
+	const int numThreads = 50000;
+	const int numTicks = 30 * 60;
+
+	size_t hash[2] = {0, 0};
+
+	{
+		SleepHeap heap;
+		ScopedOnceTimer timer("CobSleepWheel::PriorityQueue");
+		hash[0] = RunWorkload(heap, numThreads, numTicks, nullptr);
+	}
+	{
+		CCobSleepWheel wheel;
+		ScopedOnceTimer timer("CobSleepWheel::TimingWheel");
+		hash[1] = RunWorkload(wheel, numThreads, numTicks, nullptr);
+	}
+
+	BOOST_CHECK(hash[0] == hash[1]);
+}
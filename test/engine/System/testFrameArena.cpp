@@ -0,0 +1,179 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include "System/FrameArena.h"
+#include "System/TimeProfiler.h"
+#include "System/Misc/SpringTime.h"
+
+#define BOOST_TEST_MODULE FrameArena
+#include <boost/test/unit_test.hpp>
+BOOST_GLOBAL_FIXTURE(InitSpringTime);
+
+
+static bool IsAligned(const void* p, size_t align) { return ((reinterpret_cast<std::uintptr_t>(p) & (align - 1)) == 0); }
+
+
+// mimics the per-frame pattern of the sim: many small lists that are filled,
+// scanned and dropped again, e.g. one list of weapon targets per weapon
+template<typename Vector>
+static float FillLists(int numLists, int listSize)
+{
+	float sum = 0.0f;
+
+	for (int n = 0; n < numLists; n++) {
+		Vector targets;
+		targets.reserve(16);
+
+		for (int i = 0, k = (n % listSize) + 1; i < k; i++) {
+			targets.emplace_back(i * 0.5f, nullptr);
+		}
+
+		for (const auto& p: targets) {
+			sum += p.first;
+		}
+	}
+
+	return sum;
+}
+
+
+
+BOOST_AUTO_TEST_CASE( FrameArenaAllocate )
+{
+	CFrameArena arena;
+
+	void* a = arena.Allocate( 3,  1);
+	void* b = arena.Allocate( 8,  8);
+	void* c = arena.Allocate(24, 16);
+
+	BOOST_CHECK(IsAligned(b,  8));
+	BOOST_CHECK(IsAligned(c, 16));
+	BOOST_CHECK(a != b && b != c);
+	BOOST_CHECK(arena.GetNumLiveAllocs() == 3);
+
+	// the top allocation is popped, others are kept until the arena rewinds
+	const size_t usedSize = arena.GetUsedSize();
+
+	arena.Deallocate(c, 24);
+	BOOST_CHECK(arena.GetUsedSize() == (usedSize - 24));
+	arena.Deallocate(a, 3);
+	BOOST_CHECK(arena.GetUsedSize() == (usedSize - 24));
+	arena.Deallocate(b, 8);
+	BOOST_CHECK(arena.GetUsedSize() == 0);
+	BOOST_CHECK(arena.GetNumLiveAllocs() == 0);
+	BOOST_CHECK(arena.GetPeakSize() == usedSize);
+
+	// rewinding reuses the same memory
+	BOOST_CHECK(arena.Allocate(3, 1) == a);
+	arena.Deallocate(a, 3);
+}
+
+
+BOOST_AUTO_TEST_CASE( FrameArenaReset )
+{
+	CFrameArena arena;
+	std::vector<void*> ptrs;
+
+	// overflow the first block a few times
+	for (int i = 0; i < 64; i++) {
+		ptrs.push_back(arena.Allocate(10000, 16));
+	}
+
+	const size_t peakSize = arena.GetPeakSize();
+	const size_t capacity = arena.GetCapacity();
+
+	BOOST_CHECK(peakSize >= (64 * 10000));
+	BOOST_CHECK(capacity >= peakSize);
+
+	for (void* p: ptrs) {
+		arena.Deallocate(p, 10000);
+	}
+
+	arena.Reset();
+
+	// the merged block holds the previous frame's peak without growing
+	BOOST_CHECK(arena.GetCapacity() == capacity);
+	ptrs.clear();
+
+	for (int i = 0; i < 64; i++) {
+		ptrs.push_back(arena.Allocate(10000, 16));
+	}
+
+	BOOST_CHECK(arena.GetCapacity() == capacity);
+
+	#ifdef DEBUG
+	for (void* p: ptrs) {
+		arena.Deallocate(p, 10000);
+	}
+
+	BOOST_CHECK(static_cast<const uint8_t*>(ptrs[0])[0] == 0xCD);
+	#endif
+}
+
+
+BOOST_AUTO_TEST_CASE( FrameArenaVector )
+{
+	CFrameArena arena;
+
+	{
+		FrameVector<int> a{FrameAllocator<int>(&arena)};
+		FrameVector<double> b{FrameAllocator<double>(&arena)};
+
+		for (int i = 0; i < 1000; i++) {
+			a.push_back(i);
+			b.push_back(i * 0.5);
+		}
+
+		BOOST_CHECK(IsAligned(b.data(), alignof(double)));
+
+		for (int i = 0; i < 1000; i++) {
+			BOOST_CHECK(a[i] == i && b[i] == i * 0.5);
+		}
+
+		FrameVector<int> c = a;
+		BOOST_CHECK(c == a);
+		BOOST_CHECK(arena.GetNumLiveAllocs() == 3);
+	}
+
+	BOOST_CHECK(arena.GetNumLiveAllocs() == 0);
+	BOOST_CHECK(arena.GetUsedSize() == 0);
+
+	// default-constructed containers use the calling thread's arena
+	{
+		FrameVector<int> v;
+		v.push_back(1);
+		BOOST_CHECK(CFrameArena::GetThreadArena().GetNumLiveAllocs() == 1);
+	}
+
+	CFrameArena::ResetThreadArenas();
+}
+
+
+BOOST_AUTO_TEST_CASE( FrameArenaBenchmark )
+{
+	typedef std::pair<float, void*> TargetPair;
+
+	const int numLists = 2000000;
+	const int listSize = 40;
+
+	float sums[2] = {0.0f, 0.0f};
+
+	{
+		ScopedOnceTimer timer("FrameArena::std::vector");
+		sums[0] = FillLists< std::vector<TargetPair> >(numLists, listSize);
+	}
+	{
+		ScopedOnceTimer timer("FrameArena::FrameVector");
+		sums[1] = FillLists< FrameVector<TargetPair> >(numLists, listSize);
+		CFrameArena::ResetThreadArenas();
+	}
+
+	printf("[%s] peak=%lu bytes\n", __FUNCTION__, (unsigned long) CFrameArena::GetThreadArena().GetPeakSize());
+
+	BOOST_CHECK(sums[0] == sums[1]);
+}
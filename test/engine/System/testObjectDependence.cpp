@@ -0,0 +1,146 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "System/Object.h"
+#include "System/TimeProfiler.h"
+#include "System/Misc/SpringTime.h"
+
+#define BOOST_TEST_MODULE ObjectDependence
+#include <boost/test/unit_test.hpp>
+BOOST_GLOBAL_FIXTURE(InitSpringTime);
+
+
+// records every death it is informed of
+struct TestObject: public CObject {
+	TestObject(std::vector< std::pair<const CObject*, const CObject*> >* log_ = nullptr): log(log_) {}
+
+	void DependentDied(CObject* obj) {
+		if (log != nullptr)
+			log->emplace_back(this, obj);
+
+		// removing the dying object's dependence from inside the callback is a no-op
+		DeleteDeathDependence(obj, DEPENDENCE_TARGET);
+	}
+
+	size_t NumListeners() const { return listeners.size(); }
+	size_t NumListening() const { return listening.size(); }
+
+	std::vector< std::pair<const CObject*, const CObject*> >* log;
+};
+
+
+
+BOOST_AUTO_TEST_CASE( ObjectDependenceOrder )
+{
+	std::vector< std::pair<const CObject*, const CObject*> > log;
+	std::vector< std::unique_ptr<TestObject> > objs;
+
+	for (int i = 0; i < 8; i++) {
+		objs.emplace_back(new TestObject(&log));
+	}
+
+	TestObject* target = new TestObject();
+
+	// registered out of (sync-ID) order and with mixed types
+	objs[5]->AddDeathDependence(target, DEPENDENCE_TARGET);
+	objs[1]->AddDeathDependence(target, DEPENDENCE_TARGET);
+	objs[3]->AddDeathDependence(target, DEPENDENCE_ATTACKER);
+	objs[7]->AddDeathDependence(target, DEPENDENCE_TARGET);
+	objs[0]->AddDeathDependence(target, DEPENDENCE_ATTACKER);
+	objs[2]->AddDeathDependence(target, DEPENDENCE_TARGET);
+	objs[2]->AddDeathDependence(target, DEPENDENCE_TARGET);
+	objs[6]->AddDeathDependence(target, DEPENDENCE_TARGET);
+	objs[3]->AddDeathDependence(target, DEPENDENCE_TARGET);
+
+	// objects depending on each other as well
+	objs[4]->AddDeathDependence(objs[6].get(), DEPENDENCE_WEAPON);
+	objs[6]->AddDeathDependence(objs[4].get(), DEPENDENCE_WEAPON);
+
+	objs[1]->DeleteDeathDependence(target, DEPENDENCE_TARGET);
+	objs[1]->DeleteDeathDependence(target, DEPENDENCE_TARGET);
+	objs[7]->DeleteDeathDependence(target, DEPENDENCE_ATTACKER);
+
+	BOOST_CHECK(target->NumListeners() == 7);
+	BOOST_CHECK(objs[3]->NumListening() == 2);
+
+	delete target;
+
+	// by dependence-type, then by sync-ID
+	const int expected[] = {0, 3, 2, 3, 5, 6, 7};
+
+	BOOST_CHECK(log.size() == (sizeof(expected) / sizeof(expected[0])));
+
+	for (size_t i = 0; i < std::min(log.size(), sizeof(expected) / sizeof(expected[0])); i++) {
+		BOOST_CHECK(log[i].first == objs[expected[i]].get());
+	}
+
+	for (size_t i = 0; i < objs.size(); i++) {
+		BOOST_CHECK(objs[i]->NumListening() == ((i == 4 || i == 6)? 1: 0));
+	}
+
+	log.clear();
+	objs[4].reset();
+
+	BOOST_CHECK(log.size() == 1);
+	BOOST_CHECK(objs[6]->NumListening() == 0);
+	BOOST_CHECK(objs[6]->NumListeners() == 0);
+}
+
+
+BOOST_AUTO_TEST_CASE( ObjectDependenceBenchmark )
+{
+	// a few heavily targeted objects with many short-lived listeners each,
+	// e.g. weapons retargeting between the units of a large blob
+	const int numTargets = 16;
+	const int numListeners = 4096;
+	const int numOps = 1000000;
+
+	std::vector< std::unique_ptr<TestObject> > targets;
+	std::vector< std::unique_ptr<TestObject> > listeners;
+	std::vector<int> listenerTargets(numListeners, -1);
+
+	for (int i = 0; i < numTargets; i++) {
+		targets.emplace_back(new TestObject());
+	}
+	for (int i = 0; i < numListeners; i++) {
+		listeners.emplace_back(new TestObject());
+	}
+
+	srand(0);
+
+	{
+		ScopedOnceTimer timer("ObjectDependence::Retarget");
+
+		for (int n = 0; n < numOps; n++) {
+			const int l = rand() % numListeners;
+			const int t = rand() % numTargets;
+
+			if (listenerTargets[l] >= 0)
+				listeners[l]->DeleteDeathDependence(targets[listenerTargets[l]].get(), DEPENDENCE_TARGET);
+
+			listeners[l]->AddDeathDependence(targets[listenerTargets[l] = t].get(), DEPENDENCE_TARGET);
+		}
+	}
+
+	size_t numListening = 0;
+
+	for (const auto& l: listeners) {
+		numListening += l->NumListening();
+	}
+
+	BOOST_CHECK(numListening == numListeners);
+
+	{
+		ScopedOnceTimer timer("ObjectDependence::Kill");
+		targets.clear();
+	}
+
+	for (const auto& l: listeners) {
+		BOOST_CHECK(l->NumListening() == 0);
+	}
+}